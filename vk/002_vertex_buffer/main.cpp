@@ -831,7 +831,7 @@ int main() {
         vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
         VkDeviceSize offset = 0;
         vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, &offset);
-        vkCmdDraw(cmd, vertices.size(), 1, 0, 0);
+        vkCmdDraw(cmd, vertices.size() / 6, 1, 0, 0);
         vkCmdEndRenderPass(cmd);
         
         vkEndCommandBuffer(cmd); // end recording
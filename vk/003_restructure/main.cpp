@@ -1,7 +1,8 @@
 // this sample takes 002_vertex_buffer and restructures it with helper functions/classes
 // to make it easier to add more features.
-// no new concepts are introduced, the majority of this project's source code is the same as the
-// previous sample, other than some moving around/refactoring.
+// no new concepts are introduced: the instance extensions and layers, physical device selection, the swapchain,
+// shader loading and buffers with their memory moved into the classes in utils/, main.cpp keeps what's specific to the sample.
+// the draw takes the number of vertices, which is the number of floats in the vertex buffer divided by the 6 every vertex has.
 
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
@@ -124,7 +125,7 @@ int main() {
         vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
         VkDeviceSize offset = 0;
         vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer->buffer, &offset);
-        vkCmdDraw(cmd, vertices.size(), 1, 0, 0);
+        vkCmdDraw(cmd, vertices.size() / 6, 1, 0, 0);
         vkCmdEndRenderPass(cmd);
         
         vkEndCommandBuffer(cmd); // end recording
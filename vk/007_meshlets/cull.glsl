@@ -0,0 +1,67 @@
+#version 450
+
+// one workgroup per meshlet: the first invocation tests the meshlet against the view frustum and its normal cone,
+// after which the whole workgroup copies the indices of a visible meshlet into the compacted index buffer
+layout(local_size_x = 64) in;
+
+struct Meshlet {
+    vec4 sphere; // center.xyz, radius
+    vec4 cone; // axis.xyz, cutoff
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+};
+
+layout(set = 0, binding = 0) uniform View {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint meshletCount;
+} view;
+
+layout(std430, set = 0, binding = 1) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout(std430, set = 0, binding = 2) readonly buffer MeshletIndices { uint meshletIndices[]; };
+layout(std430, set = 0, binding = 3) writeonly buffer OutputIndices { uint outputIndices[]; };
+
+// matches VkDrawIndexedIndirectCommand, indexCount is reset to 0 before the dispatch
+layout(std430, set = 0, binding = 4) buffer DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+} draw;
+
+shared bool visible;
+shared uint outputOffset;
+
+bool cull(Meshlet meshlet) {
+    // the bounding sphere is completely outside of one of the frustum planes
+    for (int i = 0; i < 6; i++) {
+        if (dot(view.frustum[i].xyz, meshlet.sphere.xyz) + view.frustum[i].w < -meshlet.sphere.w)
+            return true;
+    }
+    
+    // every triangle in the meshlet faces away from the camera
+    vec3 toMeshlet = meshlet.sphere.xyz - view.cameraPosition.xyz;
+    return dot(toMeshlet, meshlet.cone.xyz) >= meshlet.cone.w * length(toMeshlet) + meshlet.sphere.w;
+}
+
+void main() {
+    Meshlet meshlet = meshlets[gl_WorkGroupID.x];
+    uint indexCount = meshlet.triangleCount * 3;
+    
+    // reserve a range in the output once per meshlet, so the output stays compact
+    if (gl_LocalInvocationIndex == 0) {
+        visible = !cull(meshlet);
+        if (visible)
+            outputOffset = atomicAdd(draw.indexCount, indexCount);
+    }
+    barrier();
+    
+    if (!visible)
+        return;
+    
+    for (uint i = gl_LocalInvocationIndex; i < indexCount; i += gl_WorkGroupSize.x)
+        outputIndices[outputOffset + i] = meshletIndices[meshlet.triangleOffset * 3 + i];
+}
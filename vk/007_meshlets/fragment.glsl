@@ -0,0 +1,11 @@
+#version 450
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // simple directional light so the sphere's shape is visible
+    vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.6));
+    float diffuse = max(dot(normalize(inNormal), lightDirection), 0.0);
+    outColor = vec4(vec3(0.1) + vec3(0.9, 0.8, 0.6) * diffuse, 1);
+}
@@ -0,0 +1,948 @@
+// this sample moves to a dense 3D mesh and splits it into "meshlets": small clusters of up to 64 vertices and 124 triangles
+// every meshlet has a bounding sphere and a normal cone, which allows culling far more precisely than per-object culling:
+// meshlets outside of the view frustum, or whose triangles all face away from the camera, are skipped.
+// the culling runs on the GPU in a compute shader, which writes the indices of the visible meshlets into a compacted index buffer
+// and fills in an indirect draw command, so the CPU never needs to know what survived.
+// when VK_EXT_mesh_shader is available the culling happens in a task shader instead, and a mesh shader outputs the meshlets directly.
+// run with --no-mesh-shaders to force the compute path.
+
+// see lines
+// * utils/meshlet.hpp for meshlet generation, utils/math.hpp for the camera math
+// * cull.glsl, meshlet_task.glsl and meshlet_mesh.glsl for the culling itself
+// * 149-218 Meshlet buffers and the descriptor set the culling shaders read them through
+// * 253-318 Culling dispatch followed by an indirect draw, or a single mesh task dispatch
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <cmath>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/physical_device.hpp"
+#include "utils/swapchain.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/math.hpp"
+#include "utils/meshlet.hpp"
+
+// matches the View uniform block in the culling shaders
+struct ViewData
+{
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint32_t meshletCount;
+    uint32_t padding[3];
+};
+
+VkInstance createInstance();
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window);
+bool meshShadersSupported(VkPhysicalDevice physicalDevice);
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, bool meshShaders);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkRenderPass createRenderpass(VkDevice device, VkFormat format);
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, bool meshShaders);
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout, VkShaderStageFlags pushConstantStages);
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages);
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShader);
+void createSphere(uint32_t rings, uint32_t segments, std::vector<float>& vertices, std::vector<uint32_t>& indices);
+
+int main(int argc, char** argv) {
+    // default GLFW window creation except we disable OpenGL context creation
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 800, "007_meshlets", nullptr, nullptr);
+    
+    VkInstance instance = createInstance();
+    VkSurfaceKHR surface = createSurface(instance, window);
+    
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice = PhysicalDevice::select(instance, surface, &families);
+    
+    // use the mesh shader path where we can, unless it's explicitly disabled
+    bool meshShaders = meshShadersSupported(physicalDevice);
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--no-mesh-shaders") == 0)
+            meshShaders = false;
+    printf("Culling meshlets with %s\n", meshShaders ? "task/mesh shaders" : "a compute shader");
+    
+    VkDevice device = createDevice(instance, physicalDevice, families.graphics, families.present, meshShaders);
+    VkQueue graphicsQueue; vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+    VkQueue presentQueue; vkGetDeviceQueue(device, families.present, 0, &presentQueue);
+    
+    VkCommandPool commandPool = createCommandPool(device, families.graphics);
+    VkCommandBuffer cmd = allocateCommandBuffer(device, commandPool);
+    
+    Swapchain swap = Swapchain::create(device, physicalDevice, surface, families.graphics, families.present);
+    
+    VkRenderPass renderpass = createRenderpass(device, swap.format);
+    auto swapchainImages = swap.getImages(device);
+    auto swapchainImageViews = swap.getImageViews(device);
+    auto swapchainFramebuffers = swap.getFramebuffers(device, renderpass);
+    
+    // semaphores are for GPU-GPU synchronization
+    // imageWaitSemaphore: Makes our command buffer wait on vkAcquireNextImageKHR to be finished
+    // presentWaitSemaphore: Makes vkQueuePresentKHR wait on our commands to be done rendering
+    VkSemaphoreCreateInfo semaphoreInfo { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0 };
+    VkSemaphore imageWaitSemaphore, presentWaitSemaphore;
+    THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageWaitSemaphore));
+    THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &presentWaitSemaphore));
+    
+    // the view projection matrix is pushed to whichever stage transforms the vertices
+    // both pipelines share the layout, so in mesh mode the range covers the vertex stage of the vertex pipeline as well
+    VkShaderStageFlags pushConstantStages = VK_SHADER_STAGE_VERTEX_BIT;
+#ifdef VK_EXT_mesh_shader
+    if (meshShaders)
+        pushConstantStages |= VK_SHADER_STAGE_MESH_BIT_EXT;
+#endif
+    
+    VkDescriptorSetLayout setLayout = createDescriptorSetLayout(device, meshShaders);
+    VkPipelineLayout pipelineLayout = createPipelineLayout(device, setLayout, pushConstantStages);
+    
+    VkShaderModule vertexShader = Shader::load(device, "../007_meshlets/vertex.spv");
+    VkShaderModule fragmentShader = Shader::load(device, "../007_meshlets/fragment.spv");
+    VkShaderModule cullShader = Shader::load(device, "../007_meshlets/cull.spv");
+    
+    VkPipeline pipeline = createPipeline(device, swap, renderpass, pipelineLayout, {
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertexShader, "main", nullptr },
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, "main", nullptr }
+    });
+    VkPipeline cullPipeline = createComputePipeline(device, pipelineLayout, cullShader);
+    
+    // the mesh shader pipeline has no vertex input at all, the task and mesh shaders read the meshlets themselves
+    VkShaderModule taskShader = VK_NULL_HANDLE, meshShader = VK_NULL_HANDLE;
+    VkPipeline meshPipeline = VK_NULL_HANDLE;
+    PFN_vkVoidFunction cmdDrawMeshTasks = nullptr;
+#ifdef VK_EXT_mesh_shader
+    if (meshShaders)
+    {
+        taskShader = Shader::load(device, "../007_meshlets/meshlet_task.spv");
+        meshShader = Shader::load(device, "../007_meshlets/meshlet_mesh.spv");
+        meshPipeline = createPipeline(device, swap, renderpass, pipelineLayout, {
+            VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_TASK_BIT_EXT, taskShader, "main", nullptr },
+            VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_MESH_BIT_EXT, meshShader, "main", nullptr },
+            VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, "main", nullptr }
+        });
+        
+        // extension functions aren't exported by the loader, so we have to look them up ourselves
+        cmdDrawMeshTasks = vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksEXT");
+    }
+#endif
+    
+    // vertex: { float3 pos, float3 normal }
+    // a finely tessellated sphere, dense enough that culling by meshlet pays off
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    createSphere(256, 512, vertices, indices);
+    
+    MeshletData meshlets = MeshletBuilder::build(vertices.data(), vertices.size() / 6, sizeof(float) * 6, indices);
+    uint32_t meshletCount = meshlets.meshlets.size();
+    printf("Split %zu triangles into %u meshlets\n", indices.size() / 3, meshletCount);
+    
+    std::unique_ptr<Buffer> vertexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(float) * vertices.size(), vertices.data(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    std::unique_ptr<Buffer> meshletBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(Meshlet) * meshletCount, meshlets.meshlets.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    std::unique_ptr<Buffer> meshletIndexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * meshlets.indices.size(), meshlets.indices.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    std::unique_ptr<Buffer> meshletVertexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * meshlets.vertices.size(), meshlets.vertices.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    std::unique_ptr<Buffer> meshletTriangleBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * meshlets.triangles.size(), meshlets.triangles.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    
+    // the culling shader writes the visible meshlets' indices into this buffer, which is then used as the index buffer
+    // it only lives on the GPU, so it can be device local
+    std::unique_ptr<Buffer> indexBuffer = Buffer::create(device, physicalDevice, families, sizeof(uint32_t) * meshlets.indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    
+    // the indirect draw command is filled in by the culling shader
+    // we keep it host visible so we can print how many triangles survived culling
+    std::unique_ptr<Buffer> drawCommandBuffer = Buffer::create(device, physicalDevice, families, sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    std::unique_ptr<Buffer> viewBuffer = Buffer::create(device, physicalDevice, families, sizeof(ViewData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VkDrawIndexedIndirectCommand* drawCommand = reinterpret_cast<VkDrawIndexedIndirectCommand*>(drawCommandBuffer->map());
+    ViewData* viewData = reinterpret_cast<ViewData*>(viewBuffer->map());
+    
+    // the culling shaders access their buffers through a descriptor set
+    // descriptor sets are allocated from a descriptor pool, which must be large enough for all of the set's bindings
+    std::array<VkDescriptorPoolSize, 2> poolSizes {
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 7 }
+    };
+    
+    VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext = nullptr;
+    descriptorPoolInfo.flags = 0;
+    descriptorPoolInfo.maxSets = 1;
+    descriptorPoolInfo.poolSizeCount = poolSizes.size();
+    descriptorPoolInfo.pPoolSizes = poolSizes.data();
+    
+    VkDescriptorPool descriptorPool;
+    THROW_IF_FAILED(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool));
+    
+    VkDescriptorSetAllocateInfo setAllocInfo {};
+    setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setAllocInfo.pNext = nullptr;
+    setAllocInfo.descriptorPool = descriptorPool;
+    setAllocInfo.descriptorSetCount = 1;
+    setAllocInfo.pSetLayouts = &setLayout;
+    
+    VkDescriptorSet descriptorSet;
+    THROW_IF_FAILED(vkAllocateDescriptorSets(device, &setAllocInfo, &descriptorSet));
+    
+    // point every binding in the set at its buffer, the binding numbers match the shaders
+    std::array<VkDescriptorBufferInfo, 8> bufferInfos {
+        VkDescriptorBufferInfo { viewBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { meshletBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { meshletIndexBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { indexBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { drawCommandBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { vertexBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { meshletVertexBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { meshletTriangleBuffer->buffer, 0, VK_WHOLE_SIZE }
+    };
+    
+    std::vector<VkWriteDescriptorSet> writes(bufferInfos.size());
+    for (uint32_t i = 0; i < bufferInfos.size(); i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].pNext = nullptr;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+    
+    float t = 0;
+    uint32_t frame = 0;
+    
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        
+        // Acquire the next image to render to
+        // the frame might not immediately be ready (swapchain may stall for e.g. vsync)
+        // so we must wait with either a semaphore (GPU-GPU sync) or a fence (CPU-GPU sync)
+        uint32_t imageIndex;
+        vkAcquireNextImageKHR(device, swap.swapchain, UINT_MAX, imageWaitSemaphore, /* fence */ nullptr, &imageIndex);
+        
+        // the camera orbits the sphere, close enough that part of it is outside of the view frustum
+        t += 0.005f;
+        vec3 eye { 1.8f * cosf(t), 0.6f, 1.8f * sinf(t) };
+        mat4 view = mat4::lookAt(eye, vec3 { 0, 0, 0 }, vec3 { 0, 1, 0 });
+        mat4 projection = mat4::perspective(1.0f, swap.extent.width / float(swap.extent.height), 0.05f, 100.0f);
+        mat4 viewProjection = projection * view;
+        
+        // the previous frame has finished (we wait for idle at the end of every frame) so we can write the view data directly
+        frustumPlanes(viewProjection, viewData->frustum);
+        viewData->cameraPosition = { eye.x, eye.y, eye.z, 1 };
+        viewData->meshletCount = meshletCount;
+        
+        // describe how we'll start recording the command buffer
+        // this is usually fairly simple for primary command buffers
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = 0;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(cmd, &beginInfo); // start recording
+        
+        if (!meshShaders)
+        {
+            // reset the draw command, the culling shader appends to its index count
+            VkDrawIndexedIndirectCommand emptyDraw { 0, 1, 0, 0, 0 };
+            vkCmdUpdateBuffer(cmd, drawCommandBuffer->buffer, 0, sizeof(emptyDraw), &emptyDraw);
+            
+            // the culling shader may only start appending once the reset has landed
+            VkBufferMemoryBarrier resetBarrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+            resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            resetBarrier.buffer = drawCommandBuffer->buffer;
+            resetBarrier.offset = 0;
+            resetBarrier.size = VK_WHOLE_SIZE;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &resetBarrier, 0, nullptr);
+            
+            // one workgroup per meshlet
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdDispatch(cmd, meshletCount, 1, 1);
+            
+            // the draw reads the command and the indices that the culling shader just wrote
+            VkMemoryBarrier cullBarrier { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+            cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+        }
+        
+        // pick a clear color - float32 is in RGBA [0 - 1]
+        VkClearValue clearValue {};
+        clearValue.color.float32[0] = 0;
+        clearValue.color.float32[1] = 0;
+        clearValue.color.float32[2] = 0;
+        clearValue.color.float32[3] = 1;
+        
+        VkRenderPassBeginInfo renderpassBegin {};
+        renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderpassBegin.pNext = nullptr;
+        renderpassBegin.renderPass = renderpass;
+        renderpassBegin.framebuffer = swapchainFramebuffers[imageIndex];
+        renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, swap.extent };
+        renderpassBegin.clearValueCount = 1;
+        renderpassBegin.pClearValues = &clearValue;
+        
+        vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        
+        if (meshShaders)
+        {
+#ifdef VK_EXT_mesh_shader
+            // every task shader workgroup culls 32 meshlets and launches mesh shader workgroups for the visible ones
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, meshPipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdPushConstants(cmd, pipelineLayout, pushConstantStages, 0, sizeof(mat4), viewProjection.m);
+            reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(cmdDrawMeshTasks)(cmd, (meshletCount + 31) / 32, 1, 1);
+#endif
+        }
+        else
+        {
+            // draw whatever survived culling, the vertex count comes from the GPU written draw command
+            VkDeviceSize offset = 0;
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            vkCmdPushConstants(cmd, pipelineLayout, pushConstantStages, 0, sizeof(mat4), viewProjection.m);
+            vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer->buffer, &offset);
+            vkCmdBindIndexBuffer(cmd, indexBuffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+            vkCmdDrawIndexedIndirect(cmd, drawCommandBuffer->buffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+        }
+        
+        vkCmdEndRenderPass(cmd);
+        
+        vkEndCommandBuffer(cmd); // end recording
+        
+        // this can be more optimal or specialized by picking a more specific pipeline stage
+        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        
+        // submit the command list to the graphics queue
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = nullptr;
+        submit.waitSemaphoreCount = 1;
+        submit.pWaitSemaphores = &imageWaitSemaphore; // wait for the image to be ready before the commands can execute
+        submit.pWaitDstStageMask = &waitStageMask;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cmd;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &presentWaitSemaphore; // signal the present wait semaphore afterwards so present() can wait on it
+        vkQueueSubmit(graphicsQueue, 1, &submit, nullptr);
+        
+        // after we're done rendering, we'll present our image to the screen.
+        VkResult result;
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.pNext = nullptr;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &presentWaitSemaphore; // present after waiting is done
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swap.swapchain;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = &result;
+        vkQueuePresentKHR(presentQueue, &presentInfo);
+        
+        // wait for everything to be finished before we continue to the next frame
+        // note: this is bad practice but it allows us to focus on the rest of Vulkan first
+        vkDeviceWaitIdle(device);
+        
+        // the draw command is complete now, so we can see how much of the mesh was culled
+        if (!meshShaders && (++frame % 120) == 0)
+            printf("Visible triangles: %u / %zu\n", drawCommand->indexCount / 3, indices.size() / 3);
+    }
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    // we'll do so here at the end of the application
+    // note that these resources may still be in use by the application
+    // so it is recommended to call vkDeviceWaitIdle(device) prior to destroying them.
+    vkDeviceWaitIdle(device);
+    
+    // even though unique ptrs automatically destroy,
+    // this still has to happen before destruction of VkDevice
+    // so we'll do so manually here
+    vertexBuffer.reset();
+    meshletBuffer.reset();
+    meshletIndexBuffer.reset();
+    meshletVertexBuffer.reset();
+    meshletTriangleBuffer.reset();
+    indexBuffer.reset();
+    drawCommandBuffer.reset();
+    viewBuffer.reset();
+    
+    // destroying the pool frees the descriptor set allocated from it
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipeline(device, meshPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    
+    vkDestroyShaderModule(device, vertexShader, nullptr);
+    vkDestroyShaderModule(device, fragmentShader, nullptr);
+    vkDestroyShaderModule(device, cullShader, nullptr);
+    vkDestroyShaderModule(device, taskShader, nullptr);
+    vkDestroyShaderModule(device, meshShader, nullptr);
+    
+    for (size_t i = 0; i < swapchainImages.size(); i++)
+    {
+        vkDestroyFramebuffer(device, swapchainFramebuffers[i], nullptr);
+        vkDestroyImageView(device, swapchainImageViews[i], nullptr);
+    }
+    
+    vkDestroyRenderPass(device, renderpass, nullptr);
+    vkDestroySemaphore(device, imageWaitSemaphore, nullptr);
+    vkDestroySemaphore(device, presentWaitSemaphore, nullptr);
+    vkDestroySwapchainKHR(device, swap.swapchain, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+VkInstance createInstance()
+{
+    Extensions extensionHelper{};
+    extensionHelper.addRequiredGLFW();
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "007_meshlets";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    // mesh shaders require Vulkan 1.1 (for vkGetPhysicalDeviceFeatures2 and SPIR-V 1.4 support)
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 1, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    VkInstance instance;
+    THROW_IF_FAILED(vkCreateInstance(&instanceInfo, nullptr, &instance));
+    return instance;
+}
+
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window)
+{
+    // create a window surface using GLFW's helper function
+    VkSurfaceKHR surface;
+    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create VkSurfaceKHR from GLFW window");
+    
+    return surface;
+}
+
+bool meshShadersSupported(VkPhysicalDevice physicalDevice)
+{
+#ifdef VK_EXT_mesh_shader
+    // mesh shaders need the extension itself, SPIR-V 1.4 and the task/mesh shader features
+    Extensions extensions { physicalDevice };
+    if (!extensions.available("VK_EXT_mesh_shader") || !extensions.available("VK_KHR_spirv_1_4"))
+        return false;
+    
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshFeatures {};
+    meshFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    
+    VkPhysicalDeviceFeatures2 features {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &meshFeatures;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+    
+    return meshFeatures.taskShader && meshFeatures.meshShader;
+#else
+    // VK_EXT_mesh_shader was added to the Vulkan headers in 1.3.231, older SDKs only get the compute path
+    return false;
+#endif
+}
+
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, bool meshShaders)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 2> priorities = { 1, 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // we'll need at least a graphics queue
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    // only create a separate present queue if needed
+    if (graphicsFamily != presentFamily)
+    {
+        deviceQueues.push_back(VkDeviceQueueCreateInfo {
+            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            nullptr,        // pNext
+            0,              // flags (none)
+            static_cast<uint32_t>(presentFamily),
+            1,              // create one queue
+            priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+        });
+    }
+
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_swapchain", true);
+    ext.add("VK_KHR_portability_subset");
+    
+    // features are enabled by chaining their structures into the device create info
+    const void* featureChain = nullptr;
+#ifdef VK_EXT_mesh_shader
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshFeatures {};
+    meshFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    meshFeatures.pNext = nullptr;
+    meshFeatures.taskShader = true;
+    meshFeatures.meshShader = true;
+    
+    if (meshShaders)
+    {
+        ext.add("VK_EXT_mesh_shader", true);
+        ext.add("VK_KHR_spirv_1_4", true);
+        ext.add("VK_KHR_shader_float_controls", true); // required by VK_KHR_spirv_1_4
+        featureChain = &meshFeatures;
+    }
+#endif
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = featureChain;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkRenderPass createRenderpass(VkDevice device, VkFormat format)
+{
+    // next we'll describe a render pass
+    // renderpasses are like a pre-defined render graph
+    // they define sub passes and how they interact with their (and each other's) attachments
+    // this can help greatly improve performance on mobile devices
+    // our renderpass will be fairly simple: 1 subpass with 1 color attachment
+    
+    // describe our color attachment:
+    // - how its used
+    // - how its loaded/stored
+    // - what its layout will be before/after the pass
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = format;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT; // msaa
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    
+    // subpasses must describe their attachments and in what layout they wish to use them
+    // during a renderpass, attachments are transitioned to a subpass's desired layout
+    // thus our attachment starts as UNDEFINED, transitions to COLOR_ATTACHMENT during our subpass, and at the end of the renderpass it transitions to PRESENT_SRC
+    VkAttachmentReference colorRef {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    // describe a simple graphics (not compute) subpass with a single color attachment
+    VkSubpassDescription subpass {};
+    subpass.flags = 0;
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.inputAttachmentCount = 0;
+    subpass.pInputAttachments = nullptr;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    subpass.preserveAttachmentCount = 0;
+    subpass.pPreserveAttachments = nullptr;
+    
+    // create a renderpass with the described color attachment and subpass
+    VkRenderPassCreateInfo renderpassInfo {};
+    renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderpassInfo.pNext = nullptr;
+    renderpassInfo.flags = 0;
+    renderpassInfo.attachmentCount = 1;
+    renderpassInfo.pAttachments = &colorAttachment;
+    renderpassInfo.subpassCount = 1;
+    renderpassInfo.pSubpasses = &subpass;
+    renderpassInfo.dependencyCount = 0;
+    renderpassInfo.pDependencies = nullptr;
+    
+    VkRenderPass renderpass;
+    THROW_IF_FAILED(vkCreateRenderPass(device, &renderpassInfo, nullptr, &renderpass));
+    
+    return renderpass;
+}
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, bool meshShaders)
+{
+    // a descriptor set layout describes the resources a shader can access through a descriptor set
+    // binding numbers match the "binding = x" declarations in the shaders
+    // bindings 1-4 are used by the culling compute shader, bindings 0, 1 and 5-7 by the task and mesh shaders
+    VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT;
+#ifdef VK_EXT_mesh_shader
+    if (meshShaders)
+        stages |= VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+#endif
+    
+    std::array<VkDescriptorSetLayoutBinding, 8> bindings {};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = stages;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext = nullptr;
+    setLayoutInfo.flags = 0;
+    setLayoutInfo.bindingCount = bindings.size();
+    setLayoutInfo.pBindings = bindings.data();
+    
+    VkDescriptorSetLayout setLayout;
+    THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &setLayout));
+    
+    return setLayout;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout, VkShaderStageFlags pushConstantStages)
+{
+    // the view projection matrix is passed as a push constant
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(mat4);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = pushConstantStages;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // all pipelines in this sample share one layout: a single descriptor set plus the push constants
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // the shader stages are passed in, so the same function creates both the vertex and the mesh shader pipeline
+    // mesh shader pipelines don't have a vertex input or input assembly stage
+    bool vertexInput = std::any_of(shaderStages.begin(), shaderStages.end(), [](const VkPipelineShaderStageCreateInfo& stage) { return stage.stage == VK_SHADER_STAGE_VERTEX_BIT; });
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 normal)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 1;
+    pipelineVertexInput.pVertexBindingDescriptions = &vertexBinding;
+    pipelineVertexInput.vertexAttributeDescriptionCount = vertexAttributes.size();
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = swap.extent.width;
+    viewport.height = swap.extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = swap.extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // the projection flips y, so counter clockwise triangles stay counter clockwise on screen
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // these default values disable depth and stencil testing:
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = false;
+    pipelineDepthStencilState.depthWriteEnable = false;
+    pipelineDepthStencilState.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0; // subpass index 0
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = vertexInput ? &pipelineVertexInput : nullptr;
+    pipelineInfo.pInputAssemblyState = vertexInput ? &pipelineAssemblyState : nullptr;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShader)
+{
+    // compute pipelines are a lot simpler than graphics pipelines: a single shader stage and a layout
+    VkComputePipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.flags = 0;
+    pipelineInfo.stage = VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShader, "main", nullptr };
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateComputePipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+void createSphere(uint32_t rings, uint32_t segments, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+    // a unit uv sphere, positions double as normals
+    vertices.clear();
+    indices.clear();
+    
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float theta = ring * 3.14159265f / rings;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float phi = segment * 2.0f * 3.14159265f / segments;
+            float x = sinf(theta) * cosf(phi), y = cosf(theta), z = sinf(theta) * sinf(phi);
+            vertices.insert(vertices.end(), { x, y, z, x, y, z });
+        }
+    }
+    
+    // two counter clockwise (seen from the outside) triangles per quad
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + 1;
+            uint32_t c = a + segments + 1;
+            uint32_t d = c + 1;
+            indices.insert(indices.end(), { a, b, c, b, d, c });
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#version 460
+#extension GL_EXT_mesh_shader : require
+
+// one workgroup per visible meshlet, every invocation outputs up to one vertex and two triangles
+layout(local_size_x = 64) in;
+layout(triangles, max_vertices = 64, max_primitives = 124) out;
+
+struct Meshlet {
+    vec4 sphere;
+    vec4 cone;
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout(std430, set = 0, binding = 5) readonly buffer Vertices { float vertices[]; }; // float3 position, float3 normal
+layout(std430, set = 0, binding = 6) readonly buffer MeshletVertices { uint meshletVertices[]; };
+layout(std430, set = 0, binding = 7) readonly buffer MeshletTriangles { uint meshletTriangles[]; };
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+} constants;
+
+struct Payload {
+    uint meshletIndices[32];
+};
+
+taskPayloadSharedEXT Payload payload;
+
+layout(location = 0) out vec3 fragNormal[];
+
+void main() {
+    Meshlet meshlet = meshlets[payload.meshletIndices[gl_WorkGroupID.x]];
+    SetMeshOutputsEXT(meshlet.vertexCount, meshlet.triangleCount);
+    
+    for (uint i = gl_LocalInvocationIndex; i < meshlet.vertexCount; i += gl_WorkGroupSize.x) {
+        uint v = meshletVertices[meshlet.vertexOffset + i] * 6;
+        vec3 position = vec3(vertices[v + 0], vertices[v + 1], vertices[v + 2]);
+        gl_MeshVerticesEXT[i].gl_Position = constants.viewProjection * vec4(position, 1.0);
+        fragNormal[i] = vec3(vertices[v + 3], vertices[v + 4], vertices[v + 5]);
+    }
+    
+    for (uint i = gl_LocalInvocationIndex; i < meshlet.triangleCount; i += gl_WorkGroupSize.x) {
+        uint packed = meshletTriangles[meshlet.triangleOffset + i];
+        gl_PrimitiveTriangleIndicesEXT[i] = uvec3(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF);
+    }
+}
@@ -0,0 +1,56 @@
+#version 460
+#extension GL_EXT_mesh_shader : require
+
+// the task shader does the same culling as cull.glsl, one invocation per meshlet
+// and launches one mesh shader workgroup per visible meshlet
+layout(local_size_x = 32) in;
+
+struct Meshlet {
+    vec4 sphere; // center.xyz, radius
+    vec4 cone; // axis.xyz, cutoff
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+};
+
+layout(set = 0, binding = 0) uniform View {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint meshletCount;
+} view;
+
+layout(std430, set = 0, binding = 1) readonly buffer Meshlets { Meshlet meshlets[]; };
+
+struct Payload {
+    uint meshletIndices[32];
+};
+
+taskPayloadSharedEXT Payload payload;
+
+shared uint visibleCount;
+
+bool cull(Meshlet meshlet) {
+    for (int i = 0; i < 6; i++) {
+        if (dot(view.frustum[i].xyz, meshlet.sphere.xyz) + view.frustum[i].w < -meshlet.sphere.w)
+            return true;
+    }
+    
+    vec3 toMeshlet = meshlet.sphere.xyz - view.cameraPosition.xyz;
+    return dot(toMeshlet, meshlet.cone.xyz) >= meshlet.cone.w * length(toMeshlet) + meshlet.sphere.w;
+}
+
+void main() {
+    if (gl_LocalInvocationIndex == 0)
+        visibleCount = 0;
+    barrier();
+    
+    uint meshletIndex = gl_GlobalInvocationID.x;
+    if (meshletIndex < view.meshletCount && !cull(meshlets[meshletIndex])) {
+        uint slot = atomicAdd(visibleCount, 1);
+        payload.meshletIndices[slot] = meshletIndex;
+    }
+    barrier();
+    
+    EmitMeshTasksEXT(visibleCount, 1, 1);
+}
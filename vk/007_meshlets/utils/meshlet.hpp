@@ -0,0 +1,219 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "math.hpp"
+
+// a meshlet is a small cluster of triangles that is culled (and in the mesh shader path, processed) as a whole
+// the layout matches the std430 Meshlet struct in the shaders
+struct Meshlet
+{
+    // bounding sphere: center.xyz, radius
+    float center[3];
+    float radius;
+
+    // normal cone: every triangle in the meshlet faces within the cone
+    // coneCutoff is the sine of the cone's half angle, 1 means the cone is too wide to ever be culled
+    float coneAxis[3];
+    float coneCutoff;
+
+    uint32_t vertexOffset; // into MeshletData::vertices
+    uint32_t triangleOffset; // into MeshletData::triangles, and (* 3) into MeshletData::indices
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+};
+
+// the meshlets of a single mesh, along with their vertex and triangle lists
+struct MeshletData
+{
+    std::vector<Meshlet> meshlets;
+
+    // global vertex indices referenced by the meshlets, used by the mesh shader to load its vertices
+    std::vector<uint32_t> vertices;
+
+    // local triangles: three 8 bit indices into the meshlet's vertices, packed into one uint per triangle
+    std::vector<uint32_t> triangles;
+
+    // the same triangles as global vertex indices, so every meshlet is a contiguous index range
+    // this is what the compute culling path copies into the index buffer for the regular vertex pipeline
+    std::vector<uint32_t> indices;
+};
+
+// splits an indexed triangle mesh up into meshlets
+class MeshletBuilder
+{
+public:
+    // 64 vertices and 124 triangles are the limits recommended by most vendors for mesh shaders,
+    // and 124 * 3 local indices still fit in 384 bytes when they're packed as 8 bit values
+    static constexpr uint32_t maxVertices = 64;
+    static constexpr uint32_t maxTriangles = 124;
+
+    // positions are read from vertexData with the given stride in bytes
+    static MeshletData build(const void* vertexData, uint32_t vertexCount, uint32_t vertexStride, const std::vector<uint32_t>& indices)
+    {
+        auto position = [&](uint32_t index) {
+            const float* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertexData) + static_cast<size_t>(index) * vertexStride);
+            return vec3 { p[0], p[1], p[2] };
+        };
+
+        uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+        // build vertex -> triangle adjacency so we can grow meshlets across neighbouring triangles
+        // this keeps meshlets compact, which makes their bounding spheres and normal cones tight
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (uint32_t index : indices)
+            adjacencyOffsets[index + 1]++;
+        for (uint32_t i = 0; i < vertexCount; i++)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; t++)
+            for (uint32_t c = 0; c < 3; c++)
+                adjacency[fill[indices[t * 3 + c]]++] = t;
+
+        MeshletData result;
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<int32_t> localIndex(vertexCount, -1);
+
+        Meshlet current {};
+        std::vector<uint32_t> currentTriangles;
+
+        auto finish = [&]() {
+            if (current.triangleCount == 0)
+                return;
+
+            computeBounds(current, result, currentTriangles, indices, position);
+            result.meshlets.push_back(current);
+
+            for (uint32_t i = 0; i < current.vertexCount; i++)
+                localIndex[result.vertices[current.vertexOffset + i]] = -1;
+
+            current = {};
+            current.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+            current.triangleOffset = static_cast<uint32_t>(result.triangles.size());
+            currentTriangles.clear();
+        };
+
+        // number of vertices the triangle would add to the current meshlet
+        auto newVertices = [&](uint32_t t) {
+            return (localIndex[indices[t * 3 + 0]] < 0 ? 1u : 0u) + (localIndex[indices[t * 3 + 1]] < 0 ? 1u : 0u) + (localIndex[indices[t * 3 + 2]] < 0 ? 1u : 0u);
+        };
+
+        auto append = [&](uint32_t t) {
+            uint32_t packed = 0;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                uint32_t v = indices[t * 3 + c];
+                if (localIndex[v] < 0)
+                {
+                    localIndex[v] = static_cast<int32_t>(current.vertexCount++);
+                    result.vertices.push_back(v);
+                }
+
+                packed |= static_cast<uint32_t>(localIndex[v]) << (c * 8);
+                result.indices.push_back(v);
+            }
+
+            result.triangles.push_back(packed);
+            currentTriangles.push_back(t);
+            current.triangleCount++;
+            emitted[t] = true;
+        };
+
+        uint32_t seed = 0;
+        while (true)
+        {
+            // pick the neighbouring triangle that adds the fewest new vertices to the meshlet
+            uint32_t best = UINT32_MAX;
+            uint32_t bestCost = UINT32_MAX;
+            for (uint32_t i = 0; i < current.vertexCount && bestCost > 0; i++)
+            {
+                uint32_t v = result.vertices[current.vertexOffset + i];
+                for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++)
+                {
+                    uint32_t t = adjacency[a];
+                    if (emitted[t])
+                        continue;
+
+                    uint32_t cost = newVertices(t);
+                    if (cost < bestCost)
+                    {
+                        best = t;
+                        bestCost = cost;
+                    }
+                }
+            }
+
+            // nothing connected to the meshlet is left, start from the next unused triangle instead
+            if (best == UINT32_MAX)
+            {
+                while (seed < triangleCount && emitted[seed])
+                    seed++;
+
+                if (seed == triangleCount)
+                    break;
+
+                finish();
+                best = seed;
+                bestCost = 3;
+            }
+
+            if (current.vertexCount + bestCost > maxVertices || current.triangleCount + 1 > maxTriangles)
+                finish();
+
+            append(best);
+        }
+
+        finish();
+        return result;
+    }
+
+private:
+    template <typename PositionFn>
+    static void computeBounds(Meshlet& meshlet, const MeshletData& data, const std::vector<uint32_t>& triangles, const std::vector<uint32_t>& indices, PositionFn position)
+    {
+        // bounding sphere: center of the meshlet's bounding box, radius to the furthest vertex
+        vec3 minimum = position(data.vertices[meshlet.vertexOffset]);
+        vec3 maximum = minimum;
+        for (uint32_t i = 1; i < meshlet.vertexCount; i++)
+        {
+            vec3 p = position(data.vertices[meshlet.vertexOffset + i]);
+            minimum = { std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z) };
+            maximum = { std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z) };
+        }
+
+        vec3 center = (minimum + maximum) * 0.5f;
+        float radius = 0;
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+            radius = std::max(radius, length(position(data.vertices[meshlet.vertexOffset + i]) - center));
+
+        // normal cone: the axis is the average triangle normal and the cone's angle covers the furthest normal from it
+        std::vector<vec3> normals;
+        vec3 axis {};
+        for (uint32_t t : triangles)
+        {
+            vec3 a = position(indices[t * 3 + 0]), b = position(indices[t * 3 + 1]), c = position(indices[t * 3 + 2]);
+            vec3 n = normalize(cross(b - a, c - a));
+            if (length(n) == 0)
+                continue; // degenerate triangles don't face any direction
+
+            normals.push_back(n);
+            axis += n;
+        }
+
+        axis = normalize(axis);
+        float minDot = 1;
+        for (const vec3& n : normals)
+            minDot = std::min(minDot, dot(n, axis));
+
+        // the cone is stored "inverted" so the shader can test it against the view direction:
+        // a meshlet is backfacing when the angle between the view direction and the axis is smaller than 90 degrees minus the cone's angle
+        // that angle's cosine is sin(coneAngle) = sqrt(1 - minDot^2). cones of 90 degrees or more can't be culled.
+        float cutoff = (minDot <= 0 || normals.empty()) ? 1.0f : sqrtf(1 - minDot * minDot);
+
+        meshlet.center[0] = center.x; meshlet.center[1] = center.y; meshlet.center[2] = center.z;
+        meshlet.radius = radius;
+        meshlet.coneAxis[0] = axis.x; meshlet.coneAxis[1] = axis.y; meshlet.coneAxis[2] = axis.z;
+        meshlet.coneCutoff = cutoff;
+    }
+};
@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+layout(location = 0) out vec3 fragNormal;
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+} constants;
+
+void main() {
+    gl_Position = constants.viewProjection * vec4(position, 1.0);
+    fragNormal = normal;
+}
@@ -0,0 +1,1012 @@
+// this sample draws a field of objects that all share one mesh, at a level of detail that fits their size on screen
+// at load time the mesh is simplified over and over again with quadric error metric edge collapses (utils/simplify.hpp),
+// every level has roughly half of the triangles of the previous one. all levels index the same vertices,
+// so the whole LOD chain is stored as a single mesh in the geometry pool from 006_geometry_pool.
+// every level remembers the geometric error it introduced. projected to the screen this error is measured in pixels,
+// and every object picks the coarsest level whose error stays below a pixel.
+// the selection runs on the GPU in the culling pass: one compute invocation per object culls it against the frustum,
+// selects its level and appends an indirect draw command. run with --cpu-lod to do the same work on the CPU instead.
+// objects are colored by their level: white is full detail, followed by blue, green, yellow, orange, red, purple and grey.
+
+// see lines
+// * utils/simplify.hpp for the simplification, utils/lod.hpp for the LOD chain and selection
+// * cull.glsl for the GPU culling and LOD selection
+// * 131-150 Building the LOD chain and storing it in the geometry pool
+// * 285-315 CPU culling and LOD selection, 374-385 drawing every visible object from the geometry pool
+// * 317-354 GPU culling and LOD selection, 386-407 drawing the result with a single (count) indirect draw
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <cmath>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/physical_device.hpp"
+#include "utils/swapchain.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/geometry_pool.hpp"
+#include "utils/math.hpp"
+#include "utils/lod.hpp"
+
+// matches the View uniform block in cull.glsl
+struct ViewData
+{
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint32_t objectCount;
+    uint32_t lodCount;
+    int32_t vertexOffset;
+    float projectionScale;
+    float pixelThreshold;
+    float radius;
+    uint32_t compact;
+    uint32_t padding;
+};
+
+VkInstance createInstance();
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window);
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, const VkPhysicalDeviceFeatures& features, bool drawIndirectCount);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkRenderPass createRenderpass(VkDevice device, VkFormat format);
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device);
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout);
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShader);
+void createSphere(uint32_t rings, uint32_t segments, std::vector<float>& vertices, std::vector<uint32_t>& indices);
+
+int main(int argc, char** argv) {
+    // default GLFW window creation except we disable OpenGL context creation
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 800, "008_lod", nullptr, nullptr);
+    
+    VkInstance instance = createInstance();
+    VkSurfaceKHR surface = createSurface(instance, window);
+    
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice = PhysicalDevice::select(instance, surface, &families);
+    
+    // the GPU path passes the object index through firstInstance, which indirect draws only support with drawIndirectFirstInstance
+    // without VK_KHR_draw_indirect_count the GPU can't tell us how many draws it wrote, so every object keeps a draw command
+    // and culled objects get 0 instances. drawing all of those at once needs multiDrawIndirect.
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+    
+    VkPhysicalDeviceFeatures features {};
+    features.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    features.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    
+    bool drawIndirectCount = false;
+#ifdef VK_KHR_draw_indirect_count
+    drawIndirectCount = Extensions { physicalDevice }.available("VK_KHR_draw_indirect_count");
+#endif
+    
+    bool gpuLod = features.drawIndirectFirstInstance;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--cpu-lod") == 0)
+            gpuLod = false;
+    printf("Selecting levels of detail on the %s\n", gpuLod ? "GPU" : "CPU");
+    
+    VkDevice device = createDevice(instance, physicalDevice, families.graphics, families.present, features, drawIndirectCount);
+    VkQueue graphicsQueue; vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+    VkQueue presentQueue; vkGetDeviceQueue(device, families.present, 0, &presentQueue);
+    
+    VkCommandPool commandPool = createCommandPool(device, families.graphics);
+    VkCommandBuffer cmd = allocateCommandBuffer(device, commandPool);
+    
+    Swapchain swap = Swapchain::create(device, physicalDevice, surface, families.graphics, families.present);
+    
+    VkRenderPass renderpass = createRenderpass(device, swap.format);
+    auto swapchainImages = swap.getImages(device);
+    auto swapchainImageViews = swap.getImageViews(device);
+    auto swapchainFramebuffers = swap.getFramebuffers(device, renderpass);
+    
+    // semaphores are for GPU-GPU synchronization
+    // imageWaitSemaphore: Makes our command buffer wait on vkAcquireNextImageKHR to be finished
+    // presentWaitSemaphore: Makes vkQueuePresentKHR wait on our commands to be done rendering
+    VkSemaphoreCreateInfo semaphoreInfo { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0 };
+    VkSemaphore imageWaitSemaphore, presentWaitSemaphore;
+    THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageWaitSemaphore));
+    THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &presentWaitSemaphore));
+    
+    VkDescriptorSetLayout setLayout = createDescriptorSetLayout(device);
+    VkPipelineLayout pipelineLayout = createPipelineLayout(device, setLayout);
+    
+    VkShaderModule vertexShader = Shader::load(device, "../008_lod/vertex.spv");
+    VkShaderModule fragmentShader = Shader::load(device, "../008_lod/fragment.spv");
+    VkShaderModule cullShader = Shader::load(device, "../008_lod/cull.spv");
+    VkPipeline pipeline = createPipeline(device, swap, renderpass, pipelineLayout, vertexShader, fragmentShader);
+    VkPipeline cullPipeline = createComputePipeline(device, pipelineLayout, cullShader);
+    
+    // vertex: { float3 pos, float3 normal }
+    // a finely tessellated unit sphere, far more detail than most objects need at their size on screen
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    createSphere(64, 128, vertices, indices);
+    uint32_t vertexCount = vertices.size() / 6;
+    
+    LodChain lodChain = LodChain::build(vertices.data(), vertexCount, sizeof(float) * 6, indices);
+    for (size_t i = 0; i < lodChain.levels.size(); i++)
+        printf("LOD %zu: %u triangles, error %f\n", i, lodChain.levels[i].indexCount / 3, lodChain.levels[i].error);
+    
+    // the whole chain is one mesh in the pool, every level is a range within the mesh's indices
+    std::unique_ptr<GeometryPool> geometry = std::make_unique<GeometryPool>(device, physicalDevice, families, sizeof(float) * 6, sizeof(float) * vertices.size(), sizeof(uint32_t) * lodChain.indices.size());
+    Mesh mesh = geometry->add(vertices.data(), vertexCount, lodChain.indices.data(), lodChain.indices.size());
+    
+    // the GPU draws straight from the pool's index buffer, so the levels need the mesh's offset into it
+    std::vector<LodLevel> lods = lodChain.levels;
+    for (LodLevel& lod : lods)
+        lod.firstIndex += mesh.firstIndex;
+    uint32_t lodCount = lods.size();
+    
+    // a grid of objects spread out over view rays from the camera, at varying distances
+    // the grid is a bit wider than the field of view so the outer objects get frustum culled as the camera turns
+    // an object's angular size on screen only shrinks with distance, so objects are sized to never overlap at the closest distance
+    const uint32_t gridSize = 24;
+    const uint32_t objectCount = gridSize * gridSize;
+    const float angularSpacing = 0.06f;
+    const float nearestDistance = 3.0f;
+    const float objectScale = nearestDistance * tanf(angularSpacing * 0.5f) * 0.9f;
+    const float sphereRadius = 1.0f;
+    
+    // object data is rewritten every frame, so it's host visible
+    // objectLods is written by whichever side selects the levels, the vertex shader colors every object by its level
+    std::unique_ptr<Buffer> objectBuffer = Buffer::create(device, physicalDevice, families, sizeof(vec4) * objectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    std::unique_ptr<Buffer> objectLodBuffer = Buffer::create(device, physicalDevice, families, sizeof(uint32_t) * objectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    std::unique_ptr<Buffer> lodBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(LodLevel) * lodCount, lods.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    std::unique_ptr<Buffer> viewBuffer = Buffer::create(device, physicalDevice, families, sizeof(ViewData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vec4* objects = reinterpret_cast<vec4*>(objectBuffer->map());
+    uint32_t* objectLods = reinterpret_cast<uint32_t*>(objectLodBuffer->map());
+    ViewData* viewData = reinterpret_cast<ViewData*>(viewBuffer->map());
+    
+    // the culling shader writes one draw command per visible object, and counts them in the draw count buffer
+    std::unique_ptr<Buffer> drawCommandBuffer = Buffer::create(device, physicalDevice, families, sizeof(VkDrawIndexedIndirectCommand) * objectCount, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    std::unique_ptr<Buffer> drawCountBuffer = Buffer::create(device, physicalDevice, families, sizeof(uint32_t), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    
+    // extension functions aren't exported by the loader, so we have to look them up ourselves
+    PFN_vkVoidFunction cmdDrawIndexedIndirectCount = nullptr;
+    if (drawIndirectCount)
+        cmdDrawIndexedIndirectCount = vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+    
+    // the culling and vertex shaders access their buffers through a descriptor set
+    // descriptor sets are allocated from a descriptor pool, which must be large enough for all of the set's bindings
+    std::array<VkDescriptorPoolSize, 2> poolSizes {
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 }
+    };
+    
+    VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext = nullptr;
+    descriptorPoolInfo.flags = 0;
+    descriptorPoolInfo.maxSets = 1;
+    descriptorPoolInfo.poolSizeCount = poolSizes.size();
+    descriptorPoolInfo.pPoolSizes = poolSizes.data();
+    
+    VkDescriptorPool descriptorPool;
+    THROW_IF_FAILED(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool));
+    
+    VkDescriptorSetAllocateInfo setAllocInfo {};
+    setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setAllocInfo.pNext = nullptr;
+    setAllocInfo.descriptorPool = descriptorPool;
+    setAllocInfo.descriptorSetCount = 1;
+    setAllocInfo.pSetLayouts = &setLayout;
+    
+    VkDescriptorSet descriptorSet;
+    THROW_IF_FAILED(vkAllocateDescriptorSets(device, &setAllocInfo, &descriptorSet));
+    
+    // point every binding in the set at its buffer, the binding numbers match the shaders
+    std::array<VkDescriptorBufferInfo, 6> bufferInfos {
+        VkDescriptorBufferInfo { viewBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { objectBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { lodBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { drawCommandBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { drawCountBuffer->buffer, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo { objectLodBuffer->buffer, 0, VK_WHOLE_SIZE }
+    };
+    
+    std::vector<VkWriteDescriptorSet> writes(bufferInfos.size());
+    for (uint32_t i = 0; i < bufferInfos.size(); i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].pNext = nullptr;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+    
+    const float fovY = 1.0f;
+    const float pixelThreshold = 1.0f;
+    float t = 0;
+    uint32_t frame = 0;
+    
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        
+        // Acquire the next image to render to
+        // the frame might not immediately be ready (swapchain may stall for e.g. vsync)
+        // so we must wait with either a semaphore (GPU-GPU sync) or a fence (CPU-GPU sync)
+        uint32_t imageIndex;
+        vkAcquireNextImageKHR(device, swap.swapchain, UINT_MAX, imageWaitSemaphore, /* fence */ nullptr, &imageIndex);
+        
+        // the camera sits at the origin and slowly turns left and right
+        t += 0.005f;
+        vec3 eye { 0, 0, 0 };
+        vec3 forward { sinf(t) * 0.3f, 0, -1 };
+        mat4 view = mat4::lookAt(eye, forward, vec3 { 0, 1, 0 });
+        mat4 projection = mat4::perspective(fovY, swap.extent.width / float(swap.extent.height), 0.05f, 500.0f);
+        mat4 viewProjection = projection * view;
+        
+        // converts a size at a distance of 1 into pixels on screen
+        float projectionScale = swap.extent.height / (2.0f * tanf(fovY * 0.5f));
+        
+        // every object moves back and forth along its own view ray, between nearestDistance and 30x as far
+        // the previous frame has finished (we wait for idle at the end of every frame) so we can write the buffers directly
+        for (uint32_t y = 0; y < gridSize; y++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                float yaw = (x - (gridSize - 1) * 0.5f) * angularSpacing;
+                float pitch = (y - (gridSize - 1) * 0.5f) * angularSpacing;
+                vec3 direction = normalize(vec3 { tanf(yaw), tanf(pitch), -1 });
+                float distance = nearestDistance * (1 + 29 * (0.5f + 0.5f * sinf(t * 2 + x * 0.7f + y * 1.3f)));
+                
+                vec3 center = direction * distance;
+                objects[y * gridSize + x] = { center.x, center.y, center.z, objectScale };
+            }
+        }
+        
+        vec4 frustum[6];
+        frustumPlanes(viewProjection, frustum);
+        
+        // describe how we'll start recording the command buffer
+        // this is usually fairly simple for primary command buffers
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = 0;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(cmd, &beginInfo); // start recording
+        
+        // CPU path: the same culling and selection as cull.glsl, after which every visible object is drawn with its level's index range
+        struct ObjectDraw { Mesh mesh; uint32_t object; };
+        std::vector<ObjectDraw> objectDraws;
+        if (!gpuLod)
+        {
+            for (uint32_t i = 0; i < objectCount; i++)
+            {
+                vec3 center { objects[i].x, objects[i].y, objects[i].z };
+                float radius = sphereRadius * objects[i].w;
+                
+                bool visible = true;
+                for (const vec4& plane : frustum)
+                    if (dot(vec3 { plane.x, plane.y, plane.z }, center) + plane.w < -radius)
+                        visible = false;
+                
+                if (!visible)
+                {
+                    objectLods[i] = ~0u;
+                    continue;
+                }
+                
+                uint32_t lod = selectLod(lods.data(), lodCount, center, radius, objects[i].w, eye, projectionScale, pixelThreshold);
+                objectLods[i] = lod;
+                
+                // the object's index goes into firstInstance, same as the GPU path, so both paths share the vertex shader
+                Mesh lodMesh = mesh;
+                lodMesh.firstIndex = lods[lod].firstIndex;
+                lodMesh.indexCount = lods[lod].indexCount;
+                objectDraws.push_back(ObjectDraw { lodMesh, i });
+            }
+        }
+        
+        // GPU path: one invocation per object writes a draw command for every visible object
+        if (gpuLod)
+        {
+            for (int i = 0; i < 6; i++)
+                viewData->frustum[i] = frustum[i];
+            viewData->cameraPosition = { eye.x, eye.y, eye.z, 1 };
+            viewData->objectCount = objectCount;
+            viewData->lodCount = lodCount;
+            viewData->vertexOffset = mesh.vertexOffset;
+            viewData->projectionScale = projectionScale;
+            viewData->pixelThreshold = pixelThreshold;
+            viewData->radius = sphereRadius;
+            viewData->compact = drawIndirectCount ? 1 : 0;
+            
+            // reset the draw count, the culling shader appends to it
+            vkCmdFillBuffer(cmd, drawCountBuffer->buffer, 0, sizeof(uint32_t), 0);
+            
+            // the culling shader may only start appending once the reset has landed
+            VkBufferMemoryBarrier resetBarrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+            resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            resetBarrier.buffer = drawCountBuffer->buffer;
+            resetBarrier.offset = 0;
+            resetBarrier.size = VK_WHOLE_SIZE;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &resetBarrier, 0, nullptr);
+            
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdDispatch(cmd, (objectCount + 63) / 64, 1, 1);
+            
+            // the draws read the commands and the count, the vertex shader reads the selected levels
+            VkMemoryBarrier cullBarrier { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+            cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+        }
+        
+        // pick a clear color - float32 is in RGBA [0 - 1]
+        VkClearValue clearValue {};
+        clearValue.color.float32[0] = 0;
+        clearValue.color.float32[1] = 0;
+        clearValue.color.float32[2] = 0;
+        clearValue.color.float32[3] = 1;
+        
+        VkRenderPassBeginInfo renderpassBegin {};
+        renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderpassBegin.pNext = nullptr;
+        renderpassBegin.renderPass = renderpass;
+        renderpassBegin.framebuffer = swapchainFramebuffers[imageIndex];
+        renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, swap.extent };
+        renderpassBegin.clearValueCount = 1;
+        renderpassBegin.pClearValues = &clearValue;
+        
+        vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4), viewProjection.m);
+        geometry->bind(cmd);
+        
+        if (!gpuLod)
+        {
+            for (const ObjectDraw& draw : objectDraws)
+                geometry->draw(cmd, draw.mesh, 1, draw.object);
+        }
+        else
+        {
+            // the draw commands index the pool directly, so the index buffer is bound by hand here
+            vkCmdBindIndexBuffer(cmd, geometry->indexBuffer(), 0, mesh.indexType);
+            
+            if (drawIndirectCount)
+            {
+#ifdef VK_KHR_draw_indirect_count
+                // the number of draws comes from the GPU written count, capped at one draw per object
+                reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(cmdDrawIndexedIndirectCount)(cmd, drawCommandBuffer->buffer, 0, drawCountBuffer->buffer, 0, objectCount, sizeof(VkDrawIndexedIndirectCommand));
+#endif
+            }
+            else if (features.multiDrawIndirect)
+            {
+                // one draw command per object, culled objects have 0 instances
+                vkCmdDrawIndexedIndirect(cmd, drawCommandBuffer->buffer, 0, objectCount, sizeof(VkDrawIndexedIndirectCommand));
+            }
+            else
+            {
+                // without multiDrawIndirect every indirect draw can only read a single command
+                for (uint32_t i = 0; i < objectCount; i++)
+                    vkCmdDrawIndexedIndirect(cmd, drawCommandBuffer->buffer, sizeof(VkDrawIndexedIndirectCommand) * i, 1, sizeof(VkDrawIndexedIndirectCommand));
+            }
+        }
+        
+        vkCmdEndRenderPass(cmd);
+        
+        vkEndCommandBuffer(cmd); // end recording
+        
+        // this can be more optimal or specialized by picking a more specific pipeline stage
+        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        
+        // submit the command list to the graphics queue
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = nullptr;
+        submit.waitSemaphoreCount = 1;
+        submit.pWaitSemaphores = &imageWaitSemaphore; // wait for the image to be ready before the commands can execute
+        submit.pWaitDstStageMask = &waitStageMask;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cmd;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &presentWaitSemaphore; // signal the present wait semaphore afterwards so present() can wait on it
+        vkQueueSubmit(graphicsQueue, 1, &submit, nullptr);
+        
+        // after we're done rendering, we'll present our image to the screen.
+        VkResult result;
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.pNext = nullptr;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &presentWaitSemaphore; // present after waiting is done
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swap.swapchain;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = &result;
+        vkQueuePresentKHR(presentQueue, &presentInfo);
+        
+        // wait for everything to be finished before we continue to the next frame
+        // note: this is bad practice but it allows us to focus on the rest of Vulkan first
+        vkDeviceWaitIdle(device);
+        
+        // the selected levels are complete now (whichever side picked them), so we can see what LOD bought us
+        if ((++frame % 120) == 0)
+        {
+            std::array<uint32_t, LodChain::maxLevels> histogram {};
+            uint32_t visibleObjects = 0;
+            size_t triangles = 0;
+            for (uint32_t i = 0; i < objectCount; i++)
+            {
+                if (objectLods[i] == ~0u)
+                    continue;
+                
+                histogram[objectLods[i]]++;
+                visibleObjects++;
+                triangles += lods[objectLods[i]].indexCount / 3;
+            }
+            
+            printf("Visible objects: %u / %u, triangles: %zu (%zu without LOD), per level:", visibleObjects, objectCount, triangles, visibleObjects * indices.size() / 3);
+            for (uint32_t i = 0; i < lodCount; i++)
+                printf(" %u", histogram[i]);
+            printf("\n");
+        }
+    }
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    // we'll do so here at the end of the application
+    // note that these resources may still be in use by the application
+    // so it is recommended to call vkDeviceWaitIdle(device) prior to destroying them.
+    vkDeviceWaitIdle(device);
+    
+    // even though unique ptrs automatically destroy,
+    // this still has to happen before destruction of VkDevice
+    // so we'll do so manually here
+    geometry.reset();
+    objectBuffer.reset();
+    objectLodBuffer.reset();
+    lodBuffer.reset();
+    viewBuffer.reset();
+    drawCommandBuffer.reset();
+    drawCountBuffer.reset();
+    
+    // destroying the pool frees the descriptor set allocated from it
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    
+    vkDestroyShaderModule(device, vertexShader, nullptr);
+    vkDestroyShaderModule(device, fragmentShader, nullptr);
+    vkDestroyShaderModule(device, cullShader, nullptr);
+    
+    for (size_t i = 0; i < swapchainImages.size(); i++)
+    {
+        vkDestroyFramebuffer(device, swapchainFramebuffers[i], nullptr);
+        vkDestroyImageView(device, swapchainImageViews[i], nullptr);
+    }
+    
+    vkDestroyRenderPass(device, renderpass, nullptr);
+    vkDestroySemaphore(device, imageWaitSemaphore, nullptr);
+    vkDestroySemaphore(device, presentWaitSemaphore, nullptr);
+    vkDestroySwapchainKHR(device, swap.swapchain, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+VkInstance createInstance()
+{
+    Extensions extensionHelper{};
+    extensionHelper.addRequiredGLFW();
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "008_lod";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    VkInstance instance;
+    THROW_IF_FAILED(vkCreateInstance(&instanceInfo, nullptr, &instance));
+    return instance;
+}
+
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window)
+{
+    // create a window surface using GLFW's helper function
+    VkSurfaceKHR surface;
+    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create VkSurfaceKHR from GLFW window");
+    
+    return surface;
+}
+
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, const VkPhysicalDeviceFeatures& features, bool drawIndirectCount)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 2> priorities = { 1, 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // we'll need at least a graphics queue
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    // only create a separate present queue if needed
+    if (graphicsFamily != presentFamily)
+    {
+        deviceQueues.push_back(VkDeviceQueueCreateInfo {
+            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            nullptr,        // pNext
+            0,              // flags (none)
+            static_cast<uint32_t>(presentFamily),
+            1,              // create one queue
+            priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+        });
+    }
+
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_swapchain", true);
+    ext.add("VK_KHR_portability_subset");
+    
+    // draw_indirect_count lets the GPU decide how many indirect draws are executed
+    if (drawIndirectCount)
+        ext.add("VK_KHR_draw_indirect_count", true);
+    
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = nullptr;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    deviceInfo.pEnabledFeatures = &features; // core features are enabled through VkPhysicalDeviceFeatures
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkRenderPass createRenderpass(VkDevice device, VkFormat format)
+{
+    // next we'll describe a render pass
+    // renderpasses are like a pre-defined render graph
+    // they define sub passes and how they interact with their (and each other's) attachments
+    // this can help greatly improve performance on mobile devices
+    // our renderpass will be fairly simple: 1 subpass with 1 color attachment
+    
+    // describe our color attachment:
+    // - how its used
+    // - how its loaded/stored
+    // - what its layout will be before/after the pass
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = format;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT; // msaa
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    
+    // subpasses must describe their attachments and in what layout they wish to use them
+    // during a renderpass, attachments are transitioned to a subpass's desired layout
+    // thus our attachment starts as UNDEFINED, transitions to COLOR_ATTACHMENT during our subpass, and at the end of the renderpass it transitions to PRESENT_SRC
+    VkAttachmentReference colorRef {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    // describe a simple graphics (not compute) subpass with a single color attachment
+    VkSubpassDescription subpass {};
+    subpass.flags = 0;
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.inputAttachmentCount = 0;
+    subpass.pInputAttachments = nullptr;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    subpass.preserveAttachmentCount = 0;
+    subpass.pPreserveAttachments = nullptr;
+    
+    // create a renderpass with the described color attachment and subpass
+    VkRenderPassCreateInfo renderpassInfo {};
+    renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderpassInfo.pNext = nullptr;
+    renderpassInfo.flags = 0;
+    renderpassInfo.attachmentCount = 1;
+    renderpassInfo.pAttachments = &colorAttachment;
+    renderpassInfo.subpassCount = 1;
+    renderpassInfo.pSubpasses = &subpass;
+    renderpassInfo.dependencyCount = 0;
+    renderpassInfo.pDependencies = nullptr;
+    
+    VkRenderPass renderpass;
+    THROW_IF_FAILED(vkCreateRenderPass(device, &renderpassInfo, nullptr, &renderpass));
+    
+    return renderpass;
+}
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device)
+{
+    // a descriptor set layout describes the resources a shader can access through a descriptor set
+    // binding numbers match the "binding = x" declarations in the shaders
+    // all bindings are used by the culling compute shader, the vertex shader reads the objects (1) and their levels (5)
+    VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+    
+    std::array<VkDescriptorSetLayoutBinding, 6> bindings {};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = stages;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext = nullptr;
+    setLayoutInfo.flags = 0;
+    setLayoutInfo.bindingCount = bindings.size();
+    setLayoutInfo.pBindings = bindings.data();
+    
+    VkDescriptorSetLayout setLayout;
+    THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &setLayout));
+    
+    return setLayout;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout)
+{
+    // the view projection matrix is passed as a push constant
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(mat4);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // all pipelines in this sample share one layout: a single descriptor set plus the push constants
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // describe our vertex and fragment shader (shader stage, entry point) for the pipeline
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertexShader, "main", nullptr },
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, "main", nullptr }
+    };
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 normal)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 1;
+    pipelineVertexInput.pVertexBindingDescriptions = &vertexBinding;
+    pipelineVertexInput.vertexAttributeDescriptionCount = vertexAttributes.size();
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = swap.extent.width;
+    viewport.height = swap.extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = swap.extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // the projection flips y, so counter clockwise triangles stay counter clockwise on screen
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // these default values disable depth and stencil testing:
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = false;
+    pipelineDepthStencilState.depthWriteEnable = false;
+    pipelineDepthStencilState.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0; // subpass index 0
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShader)
+{
+    // compute pipelines are a lot simpler than graphics pipelines: a single shader stage and a layout
+    VkComputePipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.flags = 0;
+    pipelineInfo.stage = VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShader, "main", nullptr };
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateComputePipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+void createSphere(uint32_t rings, uint32_t segments, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+    // a unit uv sphere, positions double as normals
+    vertices.clear();
+    indices.clear();
+    
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float theta = ring * 3.14159265f / rings;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float phi = segment * 2.0f * 3.14159265f / segments;
+            float x = sinf(theta) * cosf(phi), y = cosf(theta), z = sinf(theta) * sinf(phi);
+            vertices.insert(vertices.end(), { x, y, z, x, y, z });
+        }
+    }
+    
+    // two counter clockwise (seen from the outside) triangles per quad
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + 1;
+            uint32_t c = a + segments + 1;
+            uint32_t d = c + 1;
+            indices.insert(indices.end(), { a, b, c, b, d, c });
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "math.hpp"
+#include "simplify.hpp"
+
+// a single level of detail: a range in the mesh's index list and the error it introduces compared to the full mesh
+// the layout matches the std430 LodLevel struct in cull.glsl
+struct LodLevel
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error; // in the mesh's units
+    uint32_t padding = 0;
+};
+
+// all levels of detail of a mesh, from full detail to the coarsest level
+// the levels are stored back to back in one index list and all index the same vertices,
+// so the whole chain can be stored as a single mesh in a geometry pool
+struct LodChain
+{
+    static constexpr uint32_t maxLevels = 8;
+
+    std::vector<uint32_t> indices;
+    std::vector<LodLevel> levels;
+
+    // every level aims for half of the previous level's triangles
+    // the chain ends once simplification stops making progress, or the mesh is down to a handful of triangles
+    static LodChain build(const void* vertexData, uint32_t vertexCount, uint32_t vertexStride, const std::vector<uint32_t>& sourceIndices)
+    {
+        LodChain chain;
+        chain.indices = sourceIndices;
+        chain.levels.push_back(LodLevel { 0, static_cast<uint32_t>(sourceIndices.size()), 0.0f });
+
+        std::vector<uint32_t> previous = sourceIndices;
+        float previousError = 0;
+        while (chain.levels.size() < maxLevels && previous.size() / 3 > 64)
+        {
+            float error = 0;
+            std::vector<uint32_t> simplified = Simplifier::simplify(vertexData, vertexCount, vertexStride, previous, previous.size() / 2, &error);
+            if (simplified.size() > previous.size() * 9 / 10)
+                break;
+
+            // each level is simplified from the previous one, so the errors add up
+            previousError += error;
+
+            chain.levels.push_back(LodLevel { static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(simplified.size()), previousError });
+            chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+            previous = std::move(simplified);
+        }
+
+        return chain;
+    }
+};
+
+// projectionScale converts a size at distance 1 into pixels: viewportHeight / (2 * tan(fovY / 2))
+// this is the same function as selectLod() in cull.glsl
+inline uint32_t selectLod(const LodLevel* levels, uint32_t levelCount, const vec3& center, float radius, float scale, const vec3& cameraPosition, float projectionScale, float pixelThreshold)
+{
+    // measure from the closest point of the bounding sphere, so the object never switches too late
+    float distance = std::max(length(center - cameraPosition) - radius, 0.001f);
+
+    // pick the coarsest level whose error still projects to less than the threshold
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i < levelCount; i++)
+    {
+        float projectedError = levels[i].error * scale * projectionScale / distance;
+        if (projectedError > pixelThreshold)
+            break;
+
+        lod = i;
+    }
+
+    return lod;
+}
@@ -0,0 +1,796 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include "preprocessor.hpp"
+#include "memory.hpp"
+
+// a render graph describes a frame as a list of passes, where every pass declares which resources it reads and writes.
+// from those declarations the graph works out everything that used to be written by hand:
+// - passes whose results are never used are culled
+// - every pass gets exactly the barriers (and layout transitions) it needs, batched into a single vkCmdPipelineBarrier
+// - render passes and framebuffers for graphics passes, with storeOp DONT_CARE for attachments nobody reads afterwards
+// - transient images whose lifetimes don't overlap share the same memory
+// passes run in the order they were added, the graph only decides what runs and how it is synchronized.
+// the graph is compiled once, after which execute() records a frame. imported images (the swapchain) can change every frame.
+class RenderGraph
+{
+public:
+    using Resource = uint32_t;
+    using Pass = uint32_t;
+
+    // the ways a pass can use a resource, each one maps to a pipeline stage, an access mask and (for images) a layout
+    enum class Usage
+    {
+        ColorAttachment,
+        DepthAttachment,
+        DepthAttachmentRead, // depth testing without writing, e.g. after a depth prepass
+        SampledFragment,
+        SampledCompute,
+        StorageCompute,
+        StorageVertex,
+        IndirectRead,
+        TransferWrite,
+    };
+
+    // handed to a pass's setup function, records what the pass reads and writes
+    class PassBuilder
+    {
+    public:
+        // attachments of graphics passes, in the order the pipeline's color outputs expect them
+        void color(Resource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearValue = {})
+        {
+            VkClearValue clear;
+            clear.color = clearValue;
+            m_graph.addAttachment(m_pass, resource, Usage::ColorAttachment, loadOp, clear);
+        }
+
+        void depth(Resource resource, VkAttachmentLoadOp loadOp, float clearDepth = 1.0f)
+        {
+            VkClearValue clear;
+            clear.depthStencil = VkClearDepthStencilValue { clearDepth, 0 };
+            m_graph.addAttachment(m_pass, resource, Usage::DepthAttachment, loadOp, clear);
+        }
+
+        void depthReadOnly(Resource resource)
+        {
+            m_graph.addAttachment(m_pass, resource, Usage::DepthAttachmentRead, VK_ATTACHMENT_LOAD_OP_LOAD, VkClearValue {});
+        }
+
+        void read(Resource resource, Usage usage) { m_graph.addAccess(m_pass, resource, usage, true, false); }
+        void write(Resource resource, Usage usage) { m_graph.addAccess(m_pass, resource, usage, false, true); }
+        void readWrite(Resource resource, Usage usage) { m_graph.addAccess(m_pass, resource, usage, true, true); }
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, Pass pass) : m_graph(graph), m_pass(pass) {}
+
+        RenderGraph& m_graph;
+        Pass m_pass;
+    };
+
+    RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice) : m_device(device), m_physicalDevice(physicalDevice) {}
+
+    ~RenderGraph()
+    {
+        for (auto& framebuffer : m_framebuffers)
+            vkDestroyFramebuffer(m_device, framebuffer.second, nullptr);
+
+        for (PassData& pass : m_passes)
+            vkDestroyRenderPass(m_device, pass.renderpass, nullptr);
+
+        for (ResourceData& resource : m_resources)
+        {
+            if (resource.imported)
+                continue;
+
+            vkDestroyImageView(m_device, resource.view, nullptr);
+            vkDestroyImage(m_device, resource.image, nullptr);
+        }
+
+        for (VkDeviceMemory memory : m_memory)
+            vkFreeMemory(m_device, memory, nullptr);
+    }
+
+    // an image that only lives within a frame, created (and placed in memory) by the graph
+    Resource createImage(const char* name, VkFormat format, VkExtent2D extent)
+    {
+        ResourceData resource {};
+        resource.name = name;
+        resource.format = format;
+        resource.extent = extent;
+        m_resources.push_back(resource);
+        return static_cast<Resource>(m_resources.size() - 1);
+    }
+
+    // an image owned by someone else, whose contents are the output of the frame
+    // the image is assumed to be in an undefined layout, and available once the color attachment output stage starts
+    // (which is the stage the swapchain's acquire semaphore is waited on). it's left in finalLayout at the end of the frame
+    Resource importImage(const char* name, VkFormat format, VkExtent2D extent, VkImageLayout finalLayout)
+    {
+        Resource resource = createImage(name, format, extent);
+        m_resources[resource].imported = true;
+        m_resources[resource].output = true;
+        m_resources[resource].finalLayout = finalLayout;
+        return resource;
+    }
+
+    // a buffer owned by someone else, the graph only synchronizes access to it
+    Resource importBuffer(const char* name, VkBuffer buffer)
+    {
+        ResourceData resource {};
+        resource.name = name;
+        resource.buffer = buffer;
+        resource.imported = true;
+        m_resources.push_back(resource);
+        return static_cast<Resource>(m_resources.size() - 1);
+    }
+
+    // the swapchain image changes every frame, so imported images are set right before execute()
+    void setImportedImage(Resource resource, VkImage image, VkImageView view)
+    {
+        m_resources[resource].image = image;
+        m_resources[resource].view = view;
+    }
+
+    // graphics passes render to the attachments they declare, other passes (compute, transfer) only get the barriers
+    Pass addPass(const char* name, bool graphics, const std::function<void(PassBuilder&)>& setup, std::function<void(VkCommandBuffer)> execute)
+    {
+        PassData pass {};
+        pass.name = name;
+        pass.graphics = graphics;
+        pass.execute = std::move(execute);
+        m_passes.push_back(std::move(pass));
+
+        Pass handle = static_cast<Pass>(m_passes.size() - 1);
+        PassBuilder builder { *this, handle };
+        setup(builder);
+        return handle;
+    }
+
+    void compile()
+    {
+        cull();
+        computeLifetimes();
+        allocateImages();
+        computeBarriers();
+        createRenderpasses();
+        printSummary();
+    }
+
+    // record the whole frame
+    void execute(VkCommandBuffer cmd)
+    {
+        for (PassData& pass : m_passes)
+        {
+            if (pass.culled)
+                continue;
+
+            recordBarriers(cmd, pass.barriers);
+
+            if (!pass.graphics)
+            {
+                pass.execute(cmd);
+                continue;
+            }
+
+            std::vector<VkClearValue> clearValues;
+            for (const Attachment& attachment : pass.attachments)
+                clearValues.push_back(attachment.clearValue);
+
+            VkRenderPassBeginInfo renderpassBegin {};
+            renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderpassBegin.pNext = nullptr;
+            renderpassBegin.renderPass = pass.renderpass;
+            renderpassBegin.framebuffer = framebuffer(pass);
+            renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, pass.extent };
+            renderpassBegin.clearValueCount = clearValues.size();
+            renderpassBegin.pClearValues = clearValues.data();
+
+            vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+            pass.execute(cmd);
+            vkCmdEndRenderPass(cmd);
+        }
+
+        // leave the imported images in the layout their owner expects, e.g. PRESENT_SRC for the swapchain
+        recordBarriers(cmd, m_finalBarriers);
+    }
+
+    bool culled(Pass pass) const { return m_passes[pass].culled; }
+    VkRenderPass renderpass(Pass pass) const { return m_passes[pass].renderpass; }
+    VkExtent2D extent(Pass pass) const { return m_passes[pass].extent; }
+    VkImageView view(Resource resource) const { return m_resources[resource].view; }
+
+private:
+    struct Access
+    {
+        Resource resource;
+        Usage usage;
+        bool read, write;
+    };
+
+    struct Attachment
+    {
+        Resource resource;
+        Usage usage;
+        VkAttachmentLoadOp loadOp;
+        VkAttachmentStoreOp storeOp;
+        VkClearValue clearValue;
+    };
+
+    struct Barrier
+    {
+        Resource resource;
+        VkImageLayout oldLayout, newLayout;
+        VkAccessFlags srcAccess, dstAccess;
+    };
+
+    struct Barriers
+    {
+        VkPipelineStageFlags srcStages = 0, dstStages = 0;
+        std::vector<Barrier> barriers;
+    };
+
+    struct PassData
+    {
+        const char* name;
+        bool graphics;
+        bool culled;
+        std::function<void(VkCommandBuffer)> execute;
+        std::vector<Access> accesses;
+        std::vector<Attachment> attachments;
+        Barriers barriers;
+        VkRenderPass renderpass;
+        VkExtent2D extent;
+    };
+
+    struct ResourceData
+    {
+        const char* name;
+        bool imported, output;
+
+        VkFormat format;
+        VkExtent2D extent;
+        VkImageUsageFlags usage;
+        VkImageLayout finalLayout;
+        VkImage image;
+        VkImageView view;
+        VkBuffer buffer;
+
+        // first and last (non culled) pass that uses the resource
+        int32_t firstPass, lastPass;
+        uint32_t memorySlot;
+    };
+
+    // the stage, access and layout a usage maps to
+    struct UsageInfo
+    {
+        VkPipelineStageFlags stage;
+        VkAccessFlags access;
+        VkImageLayout layout;
+    };
+
+    static UsageInfo usageInfo(Usage usage, bool write)
+    {
+        VkAccessFlags shaderAccess = write ? VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+        switch (usage)
+        {
+        case Usage::ColorAttachment:
+            return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        case Usage::DepthAttachment:
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+        case Usage::DepthAttachmentRead:
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+        case Usage::SampledFragment:
+            return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case Usage::SampledCompute:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case Usage::StorageCompute:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, shaderAccess, VK_IMAGE_LAYOUT_GENERAL };
+        case Usage::StorageVertex:
+            return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, shaderAccess, VK_IMAGE_LAYOUT_GENERAL };
+        case Usage::IndirectRead:
+            return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+        case Usage::TransferWrite:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+        }
+
+        return {};
+    }
+
+    static VkImageUsageFlags imageUsage(Usage usage)
+    {
+        switch (usage)
+        {
+        case Usage::ColorAttachment: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        case Usage::DepthAttachment:
+        case Usage::DepthAttachmentRead: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        case Usage::SampledFragment:
+        case Usage::SampledCompute: return VK_IMAGE_USAGE_SAMPLED_BIT;
+        case Usage::StorageCompute:
+        case Usage::StorageVertex: return VK_IMAGE_USAGE_STORAGE_BIT;
+        case Usage::TransferWrite: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        default: return 0;
+        }
+    }
+
+    static bool isDepthFormat(VkFormat format)
+    {
+        return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 || format == VK_FORMAT_D32_SFLOAT
+            || format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+    }
+
+    void addAccess(Pass pass, Resource resource, Usage usage, bool read, bool write)
+    {
+        m_passes[pass].accesses.push_back(Access { resource, usage, read, write });
+        m_resources[resource].usage |= imageUsage(usage);
+    }
+
+    void addAttachment(Pass pass, Resource resource, Usage usage, VkAttachmentLoadOp loadOp, VkClearValue clearValue)
+    {
+        // loading an attachment reads its previous contents, a read only depth attachment is only ever read
+        bool read = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+        bool write = usage != Usage::DepthAttachmentRead;
+        addAccess(pass, resource, usage, read, write);
+
+        m_passes[pass].attachments.push_back(Attachment { resource, usage, loadOp, VK_ATTACHMENT_STORE_OP_STORE, clearValue });
+    }
+
+    // walk the passes back to front: a pass is needed if it writes something that is needed,
+    // and everything a needed pass reads becomes needed in turn. the frame's outputs are the imported images.
+    void cull()
+    {
+        std::vector<bool> needed(m_resources.size(), false);
+        for (size_t i = 0; i < m_resources.size(); i++)
+            needed[i] = m_resources[i].output;
+
+        for (size_t p = m_passes.size(); p-- > 0;)
+        {
+            PassData& pass = m_passes[p];
+            pass.culled = true;
+            for (const Access& access : pass.accesses)
+                if (access.write && needed[access.resource])
+                    pass.culled = false;
+
+            if (pass.culled)
+                continue;
+
+            for (const Access& access : pass.accesses)
+                if (access.read)
+                    needed[access.resource] = true;
+        }
+    }
+
+    void computeLifetimes()
+    {
+        for (ResourceData& resource : m_resources)
+        {
+            resource.firstPass = -1;
+            resource.lastPass = -1;
+        }
+
+        for (size_t p = 0; p < m_passes.size(); p++)
+        {
+            if (m_passes[p].culled)
+                continue;
+
+            for (const Access& access : m_passes[p].accesses)
+            {
+                ResourceData& resource = m_resources[access.resource];
+                if (resource.firstPass == -1)
+                    resource.firstPass = static_cast<int32_t>(p);
+                resource.lastPass = static_cast<int32_t>(p);
+            }
+        }
+    }
+
+    // every transient image gets a memory slot. images whose lifetimes don't overlap can share a slot,
+    // the slot is as large as the largest image in it. images are placed from large to small so big images share first.
+    void allocateImages()
+    {
+        struct Slot
+        {
+            VkDeviceSize size = 0;
+            uint32_t memoryTypeBits = ~0u;
+            std::vector<Resource> images;
+        };
+        std::vector<Slot> slots;
+        std::vector<VkMemoryRequirements> requirements(m_resources.size());
+        std::vector<Resource> images;
+
+        for (size_t i = 0; i < m_resources.size(); i++)
+        {
+            ResourceData& resource = m_resources[i];
+            if (resource.imported || resource.firstPass == -1)
+                continue;
+
+            VkImageCreateInfo imageInfo {};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.pNext = nullptr;
+            imageInfo.flags = 0;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = resource.format;
+            imageInfo.extent = VkExtent3D { resource.extent.width, resource.extent.height, 1 };
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = resource.usage;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.queueFamilyIndexCount = 0;
+            imageInfo.pQueueFamilyIndices = nullptr;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            THROW_IF_FAILED(vkCreateImage(m_device, &imageInfo, nullptr, &resource.image));
+            vkGetImageMemoryRequirements(m_device, resource.image, &requirements[i]);
+            images.push_back(static_cast<Resource>(i));
+        }
+
+        std::sort(images.begin(), images.end(), [&](Resource a, Resource b) { return requirements[a].size > requirements[b].size; });
+
+        VkDeviceSize unaliasedSize = 0;
+        for (Resource image : images)
+        {
+            const ResourceData& resource = m_resources[image];
+            unaliasedSize += requirements[image].size;
+
+            // find a slot where every image's lifetime is disjoint from this one, and that shares a memory type
+            uint32_t slotIndex = static_cast<uint32_t>(slots.size());
+            for (uint32_t s = 0; s < slots.size() && slotIndex == slots.size(); s++)
+            {
+                if ((slots[s].memoryTypeBits & requirements[image].memoryTypeBits) == 0)
+                    continue;
+
+                bool overlaps = false;
+                for (Resource other : slots[s].images)
+                    if (resource.firstPass <= m_resources[other].lastPass && m_resources[other].firstPass <= resource.lastPass)
+                        overlaps = true;
+
+                if (!overlaps)
+                    slotIndex = s;
+            }
+
+            if (slotIndex == slots.size())
+                slots.push_back(Slot {});
+
+            Slot& slot = slots[slotIndex];
+            slot.size = std::max(slot.size, requirements[image].size);
+            slot.memoryTypeBits &= requirements[image].memoryTypeBits;
+            slot.images.push_back(image);
+            m_resources[image].memorySlot = slotIndex;
+        }
+
+        // every slot is one allocation, all of its images are bound at offset 0
+        m_aliasedSize = 0;
+        for (Slot& slot : slots)
+        {
+            VkMemoryRequirements slotRequirements {};
+            slotRequirements.size = slot.size;
+            slotRequirements.memoryTypeBits = slot.memoryTypeBits;
+
+            VkMemoryAllocateInfo allocInfo {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.pNext = nullptr;
+            allocInfo.allocationSize = slot.size;
+            allocInfo.memoryTypeIndex = Memory::select(m_physicalDevice, slotRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            VkDeviceMemory memory;
+            THROW_IF_FAILED(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory));
+            m_memory.push_back(memory);
+            m_aliasedSize += slot.size;
+
+            for (Resource image : slot.images)
+                THROW_IF_FAILED(vkBindImageMemory(m_device, m_resources[image].image, memory, 0));
+        }
+        m_unaliasedSize = unaliasedSize;
+
+        for (Resource image : images)
+        {
+            ResourceData& resource = m_resources[image];
+
+            VkImageViewCreateInfo viewInfo {};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.pNext = nullptr;
+            viewInfo.flags = 0;
+            viewInfo.image = resource.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = resource.format;
+            viewInfo.components = VkComponentMapping { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+            viewInfo.subresourceRange = VkImageSubresourceRange { static_cast<VkImageAspectFlags>(isDepthFormat(resource.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT), 0, 1, 0, 1 };
+
+            THROW_IF_FAILED(vkCreateImageView(m_device, &viewInfo, nullptr, &resource.view));
+        }
+    }
+
+    // simulate a frame and track what every resource went through so far:
+    // the last write (which later accesses have to wait on and make visible) and the reads since then (which a later write has to wait on).
+    // an access only needs a barrier if it isn't covered yet, reads of the same data in the same stage share one barrier.
+    void computeBarriers()
+    {
+        struct State
+        {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags writeStages = 0;
+            VkAccessFlags writeAccess = 0;
+            VkPipelineStageFlags readStages = 0;
+            VkAccessFlags readAccess = 0;
+        };
+        std::vector<State> states(m_resources.size());
+
+        // imported images are waited on at the color attachment output stage by the acquire semaphore,
+        // the first barrier has to start from that stage for the semaphore wait to cover the layout transition
+        for (size_t i = 0; i < m_resources.size(); i++)
+            if (m_resources[i].imported && m_resources[i].buffer == VK_NULL_HANDLE)
+                states[i].writeStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+        // aliased images start out where the previous image in their memory left off, so they wait for it to finish
+        // and make its writes available, otherwise they could land after the new image's first write to the same memory
+        std::vector<VkPipelineStageFlags> slotStages(m_memory.size(), 0);
+        std::vector<VkAccessFlags> slotAccess(m_memory.size(), 0);
+
+        for (size_t p = 0; p < m_passes.size(); p++)
+        {
+            PassData& pass = m_passes[p];
+            if (pass.culled)
+                continue;
+
+            Barriers& barriers = pass.barriers;
+            for (const Access& access : pass.accesses)
+            {
+                ResourceData& resource = m_resources[access.resource];
+                State& state = states[access.resource];
+                UsageInfo info = usageInfo(access.usage, access.write);
+                bool image = resource.buffer == VK_NULL_HANDLE;
+                VkImageLayout layout = image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+                // the first use of a transient image in the frame discards its contents, which is what the UNDEFINED layout says
+                if (image && !resource.imported && static_cast<int32_t>(p) == resource.firstPass)
+                {
+                    state = State {};
+                    state.writeStages = slotStages[resource.memorySlot];
+                    state.writeAccess = slotAccess[resource.memorySlot];
+                }
+
+                bool layoutChange = image && state.layout != layout;
+                if (access.write)
+                {
+                    // write after write and write after read: wait for both, only the write has to be made available
+                    // a pass that reads and writes (a loaded attachment, an atomic counter) is covered by the same barrier
+                    VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+                    if (srcStages != 0 || layoutChange)
+                    {
+                        barriers.srcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                        barriers.dstStages |= info.stage;
+                        if (state.writeAccess != 0 || layoutChange)
+                            barriers.barriers.push_back(Barrier { access.resource, state.layout, layout, state.writeAccess, info.access });
+                    }
+
+                    state.writeStages = info.stage;
+                    state.writeAccess = info.access & (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+                    state.readStages = 0;
+                    state.readAccess = 0;
+                }
+                else
+                {
+                    // read after write: skip the barrier if there was no write this frame,
+                    // or an earlier read in the same stage already made the write visible
+                    bool covered = state.writeStages == 0 || ((state.readStages & info.stage) == info.stage && (state.readAccess & info.access) == info.access);
+                    if (!covered || layoutChange)
+                    {
+                        barriers.srcStages |= state.writeStages != 0 ? state.writeStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                        barriers.dstStages |= info.stage;
+                        barriers.barriers.push_back(Barrier { access.resource, state.layout, layout, state.writeAccess, info.access });
+                    }
+
+                    state.readStages |= info.stage;
+                    state.readAccess |= info.access;
+                }
+
+                state.layout = layout;
+            }
+
+            // now that every barrier of the pass is known, decide whether attachments have to be stored
+            // nothing after this pass reading the attachment (and the attachment not being an output) means DONT_CARE
+            for (Attachment& attachment : pass.attachments)
+            {
+                const ResourceData& resource = m_resources[attachment.resource];
+                bool usedLater = resource.output || resource.lastPass > static_cast<int32_t>(p);
+                attachment.storeOp = usedLater ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            }
+
+            for (const Access& access : pass.accesses)
+            {
+                const ResourceData& resource = m_resources[access.resource];
+                if (!resource.imported && resource.lastPass == static_cast<int32_t>(p))
+                {
+                    slotStages[resource.memorySlot] = states[access.resource].writeStages | states[access.resource].readStages;
+                    slotAccess[resource.memorySlot] = states[access.resource].writeAccess;
+                }
+            }
+        }
+
+        // transition the imported images to the layout their owner expects
+        for (size_t i = 0; i < m_resources.size(); i++)
+        {
+            const ResourceData& resource = m_resources[i];
+            if (!resource.imported || resource.buffer != VK_NULL_HANDLE || resource.firstPass == -1)
+                continue;
+
+            m_finalBarriers.srcStages |= states[i].writeStages | states[i].readStages;
+            m_finalBarriers.dstStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            m_finalBarriers.barriers.push_back(Barrier { static_cast<Resource>(i), states[i].layout, resource.finalLayout, states[i].writeAccess, 0 });
+        }
+    }
+
+    // graphics passes get a renderpass with a single subpass, their attachments are already in the right layout thanks to the barriers
+    void createRenderpasses()
+    {
+        for (PassData& pass : m_passes)
+        {
+            if (pass.culled || !pass.graphics)
+                continue;
+
+            std::vector<VkAttachmentDescription> attachments;
+            std::vector<VkAttachmentReference> colorRefs;
+            VkAttachmentReference depthRef { VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED };
+
+            for (const Attachment& attachment : pass.attachments)
+            {
+                const ResourceData& resource = m_resources[attachment.resource];
+                VkImageLayout layout = usageInfo(attachment.usage, true).layout;
+                pass.extent = resource.extent;
+
+                VkAttachmentDescription description {};
+                description.flags = 0;
+                description.format = resource.format;
+                description.samples = VK_SAMPLE_COUNT_1_BIT;
+                description.loadOp = attachment.loadOp;
+                description.storeOp = attachment.storeOp;
+                description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                description.initialLayout = layout;
+                description.finalLayout = layout;
+
+                VkAttachmentReference ref { static_cast<uint32_t>(attachments.size()), layout };
+                if (attachment.usage == Usage::ColorAttachment)
+                    colorRefs.push_back(ref);
+                else
+                    depthRef = ref;
+
+                attachments.push_back(description);
+            }
+
+            VkSubpassDescription subpass {};
+            subpass.flags = 0;
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass.inputAttachmentCount = 0;
+            subpass.pInputAttachments = nullptr;
+            subpass.colorAttachmentCount = colorRefs.size();
+            subpass.pColorAttachments = colorRefs.data();
+            subpass.pResolveAttachments = nullptr;
+            subpass.pDepthStencilAttachment = depthRef.attachment != VK_ATTACHMENT_UNUSED ? &depthRef : nullptr;
+            subpass.preserveAttachmentCount = 0;
+            subpass.pPreserveAttachments = nullptr;
+
+            // no subpass dependencies, all synchronization happens through the graph's barriers outside of the renderpass
+            VkRenderPassCreateInfo renderpassInfo {};
+            renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            renderpassInfo.pNext = nullptr;
+            renderpassInfo.flags = 0;
+            renderpassInfo.attachmentCount = attachments.size();
+            renderpassInfo.pAttachments = attachments.data();
+            renderpassInfo.subpassCount = 1;
+            renderpassInfo.pSubpasses = &subpass;
+            renderpassInfo.dependencyCount = 0;
+            renderpassInfo.pDependencies = nullptr;
+
+            THROW_IF_FAILED(vkCreateRenderPass(m_device, &renderpassInfo, nullptr, &pass.renderpass));
+        }
+    }
+
+    // framebuffers are created on first use, imported images give a different framebuffer for every swapchain image
+    VkFramebuffer framebuffer(const PassData& pass)
+    {
+        std::vector<VkImageView> views;
+        for (const Attachment& attachment : pass.attachments)
+            views.push_back(m_resources[attachment.resource].view);
+
+        auto key = std::make_pair(pass.renderpass, views);
+        auto it = m_framebuffers.find(key);
+        if (it != m_framebuffers.end())
+            return it->second;
+
+        VkFramebufferCreateInfo framebufferInfo {};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.pNext = nullptr;
+        framebufferInfo.flags = 0;
+        framebufferInfo.renderPass = pass.renderpass;
+        framebufferInfo.attachmentCount = views.size();
+        framebufferInfo.pAttachments = views.data();
+        framebufferInfo.width = pass.extent.width;
+        framebufferInfo.height = pass.extent.height;
+        framebufferInfo.layers = 1;
+
+        VkFramebuffer framebuffer;
+        THROW_IF_FAILED(vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &framebuffer));
+        m_framebuffers[key] = framebuffer;
+        return framebuffer;
+    }
+
+    // all barriers of a pass go into one call, buffers only need an access mask and images also get their layout transition
+    void recordBarriers(VkCommandBuffer cmd, const Barriers& barriers)
+    {
+        if (barriers.srcStages == 0)
+            return;
+
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+        for (const Barrier& barrier : barriers.barriers)
+        {
+            const ResourceData& resource = m_resources[barrier.resource];
+            if (resource.buffer != VK_NULL_HANDLE)
+            {
+                VkBufferMemoryBarrier bufferBarrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+                bufferBarrier.srcAccessMask = barrier.srcAccess;
+                bufferBarrier.dstAccessMask = barrier.dstAccess;
+                bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                bufferBarrier.buffer = resource.buffer;
+                bufferBarrier.offset = 0;
+                bufferBarrier.size = VK_WHOLE_SIZE;
+                bufferBarriers.push_back(bufferBarrier);
+                continue;
+            }
+
+            VkImageMemoryBarrier imageBarrier { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+            imageBarrier.srcAccessMask = barrier.srcAccess;
+            imageBarrier.dstAccessMask = barrier.dstAccess;
+            imageBarrier.oldLayout = barrier.oldLayout;
+            imageBarrier.newLayout = barrier.newLayout;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = resource.image;
+            imageBarrier.subresourceRange = VkImageSubresourceRange { static_cast<VkImageAspectFlags>(isDepthFormat(resource.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT), 0, 1, 0, 1 };
+            imageBarriers.push_back(imageBarrier);
+        }
+
+        vkCmdPipelineBarrier(cmd, barriers.srcStages, barriers.dstStages, 0, 0, nullptr, bufferBarriers.size(), bufferBarriers.data(), imageBarriers.size(), imageBarriers.data());
+    }
+
+    void printSummary()
+    {
+        for (const PassData& pass : m_passes)
+        {
+            if (pass.culled)
+            {
+                printf("Pass %s: culled\n", pass.name);
+                continue;
+            }
+
+            printf("Pass %s: %zu barriers", pass.name, pass.barriers.barriers.size());
+            for (const Attachment& attachment : pass.attachments)
+                printf(", %s %s", m_resources[attachment.resource].name, attachment.storeOp == VK_ATTACHMENT_STORE_OP_STORE ? "stored" : "discarded");
+            printf("\n");
+        }
+
+        for (const ResourceData& resource : m_resources)
+            if (!resource.imported && resource.firstPass != -1)
+                printf("Image %s: passes %d-%d, memory slot %u\n", resource.name, resource.firstPass, resource.lastPass, resource.memorySlot);
+
+        printf("Transient image memory: %llu KB aliased into %llu KB\n", static_cast<unsigned long long>(m_unaliasedSize / 1024), static_cast<unsigned long long>(m_aliasedSize / 1024));
+    }
+
+    VkDevice m_device;
+    VkPhysicalDevice m_physicalDevice;
+
+    std::vector<PassData> m_passes;
+    std::vector<ResourceData> m_resources;
+    std::vector<VkDeviceMemory> m_memory;
+    std::map<std::pair<VkRenderPass, std::vector<VkImageView>>, VkFramebuffer> m_framebuffers;
+    Barriers m_finalBarriers;
+
+    VkDeviceSize m_unaliasedSize = 0;
+    VkDeviceSize m_aliasedSize = 0;
+};
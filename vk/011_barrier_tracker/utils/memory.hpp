@@ -0,0 +1,51 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+class Memory
+{
+public:
+    static uint32_t select(VkPhysicalDevice physicalDevice, VkMemoryRequirements memoryReqs, VkMemoryPropertyFlags flags)
+    {
+        int32_t index = find(physicalDevice, memoryReqs, flags);
+        assert(index != -1);
+        return index;
+    }
+    
+    // same as select(), but returns -1 instead of asserting when no memory type has the given properties
+    // this allows falling back to other properties for memory that is optional, such as lazily allocated memory
+    static int32_t find(VkPhysicalDevice physicalDevice, VkMemoryRequirements memoryReqs, VkMemoryPropertyFlags flags)
+    {
+        // Before we start allocating memory, we should first query the physical device's memory properties.
+        // when allocating memory, we must select a compatible memory type
+        // our buffer will have a certain set of requirements, and we may have requirements or desires ourselves too
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        
+        // using the given memory requirements and the previously acquired physical device memory properties
+        // we can select a memory type index that is appropriate for our buffer's memory
+        int32_t index = -1;
+        for (size_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        {
+            auto memoryType = memoryProperties.memoryTypes[i];
+            
+            // we'll select a host-coherent/visible type here
+            // being host (cpu) visible is not ideal for buffers and textures -
+            // ideally we create a separate buffer that is device_local and
+            // then we do a gpu-gpu copy to the said buffer
+            
+            if ((memoryType.propertyFlags & flags) != flags)
+                continue;
+            
+            // the memory requirements must also match with the memory we're selecting
+            // memoryTypeBits has a bit set for every memory type index that the resource can be bound to
+            // types are ordered by preference, so we keep the first match
+            if ((memoryReqs.memoryTypeBits & (1u << i)) != 0)
+            {
+                index = i;
+                break;
+            }
+        }
+        
+        return index;
+    }
+};
@@ -0,0 +1,294 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <queue>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include "math.hpp"
+
+// mesh simplification through quadric error metric edge collapses (Garland & Heckbert)
+// every vertex accumulates the planes of the triangles around it as a "quadric",
+// which measures the squared distance of a point to all of those planes.
+// the edge that introduces the least error is collapsed first, until the target triangle count is reached.
+// vertices are only ever collapsed onto other existing vertices, so the simplified indices
+// keep referencing the original vertex buffer and every level of detail can share it.
+class Simplifier
+{
+public:
+    // simplify the mesh down to (at most) targetIndexCount indices, or as close as possible without flipping triangles
+    // positions are read from vertexData with the given stride in bytes
+    // outError receives the largest error introduced by a collapse, as a distance in the mesh's units
+    static std::vector<uint32_t> simplify(const void* vertexData, uint32_t vertexCount, uint32_t vertexStride, const std::vector<uint32_t>& indices, size_t targetIndexCount, float* outError)
+    {
+        Simplifier s;
+        s.load(vertexData, vertexCount, vertexStride, indices);
+        s.collapseUntil(targetIndexCount / 3);
+
+        if (outError)
+            *outError = sqrtf(s.m_maxError);
+
+        return s.result();
+    }
+
+private:
+    // symmetric 4x4 matrix, stored as its upper triangle
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+        double a11 = 0, a12 = 0, a13 = 0;
+        double a22 = 0, a23 = 0;
+        double a33 = 0;
+
+        static Quadric fromPlane(double a, double b, double c, double d, double weight)
+        {
+            Quadric q;
+            q.a00 = a * a * weight; q.a01 = a * b * weight; q.a02 = a * c * weight; q.a03 = a * d * weight;
+            q.a11 = b * b * weight; q.a12 = b * c * weight; q.a13 = b * d * weight;
+            q.a22 = c * c * weight; q.a23 = c * d * weight;
+            q.a33 = d * d * weight;
+            return q;
+        }
+
+        void operator+=(const Quadric& o)
+        {
+            a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+            a11 += o.a11; a12 += o.a12; a13 += o.a13;
+            a22 += o.a22; a23 += o.a23;
+            a33 += o.a33;
+        }
+
+        // v^T * Q * v with v = (p, 1)
+        double error(const vec3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double result = x * x * a00 + 2 * x * y * a01 + 2 * x * z * a02 + 2 * x * a03
+                          + y * y * a11 + 2 * y * z * a12 + 2 * y * a13
+                          + z * z * a22 + 2 * z * a23
+                          + a33;
+            return result > 0 ? result : 0;
+        }
+    };
+
+    struct Collapse
+    {
+        double error;
+        uint32_t from, to;
+        uint32_t fromVersion, toVersion;
+
+        bool operator>(const Collapse& o) const { return error > o.error; }
+    };
+
+    std::vector<vec3> m_positions;
+    std::vector<uint32_t> m_remap; // original vertex -> welded vertex
+    std::vector<uint32_t> m_triangles; // welded indices, 3 per triangle
+    std::vector<bool> m_triangleRemoved;
+    std::vector<std::vector<uint32_t>> m_vertexTriangles;
+    std::vector<Quadric> m_quadrics;
+    std::vector<uint32_t> m_versions;
+    std::vector<bool> m_vertexRemoved;
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_queue;
+    size_t m_triangleCount = 0;
+    float m_maxError = 0;
+
+    void load(const void* vertexData, uint32_t vertexCount, uint32_t vertexStride, const std::vector<uint32_t>& indices)
+    {
+        // weld vertices that share a position (uv seams, sphere poles) so the mesh is connected
+        // otherwise collapses along a seam would tear the mesh apart
+        struct PositionHash
+        {
+            size_t operator()(const std::array<float, 3>& p) const { return std::hash<float>()(p[0]) ^ (std::hash<float>()(p[1]) * 31) ^ (std::hash<float>()(p[2]) * 131); }
+        };
+        std::unordered_map<std::array<float, 3>, uint32_t, PositionHash> unique;
+
+        m_remap.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            const float* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertexData) + static_cast<size_t>(i) * vertexStride);
+            auto it = unique.emplace(std::array<float, 3> { p[0], p[1], p[2] }, i).first;
+            m_remap[i] = it->second;
+        }
+
+        m_positions.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            const float* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertexData) + static_cast<size_t>(i) * vertexStride);
+            m_positions[i] = vec3 { p[0], p[1], p[2] };
+        }
+
+        m_vertexTriangles.resize(vertexCount);
+        m_quadrics.resize(vertexCount);
+        m_versions.resize(vertexCount, 0);
+        m_vertexRemoved.resize(vertexCount, false);
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            uint32_t a = m_remap[indices[i + 0]], b = m_remap[indices[i + 1]], c = m_remap[indices[i + 2]];
+            if (a == b || b == c || a == c)
+                continue; // already degenerate after welding
+
+            uint32_t t = static_cast<uint32_t>(m_triangles.size() / 3);
+            m_triangles.insert(m_triangles.end(), { a, b, c });
+            m_vertexTriangles[a].push_back(t);
+            m_vertexTriangles[b].push_back(t);
+            m_vertexTriangles[c].push_back(t);
+
+            // every vertex of the triangle gets the triangle's plane
+            vec3 n = cross(m_positions[b] - m_positions[a], m_positions[c] - m_positions[a]);
+            float area = length(n);
+            if (area == 0)
+                continue;
+
+            n = n * (1.0f / area);
+            Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -dot(n, m_positions[a]), 1);
+            m_quadrics[a] += q;
+            m_quadrics[b] += q;
+            m_quadrics[c] += q;
+        }
+
+        m_triangleCount = m_triangles.size() / 3;
+        m_triangleRemoved.resize(m_triangleCount, false);
+
+        // edges that belong to a single triangle are on the mesh's border
+        // add a heavily weighted plane perpendicular to the triangle through them, so the border keeps its shape
+        std::unordered_map<uint64_t, uint32_t> edgeCounts;
+        auto edgeKey = [](uint32_t a, uint32_t b) { return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a; };
+        for (size_t t = 0; t < m_triangleCount; t++)
+            for (uint32_t e = 0; e < 3; e++)
+                edgeCounts[edgeKey(m_triangles[t * 3 + e], m_triangles[t * 3 + (e + 1) % 3])]++;
+
+        for (size_t t = 0; t < m_triangleCount; t++)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                uint32_t a = m_triangles[t * 3 + e], b = m_triangles[t * 3 + (e + 1) % 3], c = m_triangles[t * 3 + (e + 2) % 3];
+                if (edgeCounts[edgeKey(a, b)] != 1)
+                    continue;
+
+                vec3 edge = m_positions[b] - m_positions[a];
+                vec3 normal = cross(edge, m_positions[c] - m_positions[a]);
+                vec3 side = normalize(cross(edge, normal));
+                if (length(side) == 0)
+                    continue;
+
+                Quadric q = Quadric::fromPlane(side.x, side.y, side.z, -dot(side, m_positions[a]), 100);
+                m_quadrics[a] += q;
+                m_quadrics[b] += q;
+            }
+        }
+
+        // queue up every edge, each edge is seen from both of its triangles but the second one is discarded as stale later
+        for (size_t t = 0; t < m_triangleCount; t++)
+            for (uint32_t e = 0; e < 3; e++)
+                push(m_triangles[t * 3 + e], m_triangles[t * 3 + (e + 1) % 3]);
+    }
+
+    // queue the cheapest direction of collapsing the edge a-b
+    void push(uint32_t a, uint32_t b)
+    {
+        Quadric q = m_quadrics[a];
+        q += m_quadrics[b];
+
+        double errorA = q.error(m_positions[a]); // error of keeping a, so collapsing b into a
+        double errorB = q.error(m_positions[b]);
+
+        if (errorA <= errorB)
+            m_queue.push(Collapse { errorA, b, a, m_versions[b], m_versions[a] });
+        else
+            m_queue.push(Collapse { errorB, a, b, m_versions[a], m_versions[b] });
+    }
+
+    // returns false if moving "from" onto "to" would flip (or collapse) any of from's remaining triangles
+    bool valid(uint32_t from, uint32_t to) const
+    {
+        for (uint32_t t : m_vertexTriangles[from])
+        {
+            if (m_triangleRemoved[t])
+                continue;
+
+            const uint32_t* tri = &m_triangles[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue; // this triangle disappears with the collapse
+
+            vec3 before[3], after[3];
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                before[i] = m_positions[tri[i]];
+                after[i] = tri[i] == from ? m_positions[to] : before[i];
+            }
+
+            vec3 n0 = normalize(cross(before[1] - before[0], before[2] - before[0]));
+            vec3 n1 = normalize(cross(after[1] - after[0], after[2] - after[0]));
+            if (dot(n0, n1) < 0.25f)
+                return false;
+        }
+
+        return true;
+    }
+
+    void collapseUntil(size_t targetTriangleCount)
+    {
+        while (m_triangleCount > targetTriangleCount && !m_queue.empty())
+        {
+            Collapse c = m_queue.top();
+            m_queue.pop();
+
+            // skip edges whose vertices changed after they were queued, an up to date entry was queued at that point
+            if (m_vertexRemoved[c.from] || m_vertexRemoved[c.to] || m_versions[c.from] != c.fromVersion || m_versions[c.to] != c.toVersion)
+                continue;
+
+            if (!valid(c.from, c.to))
+                continue;
+
+            m_maxError = std::max(m_maxError, static_cast<float>(c.error));
+
+            // move all of from's triangles over to "to", and remove the ones that became degenerate
+            for (uint32_t t : m_vertexTriangles[c.from])
+            {
+                if (m_triangleRemoved[t])
+                    continue;
+
+                uint32_t* tri = &m_triangles[t * 3];
+                if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+                {
+                    m_triangleRemoved[t] = true;
+                    m_triangleCount--;
+                    continue;
+                }
+
+                for (uint32_t i = 0; i < 3; i++)
+                    if (tri[i] == c.from)
+                        tri[i] = c.to;
+
+                m_vertexTriangles[c.to].push_back(t);
+            }
+
+            m_vertexRemoved[c.from] = true;
+            m_quadrics[c.to] += m_quadrics[c.from];
+            m_versions[c.to]++;
+
+            // "to" changed, so requeue all of its edges with their new cost
+            for (uint32_t t : m_vertexTriangles[c.to])
+            {
+                if (m_triangleRemoved[t])
+                    continue;
+
+                for (uint32_t i = 0; i < 3; i++)
+                    if (m_triangles[t * 3 + i] != c.to)
+                        push(c.to, m_triangles[t * 3 + i]);
+            }
+        }
+    }
+
+    std::vector<uint32_t> result() const
+    {
+        std::vector<uint32_t> indices;
+        indices.reserve(m_triangleCount * 3);
+
+        for (size_t t = 0; t < m_triangleRemoved.size(); t++)
+            if (!m_triangleRemoved[t])
+                indices.insert(indices.end(), { m_triangles[t * 3 + 0], m_triangles[t * 3 + 1], m_triangles[t * 3 + 2] });
+
+        return indices;
+    }
+};
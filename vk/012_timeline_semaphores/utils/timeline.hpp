@@ -0,0 +1,154 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include "preprocessor.hpp"
+
+#ifndef VK_KHR_timeline_semaphore
+#error "timeline semaphores need Vulkan headers 1.1.97 or newer"
+#endif
+
+// a queue together with a timeline semaphore (VK_KHR_timeline_semaphore)
+// a timeline semaphore holds a 64 bit counter instead of a signaled/unsignaled state, and the counter only ever goes up.
+// every submit signals the next value of the timeline, so a value identifies a submit for the rest of the application:
+// - the CPU can poll (finished) or block on (wait) any value that was handed out, no fences needed
+// - other queues wait on a value through waitFor(), which is how work on different queues is ordered
+// - waiting for the last submitted value replaces vkQueueWaitIdle, and only ever waits for this one queue
+// the swapchain doesn't accept timeline semaphores, so submits can also wait on and signal binary semaphores.
+class Timeline
+{
+public:
+    // a semaphore a submit waits on before the given stages, value is ignored for binary semaphores
+    struct Wait
+    {
+        VkSemaphore semaphore;
+        uint64_t value;
+        VkPipelineStageFlags stages;
+    };
+
+    Timeline(VkDevice device, VkQueue queue) : m_device(device), m_queue(queue)
+    {
+        // the semaphore type is chained into the regular create info, a timeline starts at 0 so value 1 is the first submit
+        VkSemaphoreTypeCreateInfoKHR typeInfo {};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        typeInfo.pNext = nullptr;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+        semaphoreInfo.flags = 0;
+        THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_semaphore));
+
+        // extension functions aren't exported by the loader, so we have to look them up ourselves
+        m_getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+        m_waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+        if (!m_getSemaphoreCounterValue || !m_waitSemaphores)
+            throw std::runtime_error("VK_KHR_timeline_semaphore wasn't enabled on the device");
+    }
+
+    ~Timeline()
+    {
+        vkDestroySemaphore(m_device, m_semaphore, nullptr);
+    }
+
+    Timeline(const Timeline&) = delete;
+    Timeline& operator=(const Timeline&) = delete;
+
+    // submit command buffers after the given waits, returns the value that's reached once they've all finished
+    // a submit without command buffers is allowed, it simply passes its waits on to the next value
+    uint64_t submit(const std::vector<VkCommandBuffer>& commandBuffers, const std::vector<Wait>& waits = {}, const std::vector<VkSemaphore>& binarySignals = {})
+    {
+        uint64_t value = m_submitted + 1;
+
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        for (const Wait& wait : waits)
+        {
+            waitSemaphores.push_back(wait.semaphore);
+            waitValues.push_back(wait.value);
+            waitStages.push_back(wait.stages);
+        }
+
+        // our own timeline comes first, binary semaphores get a value as well but it's ignored
+        std::vector<VkSemaphore> signalSemaphores { m_semaphore };
+        std::vector<uint64_t> signalValues { value };
+        for (VkSemaphore semaphore : binarySignals)
+        {
+            signalSemaphores.push_back(semaphore);
+            signalValues.push_back(0);
+        }
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo {};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.pNext = nullptr;
+        timelineInfo.waitSemaphoreValueCount = waitValues.size();
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = signalValues.size();
+        timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+        VkSubmitInfo submit {};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = &timelineInfo;
+        submit.waitSemaphoreCount = waitSemaphores.size();
+        submit.pWaitSemaphores = waitSemaphores.data();
+        submit.pWaitDstStageMask = waitStages.data();
+        submit.commandBufferCount = commandBuffers.size();
+        submit.pCommandBuffers = commandBuffers.data();
+        submit.signalSemaphoreCount = signalSemaphores.size();
+        submit.pSignalSemaphores = signalSemaphores.data();
+        THROW_IF_FAILED(vkQueueSubmit(m_queue, 1, &submit, VK_NULL_HANDLE));
+
+        m_submitted = value;
+        return value;
+    }
+
+    // lets a submit on another queue wait for this timeline to reach value before the given stages
+    Wait waitFor(uint64_t value, VkPipelineStageFlags stages) const { return Wait { m_semaphore, value, stages }; }
+
+    // the value of the last submit, and the last value the GPU finished
+    uint64_t submitted() const { return m_submitted; }
+
+    uint64_t completed() const
+    {
+        uint64_t value;
+        THROW_IF_FAILED(m_getSemaphoreCounterValue(m_device, m_semaphore, &value));
+        return value;
+    }
+
+    // poll without blocking
+    bool finished(uint64_t value) const { return completed() >= value; }
+
+    // block until the GPU reached value, returns straight away for values that are already done (like 0)
+    void wait(uint64_t value) const
+    {
+        if (finished(value))
+            return;
+
+        VkSemaphoreWaitInfoKHR waitInfo {};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.pNext = nullptr;
+        waitInfo.flags = 0;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_semaphore;
+        waitInfo.pValues = &value;
+        THROW_IF_FAILED(m_waitSemaphores(m_device, &waitInfo, UINT64_MAX));
+    }
+
+    // everything submitted to this queue so far, the queue's own vkQueueWaitIdle
+    void waitIdle() const { wait(m_submitted); }
+
+    VkQueue queue() const { return m_queue; }
+
+private:
+    VkDevice m_device;
+    VkQueue m_queue;
+    VkSemaphore m_semaphore;
+    uint64_t m_submitted = 0;
+
+    PFN_vkGetSemaphoreCounterValueKHR m_getSemaphoreCounterValue;
+    PFN_vkWaitSemaphoresKHR m_waitSemaphores;
+};
@@ -0,0 +1,18 @@
+#version 450
+
+layout(location = 0) in vec2 inUv;
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D scene;
+layout(set = 0, binding = 1) uniform sampler2D bloom; // the scene itself when bloom is disabled, with a strength of 0
+
+layout(push_constant) uniform Constants {
+    vec2 texelSize;
+    float bloomStrength;
+} constants;
+
+// adds the blurred highlights on top of the scene and maps the result back into the 0-1 range of the swapchain
+void main() {
+    vec3 color = texture(scene, inUv).rgb + texture(bloom, inUv).rgb * constants.bloomStrength;
+    outColor = vec4(color / (1.0 + color * 0.25), 1.0);
+}
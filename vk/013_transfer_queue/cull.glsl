@@ -0,0 +1,92 @@
+#version 450
+
+// one invocation per object: objects outside of the view frustum are culled,
+// visible objects pick their level of detail from the projected error of each level
+// and append an indirect draw command for that level's index range
+layout(local_size_x = 64) in;
+
+// matches LodLevel in utils/lod.hpp, firstIndex already includes the mesh's offset in the geometry pool
+struct LodLevel {
+    uint firstIndex;
+    uint indexCount;
+    float error;
+    uint padding;
+};
+
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(set = 0, binding = 0) uniform View {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint objectCount;
+    uint lodCount;
+    int vertexOffset;
+    float projectionScale; // viewport height / (2 * tan(fovY / 2))
+    float pixelThreshold;
+    float radius; // bounding sphere radius of the mesh
+    uint compact; // 0 if every object keeps its own draw command, for devices without VK_KHR_draw_indirect_count
+    uint finestLod; // the most detailed level that's resident, finer levels are still being uploaded
+} view;
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects { vec4 objects[]; }; // center.xyz, scale
+layout(std430, set = 0, binding = 2) readonly buffer Lods { LodLevel lods[]; };
+layout(std430, set = 0, binding = 3) writeonly buffer DrawCommands { DrawCommand draws[]; };
+layout(std430, set = 0, binding = 4) buffer DrawCount { uint drawCount; };
+layout(std430, set = 0, binding = 5) writeonly buffer ObjectLods { uint objectLods[]; }; // ~0u for culled objects
+
+// the same function as selectLod() in utils/lod.hpp, starting at the finest resident level
+uint selectLod(vec3 center, float radius, float scale) {
+    float distance = max(length(center - view.cameraPosition.xyz) - radius, 0.001);
+    
+    uint lod = view.finestLod;
+    for (uint i = lod + 1; i < view.lodCount; i++) {
+        float projectedError = lods[i].error * scale * view.projectionScale / distance;
+        if (projectedError > view.pixelThreshold)
+            break;
+        
+        lod = i;
+    }
+    
+    return lod;
+}
+
+void main() {
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= view.objectCount)
+        return;
+    
+    vec4 object = objects[objectIndex];
+    float radius = view.radius * object.w;
+    
+    bool visible = true;
+    for (int i = 0; i < 6; i++) {
+        if (dot(view.frustum[i].xyz, object.xyz) + view.frustum[i].w < -radius)
+            visible = false;
+    }
+    
+    uint lod = visible ? selectLod(object.xyz, radius, object.w) : 0;
+    objectLods[objectIndex] = visible ? lod : ~0u;
+    
+    // the object index goes into firstInstance, so the vertex shader can find the object through gl_InstanceIndex
+    DrawCommand draw;
+    draw.indexCount = lods[lod].indexCount;
+    draw.instanceCount = visible ? 1 : 0;
+    draw.firstIndex = lods[lod].firstIndex;
+    draw.vertexOffset = view.vertexOffset;
+    draw.firstInstance = objectIndex;
+    
+    if (view.compact != 0) {
+        // only visible objects get a draw command, the draw count is read by vkCmdDrawIndexedIndirectCountKHR
+        if (visible)
+            draws[atomicAdd(drawCount, 1)] = draw;
+    } else {
+        // without a GPU draw count, culled objects become draws with 0 instances
+        draws[objectIndex] = draw;
+    }
+}
@@ -0,0 +1,1532 @@
+// this sample streams its geometry into device local memory on a dedicated transfer queue, while rendering carries on
+// the mesh lives in a device local geometry pool instead of host visible memory, the data gets there through utils/uploader.hpp:
+// - the uploader copies data into a staging ring and submits the copies to a transfer-only queue family, which on most
+//   discrete GPUs is backed by copy engines that run alongside the graphics queue instead of taking time away from it
+// - every frame only submits a limited number of bytes (--upload-budget, in KB), so no frame has to wait for a large upload
+// - finished copies are found by polling the transfer queue's timeline, the graphics submit waits on that timeline value
+// - with separate families, every range is released by the transfer queue and acquired by the graphics queue
+//   (queue family ownership transfers), exclusive buffers are faster than concurrent ones but belong to one family at a time
+// the vertices go first, then the levels of detail from coarsest to finest. objects never select a level that hasn't
+// arrived yet, so the spheres show up at their coarsest level and sharpen as the finer levels become resident.
+// devices without a transfer-only family upload on the graphics queue, with regular barriers and no ownership transfers.
+
+// see lines
+// * utils/uploader.hpp for the staging ring, the transfer submits and the ownership transfers
+// * utils/queue_families.hpp for finding a transfer-only family
+// * 148-151,948-959 Creating a queue on the transfer family
+// * 204-239 Reserving the mesh in a device local pool and queueing its uploads
+// * 626-640 Acquiring finished uploads and finding the finest resident level
+// * 737-741 Submitting a frame, waiting on the transfer timeline
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/physical_device.hpp"
+#include "utils/swapchain.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/geometry_pool.hpp"
+#include "utils/depth_buffer.hpp"
+#include "utils/barrier_tracker.hpp"
+#include "utils/render_graph.hpp"
+#include "utils/timeline.hpp"
+#include "utils/uploader.hpp"
+#include "utils/math.hpp"
+#include "utils/lod.hpp"
+
+// matches the View uniform block in cull.glsl
+struct ViewData
+{
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint32_t objectCount;
+    uint32_t lodCount;
+    int32_t vertexOffset;
+    float projectionScale;
+    float pixelThreshold;
+    float radius;
+    uint32_t compact;
+    uint32_t finestLod;
+};
+
+// matches the push constants of the post process shaders
+struct PostConstants
+{
+    float texelSize[2];
+    float bloomStrength;
+};
+
+VkInstance createInstance();
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window);
+bool synchronization2Supported(VkPhysicalDevice physicalDevice);
+bool timelineSemaphoresSupported(VkPhysicalDevice physicalDevice);
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, int32_t transferFamily, const VkPhysicalDeviceFeatures& features, bool drawIndirectCount, bool synchronization2);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device);
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout);
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, uint32_t subpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader, VkCompareOp depthCompareOp, bool depthWrite);
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShader);
+VkDescriptorSetLayout createPostDescriptorSetLayout(VkDevice device);
+VkPipelineLayout createPostPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout);
+VkPipeline createFullscreenPipeline(VkDevice device, VkRenderPass renderpass, VkExtent2D extent, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+VkSampler createSampler(VkDevice device);
+void createSphere(uint32_t rings, uint32_t segments, std::vector<float>& vertices, std::vector<uint32_t>& indices);
+
+int main(int argc, char** argv) {
+    // default GLFW window creation except we disable OpenGL context creation
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 800, "013_transfer_queue", nullptr, nullptr);
+    
+    VkInstance instance = createInstance();
+    VkSurfaceKHR surface = createSurface(instance, window);
+    
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice = PhysicalDevice::select(instance, surface, &families);
+    
+    // the GPU path passes the object index through firstInstance, which indirect draws only support with drawIndirectFirstInstance
+    // without VK_KHR_draw_indirect_count the GPU can't tell us how many draws it wrote, so every object keeps a draw command
+    // and culled objects get 0 instances. drawing all of those at once needs multiDrawIndirect.
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+    
+    VkPhysicalDeviceFeatures features {};
+    features.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    features.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    
+    bool drawIndirectCount = false;
+#ifdef VK_KHR_draw_indirect_count
+    drawIndirectCount = Extensions { physicalDevice }.available("VK_KHR_draw_indirect_count");
+#endif
+
+    bool gpuLod = features.drawIndirectFirstInstance;
+    bool depthPrepass = false;
+    bool bloom = true;
+    bool synchronization2 = synchronization2Supported(physicalDevice);
+    uint32_t framesInFlight = 2;
+    uint32_t uploadBudget = 64;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--cpu-lod") == 0)
+            gpuLod = false;
+        if (strcmp(argv[i], "--depth-prepass") == 0)
+            depthPrepass = true;
+        if (strcmp(argv[i], "--no-bloom") == 0)
+            bloom = false;
+        if (strcmp(argv[i], "--no-sync2") == 0)
+            synchronization2 = false;
+        if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+            framesInFlight = std::max(1, std::min(3, atoi(argv[++i])));
+        if (strcmp(argv[i], "--upload-budget") == 0 && i + 1 < argc)
+            uploadBudget = std::max(1, atoi(argv[++i]));
+    }
+    printf("Selecting levels of detail on the %s, %s depth prepass, %s bloom\n", gpuLod ? "GPU" : "CPU", depthPrepass ? "with" : "without", bloom ? "with" : "without");
+    printf("Recording barriers with %s\n", synchronization2 ? "vkCmdPipelineBarrier2KHR" : "vkCmdPipelineBarrier");
+    printf("Rendering with %u frames in flight\n", framesInFlight);
+    printf("Uploading %u KB per frame on %s\n", uploadBudget, families.transfer != -1 ? "a dedicated transfer queue" : "the graphics queue");
+    
+    // the whole sample is built around timeline semaphores, there's no fallback to fences
+    if (!timelineSemaphoresSupported(physicalDevice))
+        throw std::runtime_error("VK_KHR_timeline_semaphore is not supported");
+    
+    VkDevice device = createDevice(instance, physicalDevice, families.graphics, families.present, families.transfer, features, drawIndirectCount, synchronization2);
+    VkQueue graphicsQueue; vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+    VkQueue presentQueue; vkGetDeviceQueue(device, families.present, 0, &presentQueue);
+    
+    // without a transfer-only family the uploads go through the graphics queue
+    VkQueue transferQueue = graphicsQueue;
+    if (families.transfer != -1)
+        vkGetDeviceQueue(device, families.transfer, 0, &transferQueue);
+    
+    // every submit to the graphics queue gets the next value on its timeline
+    std::unique_ptr<Timeline> timeline = std::make_unique<Timeline>(device, graphicsQueue);
+    
+    // a command buffer per frame in flight, a frame's command buffer can only be recorded again once the GPU is done with it
+    VkCommandPool commandPool = createCommandPool(device, families.graphics);
+    std::vector<VkCommandBuffer> commandBuffers(framesInFlight);
+    for (VkCommandBuffer& commandBuffer : commandBuffers)
+        commandBuffer = allocateCommandBuffer(device, commandPool);
+    
+    Swapchain swap = Swapchain::create(device, physicalDevice, surface, families.graphics, families.present);
+    auto swapchainImages = swap.getImages(device);
+    auto swapchainImageViews = swap.getImageViews(device);
+    
+    // the swapchain only works with binary semaphores
+    // imageWaitSemaphores: Make a frame's command buffer wait on vkAcquireNextImageKHR to be finished, one per frame in flight
+    // presentWaitSemaphores: Make vkQueuePresentKHR wait on our commands to be done rendering. a binary semaphore can only be
+    // signaled again once its wait is done, and the image's next present is the only thing that's guaranteed to be after it
+    VkSemaphoreCreateInfo semaphoreInfo { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0 };
+    std::vector<VkSemaphore> imageWaitSemaphores(framesInFlight), presentWaitSemaphores(swapchainImages.size());
+    for (VkSemaphore& semaphore : imageWaitSemaphores)
+        THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+    for (VkSemaphore& semaphore : presentWaitSemaphores)
+        THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+    
+    VkDescriptorSetLayout setLayout = createDescriptorSetLayout(device);
+    VkPipelineLayout pipelineLayout = createPipelineLayout(device, setLayout);
+    VkDescriptorSetLayout postSetLayout = createPostDescriptorSetLayout(device);
+    VkPipelineLayout postPipelineLayout = createPostPipelineLayout(device, postSetLayout);
+    
+    VkShaderModule vertexShader = Shader::load(device, "../013_transfer_queue/vertex.spv");
+    VkShaderModule fragmentShader = Shader::load(device, "../013_transfer_queue/fragment.spv");
+    VkShaderModule depthVertexShader = Shader::load(device, "../013_transfer_queue/depth_vertex.spv");
+    VkShaderModule cullShader = Shader::load(device, "../013_transfer_queue/cull.spv");
+    VkShaderModule fullscreenShader = Shader::load(device, "../013_transfer_queue/fullscreen.spv");
+    VkShaderModule downsampleShader = Shader::load(device, "../013_transfer_queue/downsample.spv");
+    VkShaderModule blurShader = Shader::load(device, "../013_transfer_queue/blur.spv");
+    VkShaderModule compositeShader = Shader::load(device, "../013_transfer_queue/composite.spv");
+    VkPipeline cullPipeline = createComputePipeline(device, pipelineLayout, cullShader);
+    VkSampler sampler = createSampler(device);
+    
+    // vertex: { float3 pos, float3 normal }
+    // a finely tessellated unit sphere, far more detail than most objects need at their size on screen
+    // dense enough that its upload takes a good number of frames at the default budget
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    createSphere(128, 256, vertices, indices);
+    uint32_t vertexCount = vertices.size() / 6;
+    
+    LodChain lodChain = LodChain::build(vertices.data(), vertexCount, sizeof(float) * 6, indices);
+    for (size_t i = 0; i < lodChain.levels.size(); i++)
+        printf("LOD %zu: %u triangles, error %f\n", i, lodChain.levels[i].indexCount / 3, lodChain.levels[i].error);
+    
+    // the whole chain is one mesh in the pool, every level is a range within the mesh's indices
+    // the pool is device local, so the mesh's ranges are only reserved here and filled in by the uploader
+    std::unique_ptr<GeometryPool> geometry = std::make_unique<GeometryPool>(device, physicalDevice, families, sizeof(float) * 6, sizeof(float) * vertices.size(), sizeof(uint32_t) * lodChain.indices.size(), true);
+    Mesh mesh = geometry->reserve(vertexCount, lodChain.indices.size());
+    
+    // the GPU draws straight from the pool's index buffer, so the levels need the mesh's offset into it
+    std::vector<LodLevel> lods = lodChain.levels;
+    for (LodLevel& lod : lods)
+        lod.firstIndex += mesh.firstIndex;
+    uint32_t lodCount = lods.size();
+    
+    // add() narrows the indices while it copies them, uploaded indices have to be in the mesh's index type already
+    // the uploader reads from these vectors until every upload is done, so they live as long as the render loop
+    std::vector<uint16_t> indices16(lodChain.indices.begin(), lodChain.indices.end());
+    const void* indexData = mesh.indexType == VK_INDEX_TYPE_UINT16 ? static_cast<const void*>(indices16.data()) : lodChain.indices.data();
+    VkDeviceSize indexSize = GeometryPool::indexTypeSize(mesh.indexType);
+    
+    // the staging ring holds a few frames worth of uploads, so the transfer queue can lag behind a little without stalling them
+    VkDeviceSize frameBudget = static_cast<VkDeviceSize>(uploadBudget) * 1024;
+    std::unique_ptr<Uploader> uploader = std::make_unique<Uploader>(device, physicalDevice, families, transferQueue, frameBudget * 4, frameBudget);
+    
+    // the vertices go first since every level needs them, then the levels from coarsest to finest
+    // uploads finish in the order they're queued, so once a level is resident all coarser levels are as well
+    Uploader::Ticket vertexTicket = uploader->upload(geometry->vertexBuffer(), geometry->vertexByteOffset(mesh), vertices.data(), sizeof(float) * vertices.size(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+    std::vector<Uploader::Ticket> lodTickets(lodCount);
+    for (uint32_t i = lodCount; i-- > 0;)
+    {
+        const LodLevel& level = lodChain.levels[i];
+        const uint8_t* data = static_cast<const uint8_t*>(indexData) + level.firstIndex * indexSize;
+        lodTickets[i] = uploader->upload(geometry->indexBuffer(), geometry->indexByteOffset(mesh) + level.firstIndex * indexSize, data, level.indexCount * indexSize, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
+    }
+    
+    VkDeviceSize totalUploadBytes = sizeof(float) * vertices.size();
+    for (const LodLevel& level : lodChain.levels)
+        totalUploadBytes += level.indexCount * indexSize;
+    
+    // a grid of objects spread out over view rays from the camera, at varying distances
+    // the grid is a bit wider than the field of view so the outer objects get frustum culled as the camera turns
+    // objects are a lot larger than their spacing, so up close they cover many of their neighbours
+    const uint32_t gridSize = 24;
+    const uint32_t objectCount = gridSize * gridSize;
+    const float angularSpacing = 0.06f;
+    const float nearestDistance = 3.0f;
+    const float objectScale = nearestDistance * tanf(angularSpacing * 0.5f) * 4.0f;
+    const float sphereRadius = 1.0f;
+    
+    // object data is rewritten every frame, so it's host visible
+    // objectLods is written by whichever side selects the levels, the vertex shader colors every object by its level
+    // the CPU writes (and reads) these while the GPU may still be rendering the previous frame, so every frame in flight gets its own
+    struct FrameBuffers
+    {
+        std::unique_ptr<Buffer> objectBuffer, objectLodBuffer, viewBuffer;
+        vec4* objects;
+        uint32_t* objectLods;
+        ViewData* viewData;
+    };
+    std::vector<FrameBuffers> frameBuffers(framesInFlight);
+    for (FrameBuffers& buffers : frameBuffers)
+    {
+        buffers.objectBuffer = Buffer::create(device, physicalDevice, families, sizeof(vec4) * objectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        buffers.objectLodBuffer = Buffer::create(device, physicalDevice, families, sizeof(uint32_t) * objectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        buffers.viewBuffer = Buffer::create(device, physicalDevice, families, sizeof(ViewData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        buffers.objects = reinterpret_cast<vec4*>(buffers.objectBuffer->map());
+        buffers.objectLods = reinterpret_cast<uint32_t*>(buffers.objectLodBuffer->map());
+        buffers.viewData = reinterpret_cast<ViewData*>(buffers.viewBuffer->map());
+    }
+    std::unique_ptr<Buffer> lodBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(LodLevel) * lodCount, lods.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    
+    // the culling shader writes one draw command per visible object, and counts them in the draw count buffer
+    std::unique_ptr<Buffer> drawCommandBuffer = Buffer::create(device, physicalDevice, families, sizeof(VkDrawIndexedIndirectCommand) * objectCount, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    std::unique_ptr<Buffer> drawCountBuffer = Buffer::create(device, physicalDevice, families, sizeof(uint32_t), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    
+    // extension functions aren't exported by the loader, so we have to look them up ourselves
+    PFN_vkVoidFunction cmdDrawIndexedIndirectCount = nullptr;
+    if (drawIndirectCount)
+        cmdDrawIndexedIndirectCount = vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+    
+    // the culling and vertex shaders access their buffers through a descriptor set per frame in flight, the post process passes sample their inputs through 3 more
+    // descriptor sets are allocated from a descriptor pool, which must be large enough for all of the sets' bindings
+    std::array<VkDescriptorPoolSize, 3> poolSizes {
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, framesInFlight },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * framesInFlight },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6 }
+    };
+    
+    VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext = nullptr;
+    descriptorPoolInfo.flags = 0;
+    descriptorPoolInfo.maxSets = 3 + framesInFlight;
+    descriptorPoolInfo.poolSizeCount = poolSizes.size();
+    descriptorPoolInfo.pPoolSizes = poolSizes.data();
+    
+    VkDescriptorPool descriptorPool;
+    THROW_IF_FAILED(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool));
+    
+    VkDescriptorSetAllocateInfo setAllocInfo {};
+    setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setAllocInfo.pNext = nullptr;
+    setAllocInfo.descriptorPool = descriptorPool;
+    setAllocInfo.descriptorSetCount = 1;
+    setAllocInfo.pSetLayouts = &setLayout;
+    
+    std::vector<VkDescriptorSet> descriptorSets(framesInFlight);
+    for (uint32_t f = 0; f < framesInFlight; f++)
+    {
+        THROW_IF_FAILED(vkAllocateDescriptorSets(device, &setAllocInfo, &descriptorSets[f]));
+    
+        // point every binding in the set at its buffer, the binding numbers match the shaders
+        std::array<VkDescriptorBufferInfo, 6> bufferInfos {
+            VkDescriptorBufferInfo { frameBuffers[f].viewBuffer->buffer, 0, VK_WHOLE_SIZE },
+            VkDescriptorBufferInfo { frameBuffers[f].objectBuffer->buffer, 0, VK_WHOLE_SIZE },
+            VkDescriptorBufferInfo { lodBuffer->buffer, 0, VK_WHOLE_SIZE },
+            VkDescriptorBufferInfo { drawCommandBuffer->buffer, 0, VK_WHOLE_SIZE },
+            VkDescriptorBufferInfo { drawCountBuffer->buffer, 0, VK_WHOLE_SIZE },
+            VkDescriptorBufferInfo { frameBuffers[f].objectLodBuffer->buffer, 0, VK_WHOLE_SIZE }
+        };
+    
+        std::vector<VkWriteDescriptorSet> writes(bufferInfos.size());
+        for (uint32_t i = 0; i < bufferInfos.size(); i++)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].pNext = nullptr;
+            writes[i].dstSet = descriptorSets[f];
+            writes[i].dstBinding = i;
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+    }
+    
+    // state the passes read while they're recorded, updated at the start of every frame
+    // slot is the frame in flight that's being recorded, which picks the per frame descriptor set and buffers
+    // finestLod is the most detailed level that's resident, lodCount while the vertices or the coarsest level are still on their way
+    uint32_t slot = 0;
+    uint32_t finestLod = lodCount;
+    mat4 viewProjection;
+    struct ObjectDraw { Mesh mesh; uint32_t object; float distance; };
+    std::vector<ObjectDraw> objectDraws;
+    
+    // pipelines depend on the renderpasses the graph creates, so they're only created after it's compiled
+    VkPipeline depthPipeline = VK_NULL_HANDLE, scenePipeline = VK_NULL_HANDLE;
+    VkPipeline downsamplePipeline = VK_NULL_HANDLE, blurPipeline = VK_NULL_HANDLE, compositePipeline = VK_NULL_HANDLE;
+    VkDescriptorSet downsampleSet = VK_NULL_HANDLE, blurSet = VK_NULL_HANDLE, compositeSet = VK_NULL_HANDLE;
+    
+    // the prepass and the scene draw exactly the same objects, only with a different pipeline
+    auto drawObjects = [&](VkCommandBuffer cmd, VkPipeline pipeline) {
+        // nothing to draw until the mesh has arrived, the passes still clear their attachments
+        if (finestLod == lodCount)
+            return;
+    
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[slot], 0, nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4), viewProjection.m);
+        geometry->bind(cmd);
+    
+        if (!gpuLod)
+        {
+            for (const ObjectDraw& draw : objectDraws)
+                geometry->draw(cmd, draw.mesh, 1, draw.object);
+            return;
+        }
+    
+        // the draw commands index the pool directly, so the index buffer is bound by hand here
+        vkCmdBindIndexBuffer(cmd, geometry->indexBuffer(), 0, mesh.indexType);
+    
+        if (drawIndirectCount)
+        {
+#ifdef VK_KHR_draw_indirect_count
+            // the number of draws comes from the GPU written count, capped at one draw per object
+            reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(cmdDrawIndexedIndirectCount)(cmd, drawCommandBuffer->buffer, 0, drawCountBuffer->buffer, 0, objectCount, sizeof(VkDrawIndexedIndirectCommand));
+#endif
+        }
+        else if (features.multiDrawIndirect)
+        {
+            // one draw command per object, culled objects have 0 instances
+            vkCmdDrawIndexedIndirect(cmd, drawCommandBuffer->buffer, 0, objectCount, sizeof(VkDrawIndexedIndirectCommand));
+        }
+        else
+        {
+            // without multiDrawIndirect every indirect draw can only read a single command
+            for (uint32_t i = 0; i < objectCount; i++)
+                vkCmdDrawIndexedIndirect(cmd, drawCommandBuffer->buffer, sizeof(VkDrawIndexedIndirectCommand) * i, 1, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    };
+    
+    // the post process passes all draw a single fullscreen triangle
+    auto drawFullscreen = [&](VkCommandBuffer cmd, VkPipeline pipeline, VkDescriptorSet set, VkExtent2D sourceExtent) {
+        PostConstants constants { { 1.0f / sourceExtent.width, 1.0f / sourceExtent.height }, bloom ? 0.6f : 0.0f };
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, postPipelineLayout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(cmd, postPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PostConstants), &constants);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+    };
+    
+    // describe the frame: the graph owns the transient images, the swapchain image and the buffers are imported
+    // the tracker remembers every resource's last access across frames, the graph tells it about every access a pass makes
+    BarrierTracker tracker { device, synchronization2 };
+    std::unique_ptr<RenderGraph> graph = std::make_unique<RenderGraph>(device, physicalDevice, tracker);
+    VkExtent2D halfExtent { swap.extent.width / 2, swap.extent.height / 2 };
+    
+    RenderGraph::Resource backbuffer = graph->importImage("backbuffer", swap.format, swap.extent, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    RenderGraph::Resource drawCommands = graph->importBuffer("drawCommands", drawCommandBuffer->buffer);
+    RenderGraph::Resource drawCount = graph->importBuffer("drawCount", drawCountBuffer->buffer);
+    RenderGraph::Resource selectedLods = graph->importBuffer("objectLods", frameBuffers[0].objectLodBuffer->buffer);
+    RenderGraph::Resource depth = graph->createImage("depth", DepthBuffer::selectFormat(physicalDevice), swap.extent);
+    RenderGraph::Resource sceneColor = graph->createImage("sceneColor", VK_FORMAT_R16G16B16A16_SFLOAT, swap.extent);
+    RenderGraph::Resource bright = graph->createImage("bright", VK_FORMAT_R16G16B16A16_SFLOAT, halfExtent);
+    RenderGraph::Resource blurred = graph->createImage("blurred", VK_FORMAT_R16G16B16A16_SFLOAT, halfExtent);
+    
+    if (gpuLod)
+    {
+        // reset the draw count, the culling shader appends to it
+        graph->addPass("reset", false, [&](RenderGraph::PassBuilder& pass) {
+            pass.write(drawCount, RenderGraph::Usage::TransferWrite);
+        }, [&](VkCommandBuffer cmd) {
+            vkCmdFillBuffer(cmd, drawCountBuffer->buffer, 0, sizeof(uint32_t), 0);
+        });
+    
+        // one invocation per object writes a draw command for every visible object
+        graph->addPass("cull", false, [&](RenderGraph::PassBuilder& pass) {
+            pass.readWrite(drawCount, RenderGraph::Usage::StorageCompute);
+            pass.write(drawCommands, RenderGraph::Usage::StorageCompute);
+            pass.write(selectedLods, RenderGraph::Usage::StorageCompute);
+        }, [&](VkCommandBuffer cmd) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[slot], 0, nullptr);
+            vkCmdDispatch(cmd, (objectCount + 63) / 64, 1, 1);
+        });
+    }
+    
+    // the draws read the commands and the count, the vertex shader reads the selected levels
+    auto readDraws = [&](RenderGraph::PassBuilder& pass) {
+        if (!gpuLod)
+            return;
+    
+        pass.read(drawCommands, RenderGraph::Usage::IndirectRead);
+        pass.read(drawCount, RenderGraph::Usage::IndirectRead);
+        pass.read(selectedLods, RenderGraph::Usage::StorageVertex);
+    };
+    
+    RenderGraph::Pass prepassPass = 0;
+    if (depthPrepass)
+    {
+        prepassPass = graph->addPass("prepass", true, [&](RenderGraph::PassBuilder& pass) {
+            readDraws(pass);
+            pass.depth(depth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+        }, [&](VkCommandBuffer cmd) {
+            drawObjects(cmd, depthPipeline);
+        });
+    }
+    
+    // with a prepass the scene only tests against its depth, without one it renders depth itself
+    RenderGraph::Pass scenePass = graph->addPass("scene", true, [&](RenderGraph::PassBuilder& pass) {
+        readDraws(pass);
+        pass.color(sceneColor, VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearColorValue { { 0, 0, 0, 1 } });
+        if (depthPrepass)
+            pass.depthReadOnly(depth);
+        else
+            pass.depth(depth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [&](VkCommandBuffer cmd) {
+        drawObjects(cmd, scenePipeline);
+    });
+    
+    // the bright parts of the scene at half resolution, which are then blurred
+    // both passes are always added, but when the composite doesn't read the result the graph culls them
+    RenderGraph::Pass downsamplePass = graph->addPass("downsample", true, [&](RenderGraph::PassBuilder& pass) {
+        pass.read(sceneColor, RenderGraph::Usage::SampledFragment);
+        pass.color(bright, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    }, [&](VkCommandBuffer cmd) {
+        drawFullscreen(cmd, downsamplePipeline, downsampleSet, swap.extent);
+    });
+    
+    RenderGraph::Pass blurPass = graph->addPass("blur", true, [&](RenderGraph::PassBuilder& pass) {
+        pass.read(bright, RenderGraph::Usage::SampledFragment);
+        pass.color(blurred, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    }, [&](VkCommandBuffer cmd) {
+        drawFullscreen(cmd, blurPipeline, blurSet, halfExtent);
+    });
+    
+    // the fullscreen triangle covers every pixel, so the swapchain image doesn't have to be cleared
+    RenderGraph::Pass compositePass = graph->addPass("composite", true, [&](RenderGraph::PassBuilder& pass) {
+        pass.read(sceneColor, RenderGraph::Usage::SampledFragment);
+        if (bloom)
+            pass.read(blurred, RenderGraph::Usage::SampledFragment);
+        pass.color(backbuffer, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    }, [&](VkCommandBuffer cmd) {
+        drawFullscreen(cmd, compositePipeline, compositeSet, swap.extent);
+    });
+    
+    graph->compile();
+    
+    // with a prepass, the prepass fills in the depth buffer
+    // and the scene only shades the fragments whose depth is exactly the closest one, without writing depth again
+    if (depthPrepass)
+    {
+        depthPipeline = createPipeline(device, swap, graph->renderpass(prepassPass), 0, pipelineLayout, depthVertexShader, VK_NULL_HANDLE, VK_COMPARE_OP_LESS, true);
+        scenePipeline = createPipeline(device, swap, graph->renderpass(scenePass), 0, pipelineLayout, vertexShader, fragmentShader, VK_COMPARE_OP_EQUAL, false);
+    }
+    else
+    {
+        scenePipeline = createPipeline(device, swap, graph->renderpass(scenePass), 0, pipelineLayout, vertexShader, fragmentShader, VK_COMPARE_OP_LESS, true);
+    }
+    
+    // culled passes have no renderpass (and their images don't exist), so they get no pipeline or descriptor set either
+    auto createPostPass = [&](RenderGraph::Pass pass, VkShaderModule shader, VkImageView source0, VkImageView source1, VkPipeline* pipeline, VkDescriptorSet* set) {
+        if (graph->culled(pass))
+            return;
+    
+        *pipeline = createFullscreenPipeline(device, graph->renderpass(pass), graph->extent(pass), postPipelineLayout, fullscreenShader, shader);
+    
+        setAllocInfo.pSetLayouts = &postSetLayout;
+        THROW_IF_FAILED(vkAllocateDescriptorSets(device, &setAllocInfo, set));
+    
+        std::array<VkDescriptorImageInfo, 2> imageInfos {
+            VkDescriptorImageInfo { sampler, source0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+            VkDescriptorImageInfo { sampler, source1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+        };
+    
+        std::array<VkWriteDescriptorSet, 2> imageWrites {};
+        for (uint32_t i = 0; i < imageWrites.size(); i++)
+        {
+            imageWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            imageWrites[i].pNext = nullptr;
+            imageWrites[i].dstSet = *set;
+            imageWrites[i].dstBinding = i;
+            imageWrites[i].dstArrayElement = 0;
+            imageWrites[i].descriptorCount = 1;
+            imageWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            imageWrites[i].pImageInfo = &imageInfos[i];
+        }
+        vkUpdateDescriptorSets(device, imageWrites.size(), imageWrites.data(), 0, nullptr);
+    };
+    
+    // every set has two bindings, passes that only use one point both at the same image
+    // without bloom the composite's second input is the scene itself, which it weighs by 0
+    VkImageView bloomView = bloom ? graph->view(blurred) : graph->view(sceneColor);
+    createPostPass(downsamplePass, downsampleShader, graph->view(sceneColor), graph->view(sceneColor), &downsamplePipeline, &downsampleSet);
+    createPostPass(blurPass, blurShader, graph->view(bright), graph->view(bright), &blurPipeline, &blurSet);
+    createPostPass(compositePass, compositeShader, graph->view(sceneColor), bloomView, &compositePipeline, &compositeSet);
+    
+    const float fovY = 1.0f;
+    const float pixelThreshold = 1.0f;
+    float t = 0;
+    uint32_t frame = 0;
+    
+    // the timeline value of the last submit that used every frame in flight's resources, 0 is reached from the start
+    std::vector<uint64_t> frameValues(framesInFlight, 0);
+    
+    // the frame whose LOD statistics are printed once the GPU is done with it, and how long the CPU was blocked
+    uint64_t reportValue = 0;
+    uint32_t reportSlot = 0;
+    double waitSeconds = 0;
+    
+    // the longest frame while the geometry was streaming in, the budget keeps it close to an ordinary frame
+    auto frameStart = std::chrono::steady_clock::now();
+    double longestStreamingFrame = 0;
+    bool streaming = true;
+    
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+    
+        auto now = std::chrono::steady_clock::now();
+        if (streaming && frame > 0)
+            longestStreamingFrame = std::max(longestStreamingFrame, std::chrono::duration<double>(now - frameStart).count());
+        frameStart = now;
+    
+        // the frame reuses the resources of the frame that was framesInFlight frames ago
+        // the CPU only blocks if that frame still hasn't finished, instead of waiting for the whole device every frame
+        slot = frame % framesInFlight;
+        auto waitStart = std::chrono::steady_clock::now();
+        timeline->wait(frameValues[slot]);
+        waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+    
+        // polling never blocks, and a frame's buffers are only reused after the wait above so they're still intact
+        if (reportValue != 0 && timeline->finished(reportValue))
+        {
+            const uint32_t* objectLods = frameBuffers[reportSlot].objectLods;
+            std::array<uint32_t, LodChain::maxLevels> histogram {};
+            uint32_t visibleObjects = 0;
+            size_t triangles = 0;
+            for (uint32_t i = 0; i < objectCount; i++)
+            {
+                // the culling shader doesn't write anything while the mesh isn't resident
+                if (objectLods[i] >= lodCount)
+                    continue;
+    
+                histogram[objectLods[i]]++;
+                visibleObjects++;
+                triangles += lods[objectLods[i]].indexCount / 3;
+            }
+    
+            printf("Frame %llu: visible objects: %u / %u, triangles: %zu (%zu without LOD), per level:", static_cast<unsigned long long>(reportValue), visibleObjects, objectCount, triangles, visibleObjects * indices.size() / 3);
+            for (uint32_t i = 0; i < lodCount; i++)
+                printf(" %u", histogram[i]);
+            printf("\n");
+            reportValue = 0;
+        }
+    
+        vec4* objects = frameBuffers[slot].objects;
+        uint32_t* objectLods = frameBuffers[slot].objectLods;
+        ViewData* viewData = frameBuffers[slot].viewData;
+        VkCommandBuffer cmd = commandBuffers[slot];
+    
+        // Acquire the next image to render to
+        // the frame might not immediately be ready (swapchain may stall for e.g. vsync)
+        // so we must wait with either a semaphore (GPU-GPU sync) or a fence (CPU-GPU sync)
+        uint32_t imageIndex;
+        vkAcquireNextImageKHR(device, swap.swapchain, UINT_MAX, imageWaitSemaphores[slot], /* fence */ nullptr, &imageIndex);
+    
+        // describe how we'll start recording the command buffer
+        // this is usually fairly simple for primary command buffers
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = 0;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(cmd, &beginInfo); // start recording
+    
+        // the uploader acquires the ranges that finished copying at the start of the command buffer, before the passes read them
+        // and submits the next part of the uploads. the waits it returns make this frame's submit wait for the acquired copies
+        std::vector<Timeline::Wait> uploadWaits = uploader->update(cmd);
+    
+        // levels only become resident from coarsest to finest, so the finest level is the lowest one that's ready
+        finestLod = lodCount;
+        if (uploader->ready(vertexTicket))
+            while (finestLod > 0 && uploader->ready(lodTickets[finestLod - 1]))
+                finestLod--;
+    
+        if (streaming && uploader->idle())
+        {
+            printf("All geometry resident after %u frames, longest frame while streaming: %.2f ms\n", frame, longestStreamingFrame * 1000.0);
+            streaming = false;
+        }
+    
+        // the camera sits at the origin and slowly turns left and right
+        t += 0.005f;
+        vec3 eye { 0, 0, 0 };
+        vec3 forward { sinf(t) * 0.3f, 0, -1 };
+        mat4 view = mat4::lookAt(eye, forward, vec3 { 0, 1, 0 });
+        mat4 projection = mat4::perspective(fovY, swap.extent.width / float(swap.extent.height), 0.05f, 500.0f);
+        viewProjection = projection * view;
+    
+        // converts a size at a distance of 1 into pixels on screen
+        float projectionScale = swap.extent.height / (2.0f * tanf(fovY * 0.5f));
+    
+        // every object moves back and forth along its own view ray, between nearestDistance and 30x as far
+        // the GPU is done with this frame's buffers (we waited for their last frame above) so we can write them directly
+        for (uint32_t y = 0; y < gridSize; y++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                float yaw = (x - (gridSize - 1) * 0.5f) * angularSpacing;
+                float pitch = (y - (gridSize - 1) * 0.5f) * angularSpacing;
+                vec3 direction = normalize(vec3 { tanf(yaw), tanf(pitch), -1 });
+                float distance = nearestDistance * (1 + 29 * (0.5f + 0.5f * sinf(t * 2 + x * 0.7f + y * 1.3f)));
+    
+                vec3 center = direction * distance;
+                objects[y * gridSize + x] = { center.x, center.y, center.z, objectScale };
+            }
+        }
+    
+        vec4 frustum[6];
+        frustumPlanes(viewProjection, frustum);
+    
+        // CPU path: the same culling and selection as cull.glsl, after which every visible object is drawn with its level's index range
+        objectDraws.clear();
+        if (!gpuLod)
+        {
+            for (uint32_t i = 0; i < objectCount; i++)
+            {
+                vec3 center { objects[i].x, objects[i].y, objects[i].z };
+                float radius = sphereRadius * objects[i].w;
+    
+                bool visible = true;
+                for (const vec4& plane : frustum)
+                    if (dot(vec3 { plane.x, plane.y, plane.z }, center) + plane.w < -radius)
+                        visible = false;
+    
+                if (!visible)
+                {
+                    objectLods[i] = ~0u;
+                    continue;
+                }
+    
+                // levels finer than the finest resident one don't exist as far as the selection is concerned
+                if (finestLod == lodCount)
+                {
+                    objectLods[i] = ~0u;
+                    continue;
+                }
+    
+                uint32_t lod = finestLod + selectLod(lods.data() + finestLod, lodCount - finestLod, center, radius, objects[i].w, eye, projectionScale, pixelThreshold);
+                objectLods[i] = lod;
+    
+                // the object's index goes into firstInstance, same as the GPU path, so both paths share the vertex shader
+                Mesh lodMesh = mesh;
+                lodMesh.firstIndex = lods[lod].firstIndex;
+                lodMesh.indexCount = lods[lod].indexCount;
+                objectDraws.push_back(ObjectDraw { lodMesh, i, length(center - eye) });
+            }
+    
+            // front to back, so the depth test rejects as many hidden fragments as possible before they're shaded
+            std::sort(objectDraws.begin(), objectDraws.end(), [](const ObjectDraw& a, const ObjectDraw& b) { return a.distance < b.distance; });
+        }
+    
+        if (gpuLod)
+        {
+            for (int i = 0; i < 6; i++)
+                viewData->frustum[i] = frustum[i];
+            viewData->cameraPosition = { eye.x, eye.y, eye.z, 1 };
+            viewData->objectCount = finestLod < lodCount ? objectCount : 0;
+            viewData->lodCount = lodCount;
+            viewData->vertexOffset = mesh.vertexOffset;
+            viewData->projectionScale = projectionScale;
+            viewData->pixelThreshold = pixelThreshold;
+            viewData->radius = sphereRadius;
+            viewData->compact = drawIndirectCount ? 1 : 0;
+            viewData->finestLod = finestLod;
+        }
+    
+        // the graph records every pass that wasn't culled, with the tracker's barriers in front of it
+        // and leaves the swapchain image in PRESENT_SRC at the end
+        graph->setImportedImage(backbuffer, swapchainImages[imageIndex], swapchainImageViews[imageIndex]);
+        graph->setImportedBuffer(selectedLods, frameBuffers[slot].objectLodBuffer->buffer);
+        graph->execute(cmd);
+    
+        vkEndCommandBuffer(cmd); // end recording
+    
+        // the tracker's first barrier on the swapchain image waits on the color attachment output stage,
+        // so that's the only stage that has to wait for the image to be acquired: culling can start right away
+        // the submit signals the next value on the timeline, and the present wait semaphore so present() can wait on it
+        // it also waits on the transfer timeline for the uploads acquired above, those copies are already done so it never stalls
+        uploadWaits.push_back(Timeline::Wait { imageWaitSemaphores[slot], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT });
+        frameValues[slot] = timeline->submit({ cmd }, uploadWaits, { presentWaitSemaphores[imageIndex] });
+    
+        // after we're done rendering, we'll present our image to the screen.
+        VkResult result;
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.pNext = nullptr;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &presentWaitSemaphores[imageIndex]; // present after waiting is done
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swap.swapchain;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = &result;
+        vkQueuePresentKHR(presentQueue, &presentInfo);
+    
+        // no waiting here, the next frame starts recording while this one renders
+        if ((++frame % 120) == 0)
+        {
+            reportValue = frameValues[slot];
+            reportSlot = slot;
+    
+            printf("Submitted value %llu, GPU finished value %llu, CPU waited %.2f ms per frame\n", static_cast<unsigned long long>(timeline->submitted()), static_cast<unsigned long long>(timeline->completed()), waitSeconds * 1000.0 / 120.0);
+            waitSeconds = 0;
+    
+            if (streaming)
+                printf("Uploaded %llu / %llu KB, finest resident level: %d\n", static_cast<unsigned long long>(uploader->bytesUploaded() / 1024), static_cast<unsigned long long>(totalUploadBytes / 1024), finestLod < lodCount ? static_cast<int>(finestLod) : -1);
+    
+            const BarrierTracker::Stats& stats = tracker.stats();
+            printf("Barriers per frame: %.1f calls, %.1f image barriers, %.1f buffer barriers\n", stats.calls / 120.0f, stats.imageBarriers / 120.0f, stats.bufferBarriers / 120.0f);
+            tracker.resetStats();
+        }
+    }
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    // we'll do so here at the end of the application
+    // note that these resources may still be in use by the application
+    // so it is recommended to call vkDeviceWaitIdle(device) prior to destroying them.
+    vkDeviceWaitIdle(device);
+    
+    // even though unique ptrs automatically destroy,
+    // this still has to happen before destruction of VkDevice
+    // so we'll do so manually here
+    graph.reset();
+    uploader.reset();
+    geometry.reset();
+    frameBuffers.clear();
+    lodBuffer.reset();
+    timeline.reset();
+    drawCommandBuffer.reset();
+    drawCountBuffer.reset();
+    
+    // destroying the pool frees the descriptor sets allocated from it
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroySampler(device, sampler, nullptr);
+    
+    vkDestroyPipeline(device, scenePipeline, nullptr);
+    vkDestroyPipeline(device, depthPipeline, nullptr);
+    vkDestroyPipeline(device, downsamplePipeline, nullptr);
+    vkDestroyPipeline(device, blurPipeline, nullptr);
+    vkDestroyPipeline(device, compositePipeline, nullptr);
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyPipelineLayout(device, postPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, postSetLayout, nullptr);
+    
+    vkDestroyShaderModule(device, vertexShader, nullptr);
+    vkDestroyShaderModule(device, fragmentShader, nullptr);
+    vkDestroyShaderModule(device, depthVertexShader, nullptr);
+    vkDestroyShaderModule(device, cullShader, nullptr);
+    vkDestroyShaderModule(device, fullscreenShader, nullptr);
+    vkDestroyShaderModule(device, downsampleShader, nullptr);
+    vkDestroyShaderModule(device, blurShader, nullptr);
+    vkDestroyShaderModule(device, compositeShader, nullptr);
+    
+    for (size_t i = 0; i < swapchainImages.size(); i++)
+        vkDestroyImageView(device, swapchainImageViews[i], nullptr);
+    
+    for (VkSemaphore semaphore : imageWaitSemaphores)
+        vkDestroySemaphore(device, semaphore, nullptr);
+    for (VkSemaphore semaphore : presentWaitSemaphores)
+        vkDestroySemaphore(device, semaphore, nullptr);
+    vkDestroySwapchainKHR(device, swap.swapchain, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+VkInstance createInstance()
+{
+    Extensions extensionHelper{};
+    extensionHelper.addRequiredGLFW();
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "013_transfer_queue";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    // vkGetPhysicalDeviceFeatures2 (to query synchronization2 and timeline semaphore support) is core in Vulkan 1.1
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 1, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    VkInstance instance;
+    THROW_IF_FAILED(vkCreateInstance(&instanceInfo, nullptr, &instance));
+    return instance;
+}
+
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window)
+{
+    // create a window surface using GLFW's helper function
+    VkSurfaceKHR surface;
+    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create VkSurfaceKHR from GLFW window");
+    
+    return surface;
+}
+
+bool synchronization2Supported(VkPhysicalDevice physicalDevice)
+{
+#ifdef VK_KHR_synchronization2
+    if (!Extensions { physicalDevice }.available("VK_KHR_synchronization2"))
+        return false;
+    
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features {};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    
+    VkPhysicalDeviceFeatures2 features {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &synchronization2Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+    
+    return synchronization2Features.synchronization2;
+#else
+    // VK_KHR_synchronization2 was added to the Vulkan headers in 1.2.170, older SDKs only get vkCmdPipelineBarrier
+    return false;
+#endif
+}
+
+bool timelineSemaphoresSupported(VkPhysicalDevice physicalDevice)
+{
+    if (!Extensions { physicalDevice }.available("VK_KHR_timeline_semaphore"))
+        return false;
+    
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    
+    VkPhysicalDeviceFeatures2 features {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &timelineFeatures;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+    
+    return timelineFeatures.timelineSemaphore;
+}
+
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, int32_t transferFamily, const VkPhysicalDeviceFeatures& features, bool drawIndirectCount, bool synchronization2)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 2> priorities = { 1, 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // we'll need at least a graphics queue
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    // only create a separate present queue if needed
+    if (graphicsFamily != presentFamily)
+    {
+        deviceQueues.push_back(VkDeviceQueueCreateInfo {
+            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            nullptr,        // pNext
+            0,              // flags (none)
+            static_cast<uint32_t>(presentFamily),
+            1,              // create one queue
+            priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+        });
+    }
+    
+    // and a queue on the transfer-only family, if there is one
+    // a transfer-only family can't do graphics, but in theory it could present, every family may only be listed once
+    if (transferFamily != -1 && transferFamily != presentFamily)
+    {
+        deviceQueues.push_back(VkDeviceQueueCreateInfo {
+            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            nullptr,        // pNext
+            0,              // flags (none)
+            static_cast<uint32_t>(transferFamily),
+            1,              // create one queue
+            priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+        });
+    }
+    
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_swapchain", true);
+    ext.add("VK_KHR_portability_subset");
+    
+    // draw_indirect_count lets the GPU decide how many indirect draws are executed
+    if (drawIndirectCount)
+        ext.add("VK_KHR_draw_indirect_count", true);
+    
+    // timeline semaphores are required, main() already checked they're supported
+    ext.add("VK_KHR_timeline_semaphore", true);
+    
+    // features are enabled by chaining their structures into the device create info
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineFeatures.pNext = nullptr;
+    timelineFeatures.timelineSemaphore = true;
+    const void* featureChain = &timelineFeatures;
+#ifdef VK_KHR_synchronization2
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features {};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    synchronization2Features.pNext = nullptr;
+    synchronization2Features.synchronization2 = true;
+    
+    if (synchronization2)
+    {
+        ext.add("VK_KHR_synchronization2", true);
+        timelineFeatures.pNext = &synchronization2Features;
+    }
+#endif
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = featureChain;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    deviceInfo.pEnabledFeatures = &features; // core features are enabled through VkPhysicalDeviceFeatures
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device)
+{
+    // a descriptor set layout describes the resources a shader can access through a descriptor set
+    // binding numbers match the "binding = x" declarations in the shaders
+    // all bindings are used by the culling compute shader, the vertex shader reads the objects (1) and their levels (5)
+    VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+    
+    std::array<VkDescriptorSetLayoutBinding, 6> bindings {};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = stages;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext = nullptr;
+    setLayoutInfo.flags = 0;
+    setLayoutInfo.bindingCount = bindings.size();
+    setLayoutInfo.pBindings = bindings.data();
+    
+    VkDescriptorSetLayout setLayout;
+    THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &setLayout));
+    
+    return setLayout;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout)
+{
+    // the view projection matrix is passed as a push constant
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(mat4);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // all pipelines in this sample share one layout: a single descriptor set plus the push constants
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, uint32_t subpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader, VkCompareOp depthCompareOp, bool depthWrite)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // describe our vertex and fragment shader (shader stage, entry point) for the pipeline
+    // a depth only pipeline has no fragment shader and no color output, it only reads positions from the vertex buffer
+    bool depthOnly = fragmentShader == VK_NULL_HANDLE;
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertexShader, "main", nullptr },
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, "main", nullptr }
+    };
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 normal)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 1;
+    pipelineVertexInput.pVertexBindingDescriptions = &vertexBinding;
+    pipelineVertexInput.vertexAttributeDescriptionCount = depthOnly ? 1 : vertexAttributes.size(); // position only
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = swap.extent.width;
+    viewport.height = swap.extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = swap.extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // the projection flips y, so counter clockwise triangles stay counter clockwise on screen
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // fragments that fail the depth test are discarded, as long as the fragment shader doesn't write depth
+    // (or discard) the test happens before the fragment shader runs
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = true;
+    pipelineDepthStencilState.depthWriteEnable = depthWrite;
+    pipelineDepthStencilState.depthCompareOp = depthCompareOp;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = depthOnly ? 0 : 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+    
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = subpass;
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = depthOnly ? 1 : shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShader)
+{
+    // compute pipelines are a lot simpler than graphics pipelines: a single shader stage and a layout
+    VkComputePipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.flags = 0;
+    pipelineInfo.stage = VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShader, "main", nullptr };
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateComputePipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+VkDescriptorSetLayout createPostDescriptorSetLayout(VkDevice device)
+{
+    // the post process passes sample (up to) two images, images are bound together with their sampler
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings {};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext = nullptr;
+    setLayoutInfo.flags = 0;
+    setLayoutInfo.bindingCount = bindings.size();
+    setLayoutInfo.pBindings = bindings.data();
+    
+    VkDescriptorSetLayout setLayout;
+    THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &setLayout));
+    
+    return setLayout;
+}
+
+VkPipelineLayout createPostPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout)
+{
+    // the source's texel size and the bloom strength are passed as push constants
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(PostConstants);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createFullscreenPipeline(VkDevice device, VkRenderPass renderpass, VkExtent2D extent, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
+    // a much simpler version of createPipeline: the fullscreen triangle has no vertex buffer,
+    // the post process passes have no depth attachment and there is nothing to cull
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertexShader, "main", nullptr },
+        VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, "main", nullptr }
+    };
+    
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 0;
+    pipelineVertexInput.pVertexBindingDescriptions = nullptr;
+    pipelineVertexInput.vertexAttributeDescriptionCount = 0;
+    pipelineVertexInput.pVertexAttributeDescriptions = nullptr;
+    
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the viewport covers the pass's own attachment, which is half the window's size for the bloom passes
+    VkViewport viewport;
+    viewport.width = extent.width;
+    viewport.height = extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_NONE;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = nullptr;
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = nullptr; // no depth attachment
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = nullptr;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+VkSampler createSampler(VkDevice device)
+{
+    // bilinear filtering, and clamping so the blur doesn't pull in the opposite edge of the screen
+    VkSamplerCreateInfo samplerInfo {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.pNext = nullptr;
+    samplerInfo.flags = 0;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.mipLodBias = 0;
+    samplerInfo.anisotropyEnable = false;
+    samplerInfo.maxAnisotropy = 1;
+    samplerInfo.compareEnable = false;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.minLod = 0;
+    samplerInfo.maxLod = 0;
+    samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+    samplerInfo.unnormalizedCoordinates = false;
+    
+    VkSampler sampler;
+    THROW_IF_FAILED(vkCreateSampler(device, &samplerInfo, nullptr, &sampler));
+    
+    return sampler;
+}
+
+void createSphere(uint32_t rings, uint32_t segments, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+    // a unit uv sphere, positions double as normals
+    vertices.clear();
+    indices.clear();
+    
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float theta = ring * 3.14159265f / rings;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float phi = segment * 2.0f * 3.14159265f / segments;
+            float x = sinf(theta) * cosf(phi), y = cosf(theta), z = sinf(theta) * sinf(phi);
+            vertices.insert(vertices.end(), { x, y, z, x, y, z });
+        }
+    }
+    
+    // two counter clockwise (seen from the outside) triangles per quad
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + 1;
+            uint32_t c = a + segments + 1;
+            uint32_t d = c + 1;
+            indices.insert(indices.end(), { a, b, c, b, d, c });
+        }
+    }
+}
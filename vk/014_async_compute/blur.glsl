@@ -0,0 +1,31 @@
+#version 450
+
+layout(location = 0) in vec2 inUv;
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+
+layout(push_constant) uniform Constants {
+    vec2 texelSize; // of the source image
+    float bloomStrength;
+} constants;
+
+// a single pass blur over a 7x7 area, bilinear taps between texels cover two texels each
+// a proper bloom would blur separably over several mip levels, one pass is enough to show the graph at work
+void main() {
+    const float weights[4] = float[](0.2, 0.16, 0.1, 0.04);
+    const float offsets[4] = float[](0.0, 1.5, 3.5, 5.5);
+
+    vec3 color = vec3(0.0);
+    float total = 0.0;
+    for (int y = -3; y <= 3; y++) {
+        for (int x = -3; x <= 3; x++) {
+            float weight = weights[abs(x)] * weights[abs(y)];
+            vec2 offset = vec2(sign(float(x)) * offsets[abs(x)], sign(float(y)) * offsets[abs(y)]) * constants.texelSize;
+            color += texture(source, inUv + offset).rgb * weight;
+            total += weight;
+        }
+    }
+
+    outColor = vec4(color / total, 1.0);
+}
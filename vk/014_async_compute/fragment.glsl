@@ -0,0 +1,14 @@
+#version 450
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec3 inColor;
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // simple directional light so the spheres' shape is visible, tinted by the object's level of detail
+    // the scene is rendered to a floating point target, so the highlight can go well above 1 and feed the bloom
+    vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.6));
+    float diffuse = max(dot(normalize(inNormal), lightDirection), 0.0);
+    float highlight = pow(diffuse, 40.0) * 4.0;
+    outColor = vec4(inColor * (0.15 + 0.85 * diffuse) + highlight, 1);
+}
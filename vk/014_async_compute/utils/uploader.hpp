@@ -0,0 +1,280 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include "preprocessor.hpp"
+#include "queue_families.hpp"
+#include "buffer.hpp"
+#include "timeline.hpp"
+
+// streams data into device local buffers from a dedicated transfer queue, without ever blocking the render loop
+// - data is copied into a staging ring buffer and copied to its destination by the transfer queue
+// - every frame only uploads up to a byte budget, large uploads are split up and spread over several frames
+// - finished uploads are found by polling the transfer queue's timeline, they're handed to the graphics queue the next frame
+// a transfer-only family usually maps to the GPU's copy engines, so the copies run next to rendering instead of between it.
+// buffers are owned by one queue family at a time (VK_SHARING_MODE_EXCLUSIVE), so when the transfer family isn't the
+// graphics family every upload needs a queue family ownership transfer: the transfer queue releases the range once it's
+// written, and the graphics queue acquires it with a matching barrier before its first use. the graphics submit waits for
+// the transfer timeline, which is what orders the acquire after the release.
+class Uploader
+{
+public:
+    using Ticket = uint32_t;
+
+    // transferQueue is a queue of families.transfer, or the graphics queue when the device has no dedicated transfer family
+    // stagingSize limits how much data is in flight, frameBudget how much is submitted per update()
+    Uploader(VkDevice device, VkPhysicalDevice physicalDevice, const QueueFamilies& families, VkQueue transferQueue, VkDeviceSize stagingSize, VkDeviceSize frameBudget)
+        : m_device(device), m_frameBudget(frameBudget)
+    {
+        m_transferFamily = static_cast<uint32_t>(families.transfer != -1 ? families.transfer : families.graphics);
+        m_graphicsFamily = static_cast<uint32_t>(families.graphics);
+        m_timeline = std::make_unique<Timeline>(device, transferQueue);
+
+        // the staging buffer is only ever read by the transfer queue
+        m_staging = Buffer::create(device, physicalDevice, families, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, true);
+        m_staging->map();
+
+        VkCommandPoolCreateInfo commandPoolInfo {};
+        commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolInfo.pNext = nullptr;
+        commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        commandPoolInfo.queueFamilyIndex = m_transferFamily;
+        THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &m_commandPool));
+    }
+
+    ~Uploader()
+    {
+        m_timeline->waitIdle();
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+    }
+
+    // queue an upload of size bytes to dst at offset, data has to stay valid until the upload is ready()
+    // dstStages and dstAccess are how the graphics queue uses the data afterwards, e.g. vertex input and vertex attribute reads
+    Ticket upload(VkBuffer dst, VkDeviceSize offset, const void* data, VkDeviceSize size, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+    {
+        Ticket ticket = static_cast<Ticket>(m_ready.size());
+        m_ready.push_back(false);
+        m_requests.push_back(Request { dst, offset, static_cast<const uint8_t*>(data), size, 0, dstStages, dstAccess, ticket });
+        return ticket;
+    }
+
+    // called once per frame while recording the graphics command buffer, before anything uses uploaded data
+    // - acquires every range whose copy finished since the last update, which makes their uploads ready()
+    // - submits the next batch of copies, up to the frame budget
+    // the returned waits have to be passed to this frame's graphics submit
+    std::vector<Timeline::Wait> update(VkCommandBuffer graphicsCmd)
+    {
+        std::vector<Timeline::Wait> waits;
+        std::vector<VkBufferMemoryBarrier> acquires;
+        VkPipelineStageFlags dstStages = 0;
+        uint64_t lastValue = 0;
+
+        // batches finish in submission order, polling never blocks
+        while (!m_batches.empty() && m_timeline->finished(m_batches.front().value))
+        {
+            Batch& batch = m_batches.front();
+            for (const Region& region : batch.regions)
+            {
+                acquires.push_back(barrier(region, m_transferFamily, m_graphicsFamily, 0, region.dstAccess));
+                dstStages |= region.dstStages;
+            }
+            for (Ticket ticket : batch.completed)
+                m_ready[ticket] = true;
+
+            m_stagingTail = batch.stagingEnd;
+            m_freeCommandBuffers.push_back(batch.cmd);
+            lastValue = batch.value;
+            m_batches.pop_front();
+        }
+
+        if (!acquires.empty())
+        {
+            // with a separate transfer family this is the acquire half of the ownership transfer. it has to come after the
+            // timeline wait below, and a wait only orders the stages it blocks, so the acquire starts from those same stages
+            // within one family it's a regular barrier that makes the copies visible
+            VkPipelineStageFlags srcStages = separateFamilies() ? dstStages : VK_PIPELINE_STAGE_TRANSFER_BIT;
+            if (!separateFamilies())
+                for (VkBufferMemoryBarrier& acquire : acquires)
+                    acquire.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            vkCmdPipelineBarrier(graphicsCmd, srcStages, dstStages, 0, 0, nullptr, acquires.size(), acquires.data(), 0, nullptr);
+
+            // the copies are already done, so this wait never stalls, but it's what orders the acquire after the release
+            waits.push_back(m_timeline->waitFor(lastValue, dstStages));
+        }
+
+        submitBatch();
+        return waits;
+    }
+
+    bool ready(Ticket ticket) const { return m_ready[ticket]; }
+    bool idle() const { return m_requests.empty() && m_batches.empty(); }
+    bool separateFamilies() const { return m_transferFamily != m_graphicsFamily; }
+
+    // the number of bytes submitted so far, and how many batches are still in flight
+    VkDeviceSize bytesUploaded() const { return m_bytesUploaded; }
+    size_t batchesInFlight() const { return m_batches.size(); }
+
+private:
+    struct Request
+    {
+        VkBuffer dst;
+        VkDeviceSize dstOffset;
+        const uint8_t* data;
+        VkDeviceSize size;
+        VkDeviceSize copied;
+        VkPipelineStageFlags dstStages;
+        VkAccessFlags dstAccess;
+        Ticket ticket;
+    };
+
+    // a range that was written by a batch, it's released and acquired with the exact same range
+    struct Region
+    {
+        VkBuffer dst;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        VkPipelineStageFlags dstStages;
+        VkAccessFlags dstAccess;
+    };
+
+    struct Batch
+    {
+        uint64_t value;
+        VkCommandBuffer cmd;
+        uint64_t stagingEnd;
+        std::vector<Region> regions;
+        std::vector<Ticket> completed;
+    };
+
+    VkBufferMemoryBarrier barrier(const Region& region, uint32_t srcFamily, uint32_t dstFamily, VkAccessFlags srcAccess, VkAccessFlags dstAccess) const
+    {
+        VkBufferMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.pNext = nullptr;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = separateFamilies() ? srcFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = separateFamilies() ? dstFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = region.dst;
+        barrier.offset = region.offset;
+        barrier.size = region.size;
+        return barrier;
+    }
+
+    // the staging buffer is a ring: m_stagingHead and m_stagingTail only ever grow, their difference is the space in use
+    // a chunk never wraps around the end of the buffer, the space it skips is freed together with the chunk
+    bool allocateStaging(VkDeviceSize size, VkDeviceSize* offset)
+    {
+        VkDeviceSize capacity = m_staging->size;
+        VkDeviceSize position = m_stagingHead % capacity;
+        VkDeviceSize skip = position + size > capacity ? capacity - position : 0;
+        if (m_stagingHead + skip + size - m_stagingTail > capacity)
+            return false;
+
+        m_stagingHead += skip;
+        *offset = m_stagingHead % capacity;
+        m_stagingHead += size;
+        return true;
+    }
+
+    void submitBatch()
+    {
+        if (m_requests.empty())
+            return;
+
+        Batch batch {};
+        VkDeviceSize budget = m_frameBudget;
+        std::vector<VkBufferCopy> copies;
+
+        if (m_freeCommandBuffers.empty())
+        {
+            VkCommandBufferAllocateInfo cmdAllocInfo {};
+            cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            cmdAllocInfo.pNext = nullptr;
+            cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            cmdAllocInfo.commandBufferCount = 1;
+            cmdAllocInfo.commandPool = m_commandPool;
+            THROW_IF_FAILED(vkAllocateCommandBuffers(m_device, &cmdAllocInfo, &batch.cmd));
+        }
+        else
+        {
+            batch.cmd = m_freeCommandBuffers.back();
+            m_freeCommandBuffers.pop_back();
+        }
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(batch.cmd, &beginInfo);
+
+        // requests are uploaded in order, a request that doesn't fit the budget (or the ring) continues in the next batch
+        while (!m_requests.empty() && budget > 0)
+        {
+            Request& request = m_requests.front();
+            VkDeviceSize size = std::min({ request.size - request.copied, budget, m_staging->size / 2 });
+            VkDeviceSize stagingOffset;
+            if (!allocateStaging(size, &stagingOffset))
+                break;
+
+            memcpy(m_staging->mapped + stagingOffset, request.data + request.copied, size);
+
+            VkBufferCopy copy { stagingOffset, request.dstOffset + request.copied, size };
+            vkCmdCopyBuffer(batch.cmd, m_staging->buffer, request.dst, 1, &copy);
+            batch.regions.push_back(Region { request.dst, copy.dstOffset, size, request.dstStages, request.dstAccess });
+
+            request.copied += size;
+            budget -= size;
+            m_bytesUploaded += size;
+
+            if (request.copied == request.size)
+            {
+                batch.completed.push_back(request.ticket);
+                m_requests.pop_front();
+            }
+        }
+
+        // the release half of the ownership transfer, the destination stages are ignored for a release
+        if (separateFamilies() && !batch.regions.empty())
+        {
+            std::vector<VkBufferMemoryBarrier> releases;
+            for (const Region& region : batch.regions)
+                releases.push_back(barrier(region, m_transferFamily, m_graphicsFamily, VK_ACCESS_TRANSFER_WRITE_BIT, 0));
+
+            vkCmdPipelineBarrier(batch.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, releases.size(), releases.data(), 0, nullptr);
+        }
+
+        vkEndCommandBuffer(batch.cmd);
+
+        // the ring is full until earlier batches finish, try again next frame
+        if (batch.regions.empty())
+        {
+            m_freeCommandBuffers.push_back(batch.cmd);
+            return;
+        }
+
+        batch.value = m_timeline->submit({ batch.cmd });
+        batch.stagingEnd = m_stagingHead;
+        m_batches.push_back(std::move(batch));
+    }
+
+    VkDevice m_device;
+    VkCommandPool m_commandPool;
+    std::unique_ptr<Timeline> m_timeline;
+    std::unique_ptr<Buffer> m_staging;
+    uint32_t m_transferFamily, m_graphicsFamily;
+
+    VkDeviceSize m_frameBudget;
+    uint64_t m_stagingHead = 0, m_stagingTail = 0;
+    VkDeviceSize m_bytesUploaded = 0;
+
+    std::deque<Request> m_requests;
+    std::deque<Batch> m_batches;
+    std::vector<VkCommandBuffer> m_freeCommandBuffers;
+    std::vector<bool> m_ready;
+};
@@ -0,0 +1,10 @@
+#version 450
+
+layout(location = 0) out vec2 outUv;
+
+// a single triangle that covers the whole screen, generated from the vertex index so no vertex buffer is needed
+// vertices end up at (-1, -1), (3, -1) and (-1, 3), the part outside of the screen is clipped
+void main() {
+    outUv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(outUv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,295 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+#include <cassert>
+
+// keeps track of how every image and buffer was last accessed, and turns the next access into the barrier it needs
+// accesses only queue up barriers, flush() then records everything that's pending in a single barrier call.
+// each resource remembers:
+// - its layout (images only)
+// - the stages and access of its last write, which later accesses have to wait on and make visible
+// - the stages and access of the reads since that write, which a later write has to wait on
+// reads of data that an earlier read in the same stage already waited for need no barrier at all.
+// with VK_KHR_synchronization2 every barrier keeps its own stage masks, the old vkCmdPipelineBarrier only has one
+// pair of masks per call, so every barrier in a batch ends up waiting on the union of all of their stages.
+class BarrierTracker
+{
+public:
+    struct Stats
+    {
+        uint32_t calls = 0;
+        uint32_t imageBarriers = 0;
+        uint32_t bufferBarriers = 0;
+    };
+
+    BarrierTracker(VkDevice device, bool synchronization2)
+    {
+#ifdef VK_KHR_synchronization2
+        // extension functions aren't exported by the loader, so we have to look them up ourselves
+        if (synchronization2)
+            m_cmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR"));
+#endif
+    }
+
+    bool synchronization2() const { return m_cmdPipelineBarrier2 != nullptr; }
+
+    // start tracking an image in the given layout, pendingStages are the stages that may still be accessing it
+    // e.g. the stage a swapchain image's acquire semaphore is waited on
+    void addImage(VkImage image, VkImageAspectFlags aspect, VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED, VkPipelineStageFlags pendingStages = 0)
+    {
+        State state {};
+        state.aspect = aspect;
+        state.layout = layout;
+        state.writeStages = pendingStages;
+        m_images[image] = state;
+    }
+
+    void addBuffer(VkBuffer buffer)
+    {
+        m_buffers[buffer] = State {};
+    }
+
+    void remove(VkImage image) { m_images.erase(image); }
+    void remove(VkBuffer buffer) { m_buffers.erase(buffer); }
+
+    // the image is about to be used in memory that "previous" occupied before it, which may be the image itself
+    // its contents are discarded (UNDEFINED layout), but it does have to wait for all of previous' accesses to finish,
+    // and previous' writes have to be made available, or they could land after the first write to the same memory
+    void alias(VkImage image, VkImage previous)
+    {
+        const State& old = find(m_images, previous);
+        VkPipelineStageFlags pendingStages = old.writeStages | old.readStages;
+        VkAccessFlags pendingWrites = old.writeAccess;
+
+        State& state = find(m_images, image);
+        state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        state.writeStages = pendingStages;
+        state.writeAccess = pendingWrites;
+        state.readStages = 0;
+        state.readAccess = 0;
+    }
+
+    // the next access to the image, in the given stages and layout
+    void image(VkImage image, VkPipelineStageFlags stages, VkAccessFlags access, VkImageLayout layout)
+    {
+        State& state = find(m_images, image);
+        use(state, stages, access, layout, image, VK_NULL_HANDLE);
+    }
+
+    void buffer(VkBuffer buffer, VkPipelineStageFlags stages, VkAccessFlags access)
+    {
+        State& state = find(m_buffers, buffer);
+        use(state, stages, access, VK_IMAGE_LAYOUT_UNDEFINED, VK_NULL_HANDLE, buffer);
+    }
+
+    // record all pending barriers in a single call
+    void flush(VkCommandBuffer cmd)
+    {
+        if (m_pending.empty())
+            return;
+
+        m_stats.calls++;
+
+#ifdef VK_KHR_synchronization2
+        if (m_cmdPipelineBarrier2)
+        {
+            std::vector<VkImageMemoryBarrier2KHR> imageBarriers;
+            std::vector<VkBufferMemoryBarrier2KHR> bufferBarriers;
+            for (const Pending& pending : m_pending)
+            {
+                // NONE is a valid stage with synchronization2, e.g. for the first use of an image nothing accessed before
+                if (pending.image != VK_NULL_HANDLE)
+                {
+                    VkImageMemoryBarrier2KHR barrier { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR };
+                    barrier.srcStageMask = pending.srcStages;
+                    barrier.srcAccessMask = pending.srcAccess;
+                    barrier.dstStageMask = pending.dstStages;
+                    barrier.dstAccessMask = pending.dstAccess;
+                    barrier.oldLayout = pending.oldLayout;
+                    barrier.newLayout = pending.newLayout;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.image = pending.image;
+                    barrier.subresourceRange = VkImageSubresourceRange { pending.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+                    imageBarriers.push_back(barrier);
+                }
+                else
+                {
+                    VkBufferMemoryBarrier2KHR barrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR };
+                    barrier.srcStageMask = pending.srcStages;
+                    barrier.srcAccessMask = pending.srcAccess;
+                    barrier.dstStageMask = pending.dstStages;
+                    barrier.dstAccessMask = pending.dstAccess;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.buffer = pending.buffer;
+                    barrier.offset = 0;
+                    barrier.size = VK_WHOLE_SIZE;
+                    bufferBarriers.push_back(barrier);
+                }
+            }
+
+            VkDependencyInfoKHR dependencyInfo { VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR };
+            dependencyInfo.dependencyFlags = 0;
+            dependencyInfo.bufferMemoryBarrierCount = bufferBarriers.size();
+            dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+            dependencyInfo.imageMemoryBarrierCount = imageBarriers.size();
+            dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+            m_cmdPipelineBarrier2(cmd, &dependencyInfo);
+
+            m_stats.imageBarriers += imageBarriers.size();
+            m_stats.bufferBarriers += bufferBarriers.size();
+            m_pending.clear();
+            return;
+        }
+#endif
+
+        // one pair of stage masks for the whole batch, a barrier that only waits on writes still needs an access mask
+        VkPipelineStageFlags srcStages = 0, dstStages = 0;
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+        for (const Pending& pending : m_pending)
+        {
+            srcStages |= pending.srcStages;
+            dstStages |= pending.dstStages;
+
+            if (pending.image != VK_NULL_HANDLE)
+            {
+                VkImageMemoryBarrier barrier { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+                barrier.srcAccessMask = pending.srcAccess;
+                barrier.dstAccessMask = pending.dstAccess;
+                barrier.oldLayout = pending.oldLayout;
+                barrier.newLayout = pending.newLayout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = pending.image;
+                barrier.subresourceRange = VkImageSubresourceRange { pending.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+                imageBarriers.push_back(barrier);
+            }
+            else if (pending.srcAccess != 0)
+            {
+                // buffers don't have layouts, so waiting for reads to finish is just an execution dependency: the stages cover it
+                VkBufferMemoryBarrier barrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+                barrier.srcAccessMask = pending.srcAccess;
+                barrier.dstAccessMask = pending.dstAccess;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = pending.buffer;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+                bufferBarriers.push_back(barrier);
+            }
+        }
+
+        // without synchronization2 an empty stage mask isn't allowed
+        if (srcStages == 0)
+            srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        if (dstStages == 0)
+            dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+        vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, nullptr, bufferBarriers.size(), bufferBarriers.data(), imageBarriers.size(), imageBarriers.data());
+
+        m_stats.imageBarriers += imageBarriers.size();
+        m_stats.bufferBarriers += bufferBarriers.size();
+        m_pending.clear();
+    }
+
+    // the number of barrier calls and barriers recorded since the last reset
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats {}; }
+
+private:
+    struct State
+    {
+        VkImageAspectFlags aspect;
+        VkImageLayout layout;
+        VkPipelineStageFlags writeStages;
+        VkAccessFlags writeAccess;
+        VkPipelineStageFlags readStages;
+        VkAccessFlags readAccess;
+    };
+
+    struct Pending
+    {
+        VkImage image;
+        VkBuffer buffer;
+        VkImageAspectFlags aspect;
+        VkPipelineStageFlags srcStages, dstStages;
+        VkAccessFlags srcAccess, dstAccess;
+        VkImageLayout oldLayout, newLayout;
+    };
+
+    static constexpr VkAccessFlags writeAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+        | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    template <typename Handle>
+    static State& find(std::unordered_map<Handle, State>& states, Handle handle)
+    {
+        auto it = states.find(handle);
+        assert(it != states.end() && "resource isn't tracked, add it first");
+        return it->second;
+    }
+
+    void use(State& state, VkPipelineStageFlags stages, VkAccessFlags access, VkImageLayout layout, VkImage image, VkBuffer buffer)
+    {
+        bool write = (access & writeAccessMask) != 0;
+        bool layoutChange = image != VK_NULL_HANDLE && state.layout != layout;
+
+        if (write || layoutChange)
+        {
+            // write after write and write after read: wait for both, only the write has to be made available
+            // a layout transition rewrites the image as well, so it's handled like a write
+            VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+            if (srcStages != 0 || layoutChange)
+                queue(image, buffer, state.aspect, srcStages, state.writeAccess, stages, access, state.layout, layout);
+
+            // the transition itself is done once the barrier's destination stages start, reads in those stages see it
+            state.writeStages = stages;
+            state.writeAccess = access & writeAccessMask;
+            state.readStages = write ? 0 : stages;
+            state.readAccess = write ? 0 : access;
+            state.layout = layout;
+            return;
+        }
+
+        // read after write: skip the barrier if there was no write yet,
+        // or an earlier read in the same stages already made the write visible
+        bool covered = state.writeStages == 0 || ((state.readStages & stages) == stages && (state.readAccess & access) == access);
+        if (!covered)
+            queue(image, buffer, state.aspect, state.writeStages, state.writeAccess, stages, access, state.layout, layout);
+
+        state.readStages |= stages;
+        state.readAccess |= access;
+    }
+
+    // a resource that's accessed twice before a flush gets a single barrier that covers both
+    void queue(VkImage image, VkBuffer buffer, VkImageAspectFlags aspect, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout)
+    {
+        for (Pending& pending : m_pending)
+        {
+            if (pending.image != image || pending.buffer != buffer)
+                continue;
+
+            assert(pending.newLayout == newLayout && "an image can only be in one layout between two flushes");
+            pending.srcStages |= srcStages;
+            pending.srcAccess |= srcAccess;
+            pending.dstStages |= dstStages;
+            pending.dstAccess |= dstAccess;
+            return;
+        }
+
+        m_pending.push_back(Pending { image, buffer, aspect, srcStages, dstStages, srcAccess, dstAccess, oldLayout, newLayout });
+    }
+
+    std::unordered_map<VkImage, State> m_images;
+    std::unordered_map<VkBuffer, State> m_buffers;
+    std::vector<Pending> m_pending;
+    Stats m_stats;
+
+#ifdef VK_KHR_synchronization2
+    PFN_vkCmdPipelineBarrier2KHR m_cmdPipelineBarrier2 = nullptr;
+#else
+    void* m_cmdPipelineBarrier2 = nullptr;
+#endif
+};
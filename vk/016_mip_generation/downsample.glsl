@@ -0,0 +1,24 @@
+#version 450
+
+layout(location = 0) in vec2 inUv;
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+
+layout(push_constant) uniform Constants {
+    vec2 texelSize; // of the source image
+    float bloomStrength;
+} constants;
+
+// halves the resolution and keeps only the parts of the scene that are brighter than 1
+// the four bilinear taps sit on the corners of the 2x2 block, which averages a 4x4 area of the source
+void main() {
+    vec2 offset = constants.texelSize;
+    vec3 color = texture(source, inUv + vec2(-offset.x, -offset.y)).rgb
+               + texture(source, inUv + vec2( offset.x, -offset.y)).rgb
+               + texture(source, inUv + vec2(-offset.x,  offset.y)).rgb
+               + texture(source, inUv + vec2( offset.x,  offset.y)).rgb;
+    color *= 0.25;
+
+    outColor = vec4(max(color - vec3(1.0), vec3(0.0)), 1.0);
+}
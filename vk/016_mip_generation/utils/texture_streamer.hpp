@@ -0,0 +1,384 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "preprocessor.hpp"
+#include "image.hpp"
+#include "ktx2.hpp"
+#include "uploader.hpp"
+#include "mip_generator.hpp"
+#include "timeline.hpp"
+
+// streams the mip levels of a set of textures in and out of device memory, fine levels only for textures that are large on screen
+// - at startup only the tail of every mip chain (the levels up to tailSize) is uploaded, so every texture is usable within a few frames
+// - every frame the caller reports how large every texture is on screen, which decides the finest level the texture needs
+// - textures that need finer levels get them one level at a time, the ones missing the most detail first, as long as the
+//   resident levels fit the budget. when they don't, textures that have finer levels than they need give theirs up
+// an image can't grow or shrink its mip chain, and without sparse residency its memory is allocated as a whole.
+// so a texture moves to a new image with one more (or one less) level: the levels both images share are copied on the
+// graphics queue, and the new finest level comes in through the uploader. the texture keeps sampling its old image until the
+// new level has arrived, and old images are destroyed once the last frame that sampled them has finished.
+// textures that come with a single level have nothing to stream, they're loaded as a whole and the generator fills in
+// their other levels on the GPU. they can't be demoted, since their finer levels can't be uploaded again.
+class TextureStreamer
+{
+public:
+    // budget is the number of bytes the textures may occupy, the tails of all textures are loaded regardless of it
+    // timeline is the graphics timeline, images are sampled by the frames submitted to it
+    TextureStreamer(VkDevice device, VkPhysicalDevice physicalDevice, Uploader& uploader, MipGenerator& generator, const Timeline& timeline, std::vector<Ktx2> sources, VkDeviceSize budget, uint32_t tailSize = 64)
+        : m_device(device), m_physicalDevice(physicalDevice), m_uploader(uploader), m_generator(generator), m_timeline(timeline), m_budget(budget)
+    {
+        m_placeholder = Image::create(device, physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, VkExtent2D { 1, 1 }, 1, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+        for (Ktx2& source : sources)
+        {
+            // compressed formats are optional (textureCompressionBC), the file picks the format so it's checked here
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, source.format, &properties);
+            VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+            if ((properties.optimalTilingFeatures & required) != required)
+                throw std::runtime_error("Texture format " + std::to_string(source.format) + " can't be sampled on this device");
+
+            Texture texture;
+            texture.source = std::move(source);
+            uint32_t levelCount = static_cast<uint32_t>(texture.source.levels.size());
+
+            texture.generated = levelCount == 1 && Image::mipCount(texture.source.extent) > 1;
+            if (texture.generated && !generator.supported(texture.source.format))
+                throw std::runtime_error("Texture format " + std::to_string(texture.source.format) + " can't have its mips generated on this device");
+
+            // the tail starts at the first level that fits in tailSize, or at the last level if none do
+            texture.tailBase = levelCount - 1;
+            for (uint32_t i = 0; i < levelCount; i++)
+            {
+                VkExtent2D extent = texture.source.levels[i].extent;
+                if (std::max(extent.width, extent.height) <= tailSize)
+                {
+                    texture.tailBase = i;
+                    break;
+                }
+            }
+
+            texture.base = levelCount;
+            texture.wanted = texture.tailBase;
+            m_textures.push_back(std::move(texture));
+
+            // the tail is uploaded as a whole, the texture starts sampling it once every level has arrived
+            Texture& added = m_textures.back();
+            added.pending = createImage(added, added.tailBase);
+            added.pendingBase = added.tailBase;
+            added.uploadedLevels = levelCount - added.tailBase;
+            for (uint32_t i = added.tailBase; i < levelCount; i++)
+                upload(added, i);
+        }
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // called once per frame while recording the graphics command buffer, after the uploader's update() and before the draws
+    // screenSizes holds a size in pixels per texture: how wide the texture's full resolution would have to be to match the
+    // pixels of the object that shows it the largest. 0 for textures that weren't visible
+    void update(VkCommandBuffer cmd, const uint32_t* screenSizes)
+    {
+        // textures without a resident level sample the placeholder, which is cleared to grey once
+        if (!m_placeholderCleared)
+        {
+            VkImageMemoryBarrier toTransfer = m_placeholder->transition(0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+            VkClearColorValue grey { { 0.5f, 0.5f, 0.5f, 1.0f } };
+            VkImageSubresourceRange range { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            vkCmdClearColorImage(cmd, m_placeholder->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &grey, 1, &range);
+
+            VkImageMemoryBarrier toShader = m_placeholder->transition(0, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+            m_placeholderCleared = true;
+        }
+
+        // polling never blocks, images are retired in submission order
+        while (!m_retired.empty() && m_timeline.finished(m_retired.front().value))
+            m_retired.pop_front();
+
+        // swap in the images whose uploads have all arrived, the uploader acquired their levels earlier in this command buffer
+        for (Texture& texture : m_textures)
+        {
+            if (!texture.pending)
+                continue;
+            if (!std::all_of(texture.tickets.begin(), texture.tickets.end(), [&](Uploader::Ticket ticket) { return m_uploader.ready(ticket); }))
+                continue;
+
+            // the uploader's acquire left the uploaded levels in SHADER_READ_ONLY_OPTIMAL, copied levels were transitioned below
+            texture.pending->setLayout(0, texture.uploadedLevels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            if (texture.generated)
+                m_generator.add(texture.pending.get());
+
+            retire(std::move(texture.image));
+            texture.image = std::move(texture.pending);
+            texture.base = texture.pendingBase;
+            texture.tickets.clear();
+        }
+
+        // all textures whose first level arrived this frame get their other levels at once, before anything samples them
+        m_generator.record(cmd);
+
+        // a level is fine enough as long as it has at least as many texels as the texture covers pixels
+        // textures that aren't visible only need their tail
+        for (size_t i = 0; i < m_textures.size(); i++)
+        {
+            Texture& texture = m_textures[i];
+            VkExtent2D extent = texture.source.extent;
+            uint32_t size = std::max(extent.width, extent.height);
+
+            texture.screenSize = screenSizes[i];
+            texture.wanted = texture.tailBase;
+            if (texture.screenSize > 0)
+            {
+                texture.wanted = 0;
+                while (texture.wanted < texture.tailBase && (size >> (texture.wanted + 1)) >= texture.screenSize)
+                    texture.wanted++;
+            }
+        }
+
+        // the textures missing the most levels go first, between those the ones that are the largest on screen
+        std::vector<Texture*> candidates;
+        for (Texture& texture : m_textures)
+            if (texture.image && !texture.pending && texture.wanted < texture.base)
+                candidates.push_back(&texture);
+
+        std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) {
+            if (a->base - a->wanted != b->base - b->wanted)
+                return a->base - a->wanted > b->base - b->wanted;
+            return a->screenSize > b->screenSize;
+        });
+
+        // a texture that doesn't fit stops the promotions, skipping it for smaller ones would starve the most important texture
+        std::vector<Copy> copies;
+        uint32_t promotions = 0;
+        for (Texture* texture : candidates)
+        {
+            if (promotions == m_maxPromotionsPerFrame)
+                break;
+
+            VkDeviceSize size = levelBytes(*texture, texture->base - 1);
+            if (!makeRoom(size, texture, copies))
+                break;
+
+            promote(*texture, copies);
+            promotions++;
+        }
+
+        recordCopies(cmd, copies);
+    }
+
+    // the view to sample a texture with, the placeholder until its tail has arrived
+    VkImageView view(uint32_t texture) const
+    {
+        const Texture& t = m_textures[texture];
+        return t.image ? t.image->view : m_placeholder->view;
+    }
+
+    // the finest resident level of a texture, the number of levels while it has none
+    uint32_t residentLevel(uint32_t texture) const { return m_textures[texture].base; }
+
+    // the bytes taken up by the images the textures sample and the images they're moving to
+    // images that were just replaced aren't counted, they're gone once the frames in flight have finished
+    VkDeviceSize residentBytes() const
+    {
+        VkDeviceSize bytes = 0;
+        for (const Texture& texture : m_textures)
+        {
+            if (texture.image)
+                bytes += texture.image->size;
+            if (texture.pending)
+                bytes += texture.pending->size;
+        }
+
+        return bytes;
+    }
+
+    VkDeviceSize budget() const { return m_budget; }
+    size_t textureCount() const { return m_textures.size(); }
+    uint32_t promotions() const { return m_promotions; }
+    uint32_t demotions() const { return m_demotions; }
+
+private:
+    // image holds the source's levels from base onwards, so its mip 0 is the source's level base
+    // pending is the image the texture moves to once its uploads are ready()
+    struct Texture
+    {
+        Ktx2 source;
+        bool generated; // the source only has its first level, the others are generated
+        std::unique_ptr<Image> image;
+        uint32_t base;
+        std::unique_ptr<Image> pending;
+        uint32_t pendingBase;
+        uint32_t uploadedLevels; // the levels of pending that come from the uploader, starting at its mip 0
+        std::vector<Uploader::Ticket> tickets;
+        uint32_t tailBase;
+        uint32_t wanted;
+        uint32_t screenSize;
+    };
+
+    // levels count mips of src starting at srcMip to dst starting at dstMip
+    // the source stays in use (and goes back to SHADER_READ_ONLY_OPTIMAL afterwards) unless it's being retired
+    struct Copy
+    {
+        Image* src;
+        Image* dst;
+        uint32_t srcMip, dstMip, count;
+        bool keepSource;
+    };
+
+    struct Retired
+    {
+        std::unique_ptr<Image> image;
+        uint64_t value;
+    };
+
+    std::unique_ptr<Image> createImage(const Texture& texture, uint32_t base) const
+    {
+        const Ktx2& source = texture.source;
+        uint32_t mipLevels = static_cast<uint32_t>(source.levels.size()) - base;
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (texture.generated)
+        {
+            mipLevels = Image::mipCount(source.extent);
+            usage |= m_generator.usage(source.format);
+        }
+
+        return Image::create(m_device, m_physicalDevice, source.format, source.levels[base].extent, mipLevels, usage);
+    }
+
+    // uploads a level of the source into the pending image, the fragment shader samples it once it's ready
+    void upload(Texture& texture, uint32_t level)
+    {
+        const Ktx2::Level& source = texture.source.levels[level];
+        texture.tickets.push_back(m_uploader.uploadImage(texture.pending->image, level - texture.pendingBase, source.extent, texture.source.blockDim, source.data, source.size, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+    }
+
+    // the size of an image that starts at the given level, a little less than the driver will ask for
+    VkDeviceSize levelBytes(const Texture& texture, uint32_t base) const
+    {
+        VkDeviceSize bytes = 0;
+        for (size_t i = base; i < texture.source.levels.size(); i++)
+            bytes += texture.source.levels[i].size;
+        return bytes;
+    }
+
+    // the frame that's being recorded is the last one that can sample the image
+    void retire(std::unique_ptr<Image> image)
+    {
+        if (image)
+            m_retired.push_back(Retired { std::move(image), m_timeline.submitted() + 1 });
+    }
+
+    // demote textures that have finer levels than they need until bytes more fit the budget, the smallest on screen first
+    bool makeRoom(VkDeviceSize bytes, const Texture* keep, std::vector<Copy>& copies)
+    {
+        while (residentBytes() + bytes > m_budget)
+        {
+            Texture* victim = nullptr;
+            for (Texture& texture : m_textures)
+            {
+                if (&texture == keep || !texture.image || texture.pending || texture.generated || texture.base >= texture.wanted)
+                    continue;
+
+                // an image that was only created this frame is still waiting for its copies
+                if (std::any_of(copies.begin(), copies.end(), [&](const Copy& copy) { return copy.dst == texture.image.get(); }))
+                    continue;
+                if (!victim || texture.screenSize < victim->screenSize)
+                    victim = &texture;
+            }
+
+            if (!victim)
+                return false;
+
+            demote(*victim, copies);
+        }
+
+        return true;
+    }
+
+    // the new image gets its finest level from the uploader and all others from the old image
+    void promote(Texture& texture, std::vector<Copy>& copies)
+    {
+        texture.pendingBase = texture.base - 1;
+        texture.pending = createImage(texture, texture.pendingBase);
+        texture.uploadedLevels = 1;
+        upload(texture, texture.pendingBase);
+
+        copies.push_back(Copy { texture.image.get(), texture.pending.get(), 0, 1, texture.image->mipLevels, true });
+        m_promotions++;
+    }
+
+    // all levels of the new image are already resident, so it replaces the old one right away
+    void demote(Texture& texture, std::vector<Copy>& copies)
+    {
+        std::unique_ptr<Image> image = createImage(texture, texture.base + 1);
+        copies.push_back(Copy { texture.image.get(), image.get(), 1, 0, image->mipLevels, false });
+
+        retire(std::move(texture.image));
+        texture.image = std::move(image);
+        texture.base++;
+        m_demotions++;
+    }
+
+    // all copies of a frame share a barrier before and a barrier after them
+    // the sources were last sampled by the fragment shader, by this frame or an earlier one on the same queue
+    void recordCopies(VkCommandBuffer cmd, const std::vector<Copy>& copies)
+    {
+        if (copies.empty())
+            return;
+
+        std::vector<VkImageMemoryBarrier> before, after;
+        for (const Copy& copy : copies)
+        {
+            before.push_back(copy.src->transition(0, copy.src->mipLevels, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, VK_ACCESS_TRANSFER_READ_BIT));
+            before.push_back(copy.dst->transition(copy.dstMip, copy.count, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT));
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, before.size(), before.data());
+
+        for (const Copy& copy : copies)
+        {
+            std::vector<VkImageCopy> regions(copy.count);
+            for (uint32_t i = 0; i < copy.count; i++)
+            {
+                VkExtent2D extent = copy.dst->mipExtent(copy.dstMip + i);
+                regions[i].srcSubresource = VkImageSubresourceLayers { VK_IMAGE_ASPECT_COLOR_BIT, copy.srcMip + i, 0, 1 };
+                regions[i].srcOffset = VkOffset3D { 0, 0, 0 };
+                regions[i].dstSubresource = VkImageSubresourceLayers { VK_IMAGE_ASPECT_COLOR_BIT, copy.dstMip + i, 0, 1 };
+                regions[i].dstOffset = VkOffset3D { 0, 0, 0 };
+                regions[i].extent = VkExtent3D { extent.width, extent.height, 1 };
+            }
+            vkCmdCopyImage(cmd, copy.src->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.dst->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+        }
+
+        for (const Copy& copy : copies)
+        {
+            if (copy.keepSource)
+                after.push_back(copy.src->transition(0, copy.src->mipLevels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT));
+            after.push_back(copy.dst->transition(copy.dstMip, copy.count, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, after.size(), after.data());
+    }
+
+    VkDevice m_device;
+    VkPhysicalDevice m_physicalDevice;
+    Uploader& m_uploader;
+    MipGenerator& m_generator;
+    const Timeline& m_timeline;
+
+    VkDeviceSize m_budget;
+    uint32_t m_maxPromotionsPerFrame = 2;
+    uint32_t m_promotions = 0, m_demotions = 0;
+
+    std::vector<Texture> m_textures;
+    std::unique_ptr<Image> m_placeholder;
+    bool m_placeholderCleared = false;
+    std::deque<Retired> m_retired;
+};
@@ -0,0 +1,54 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) flat out uint fragTexture;
+
+// the depth prepass computes the exact same position, invariant guarantees both produce the exact same depth
+// without it the EQUAL depth test of the color pass could fail on rounding differences
+invariant gl_Position;
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+} constants;
+
+// the same block as in cull.glsl, only the texture count is used here
+layout(set = 0, binding = 0) uniform View {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint objectCount;
+    uint lodCount;
+    int vertexOffset;
+    float projectionScale;
+    float pixelThreshold;
+    float radius;
+    uint compact;
+    uint finestLod;
+    float time;
+    uint gridSize;
+    float angularSpacing;
+    float nearestDistance;
+    float objectScale;
+    uint textureCount;
+} view;
+
+// every draw is a single instance whose firstInstance is the object's index
+layout(std430, set = 0, binding = 1) readonly buffer Objects { vec4 objects[]; }; // center.xyz, scale
+layout(std430, set = 0, binding = 5) readonly buffer ObjectLods { uint objectLods[]; };
+
+// one color per level of detail, so the switches are visible
+const vec3 lodColors[8] = vec3[](
+    vec3(1.0, 1.0, 1.0), vec3(0.3, 0.6, 1.0), vec3(0.3, 1.0, 0.4), vec3(1.0, 1.0, 0.3),
+    vec3(1.0, 0.6, 0.2), vec3(1.0, 0.3, 0.3), vec3(0.9, 0.3, 1.0), vec3(0.5, 0.5, 0.5)
+);
+
+void main() {
+    vec4 object = objects[gl_InstanceIndex];
+    gl_Position = constants.viewProjection * vec4(object.xyz + position * object.w, 1.0);
+    fragNormal = normal;
+    fragColor = lodColors[min(objectLods[gl_InstanceIndex], 7u)];
+    fragTexture = gl_InstanceIndex % view.textureCount;
+}
@@ -0,0 +1,18 @@
+#version 450
+
+// the depth prepass only needs positions: no normals, no colors and no fragment shader
+layout(location = 0) in vec3 position;
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+} constants;
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects { vec4 objects[]; }; // center.xyz, scale
+
+// must match vertex.glsl exactly, so the color pass's EQUAL depth test passes for the visible surfaces
+invariant gl_Position;
+
+void main() {
+    vec4 object = objects[gl_InstanceIndex];
+    gl_Position = constants.viewProjection * vec4(object.xyz + position * object.w, 1.0);
+}
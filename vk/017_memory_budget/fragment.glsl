@@ -0,0 +1,26 @@
+#version 450
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) flat in uint inTexture;
+layout(location = 0) out vec4 outColor;
+
+// the texture streamer's images, textures without a resident level point at a grey placeholder
+// the index is the same for a whole draw, indexing with it needs shaderSampledImageArrayDynamicIndexing
+layout(set = 0, binding = 7) uniform sampler2D textures[16];
+
+const float pi = 3.14159265;
+
+void main() {
+    // the sphere's normal doubles as its position, which maps onto the texture like longitude and latitude
+    vec3 normal = normalize(inNormal);
+    vec2 uv = vec2(atan(normal.z, normal.x) / (2.0 * pi) + 0.5, acos(clamp(normal.y, -1.0, 1.0)) / pi);
+    vec3 albedo = texture(textures[inTexture], uv).rgb;
+    
+    // simple directional light so the spheres' shape is visible, tinted by the object's level of detail
+    // the scene is rendered to a floating point target, so the highlight can go well above 1 and feed the bloom
+    vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.6));
+    float diffuse = max(dot(normal, lightDirection), 0.0);
+    float highlight = pow(diffuse, 40.0) * 4.0;
+    outColor = vec4(albedo * inColor * (0.15 + 0.85 * diffuse) + highlight, 1);
+}
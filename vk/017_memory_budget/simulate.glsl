@@ -0,0 +1,44 @@
+#version 450
+
+// one invocation per object: moves the object back and forth along its own view ray, between nearestDistance and 30x as far
+// this used to run on the CPU, which wrote the results into a host visible buffer every frame.
+// on the GPU the objects never leave device memory, and the work runs on the compute queue next to the previous frame's graphics
+layout(local_size_x = 64) in;
+
+// the same block as in cull.glsl, only the simulation's inputs are used here
+layout(set = 0, binding = 0) uniform View {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint objectCount;
+    uint lodCount;
+    int vertexOffset;
+    float projectionScale;
+    float pixelThreshold;
+    float radius;
+    uint compact;
+    uint finestLod;
+    float time;
+    uint gridSize; // the objects form a gridSize x gridSize grid of view rays
+    float angularSpacing; // the angle between neighbouring rays
+    float nearestDistance;
+    float objectScale;
+    uint textureCount;
+} view;
+
+layout(std430, set = 0, binding = 1) writeonly buffer Objects { vec4 objects[]; }; // center.xyz, scale
+
+void main() {
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= view.gridSize * view.gridSize)
+        return;
+    
+    uint x = objectIndex % view.gridSize;
+    uint y = objectIndex / view.gridSize;
+    
+    float yaw = (float(x) - (view.gridSize - 1) * 0.5) * view.angularSpacing;
+    float pitch = (float(y) - (view.gridSize - 1) * 0.5) * view.angularSpacing;
+    vec3 direction = normalize(vec3(tan(yaw), tan(pitch), -1.0));
+    float distance = view.nearestDistance * (1.0 + 29.0 * (0.5 + 0.5 * sin(view.time * 2.0 + x * 0.7 + y * 1.3)));
+    
+    objects[objectIndex] = vec4(direction * distance, view.objectScale);
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cmath>
+
+// minimal vector/matrix math, just enough to place a camera in a 3D scene
+// matrices are column-major so they can be passed to GLSL as-is
+
+struct vec3
+{
+    float x = 0, y = 0, z = 0;
+
+    vec3() = default;
+    vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+    vec3 operator+(const vec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+    vec3 operator-(const vec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+    vec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+    vec3& operator+=(const vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+};
+
+inline float dot(const vec3& a, const vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline vec3 cross(const vec3& a, const vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline float length(const vec3& v) { return sqrtf(dot(v, v)); }
+
+// returns the zero vector for degenerate input rather than dividing by zero
+inline vec3 normalize(const vec3& v)
+{
+    float l = length(v);
+    return l > 0 ? v * (1.0f / l) : vec3 {};
+}
+
+struct vec4
+{
+    float x = 0, y = 0, z = 0, w = 0;
+};
+
+struct mat4
+{
+    float m[16] = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+
+    mat4 operator*(const mat4& o) const
+    {
+        mat4 result;
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                result.m[column * 4 + row] = m[0 * 4 + row] * o.m[column * 4 + 0] + m[1 * 4 + row] * o.m[column * 4 + 1] + m[2 * 4 + row] * o.m[column * 4 + 2] + m[3 * 4 + row] * o.m[column * 4 + 3];
+        return result;
+    }
+
+    vec4 row(int i) const { return { m[i], m[4 + i], m[8 + i], m[12 + i] }; }
+
+    // right handed perspective projection for vulkan's clip space:
+    // depth goes from 0 (near) to 1 (far) and y is flipped, so +y in view space points up on screen
+    static mat4 perspective(float fovY, float aspect, float zNear, float zFar)
+    {
+        float f = 1.0f / tanf(fovY * 0.5f);
+
+        mat4 result;
+        result.m[0] = f / aspect;
+        result.m[5] = -f;
+        result.m[10] = zFar / (zNear - zFar);
+        result.m[11] = -1;
+        result.m[14] = (zNear * zFar) / (zNear - zFar);
+        result.m[15] = 0;
+        return result;
+    }
+
+    // right handed view matrix looking from eye towards center
+    static mat4 lookAt(const vec3& eye, const vec3& center, const vec3& up)
+    {
+        vec3 f = normalize(center - eye);
+        vec3 s = normalize(cross(f, up));
+        vec3 u = cross(s, f);
+
+        mat4 result;
+        result.m[0] = s.x; result.m[4] = s.y; result.m[8] = s.z;
+        result.m[1] = u.x; result.m[5] = u.y; result.m[9] = u.z;
+        result.m[2] = -f.x; result.m[6] = -f.y; result.m[10] = -f.z;
+        result.m[12] = -dot(s, eye);
+        result.m[13] = -dot(u, eye);
+        result.m[14] = dot(f, eye);
+        return result;
+    }
+};
+
+// extract the 6 frustum planes (left, right, bottom, top, near, far) from a view projection matrix
+// each plane is stored as (normal.xyz, distance) with the normal pointing into the frustum,
+// so a sphere is outside of the frustum when dot(normal, center) + distance < -radius for any plane
+inline void frustumPlanes(const mat4& viewProjection, vec4 planes[6])
+{
+    vec4 r0 = viewProjection.row(0), r1 = viewProjection.row(1), r2 = viewProjection.row(2), r3 = viewProjection.row(3);
+
+    planes[0] = { r3.x + r0.x, r3.y + r0.y, r3.z + r0.z, r3.w + r0.w };
+    planes[1] = { r3.x - r0.x, r3.y - r0.y, r3.z - r0.z, r3.w - r0.w };
+    planes[2] = { r3.x + r1.x, r3.y + r1.y, r3.z + r1.z, r3.w + r1.w };
+    planes[3] = { r3.x - r1.x, r3.y - r1.y, r3.z - r1.z, r3.w - r1.w };
+    planes[4] = { r2.x, r2.y, r2.z, r2.w }; // depth range is 0-1, so the near plane is just the third row
+    planes[5] = { r3.x - r2.x, r3.y - r2.y, r3.z - r2.z, r3.w - r2.w };
+
+    for (int i = 0; i < 6; i++)
+    {
+        float l = length(vec3 { planes[i].x, planes[i].y, planes[i].z });
+        planes[i] = { planes[i].x / l, planes[i].y / l, planes[i].z / l, planes[i].w / l };
+    }
+}
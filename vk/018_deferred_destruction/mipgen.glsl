@@ -0,0 +1,18 @@
+#version 450
+
+// one invocation per texel of the level that's generated, for formats that can't be blitted
+// the source is a view of only the previous level, a bilinear sample right between the 2x2 texels it covers averages them
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+layout(set = 0, binding = 1, rgba8) uniform writeonly image2D destination;
+
+void main() {
+    ivec2 size = imageSize(destination);
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+    
+    vec2 uv = (vec2(texel) + 0.5) / vec2(size);
+    imageStore(destination, texel, textureLod(source, uv, 0.0));
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "preprocessor.hpp"
+#include "buffer.hpp"
+
+// a mesh is nothing more than a range inside of the geometry pool's buffers
+// vertexOffset is in vertices and firstIndex is in indices (of the mesh's index type)
+// so they can be passed to vkCmdDrawIndexed as-is
+struct Mesh
+{
+    int32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+};
+
+// a geometry pool stores all of its meshes in one large vertex buffer and one large index buffer
+// rather than giving every mesh its own pair of buffers.
+// the buffers only have to be bound once, after which every mesh is drawn by offsetting into them.
+// meshes with few enough vertices store their indices as 16 bit, which halves their index memory.
+// both index widths live in the same buffer, so at most one rebind is needed when the width changes.
+// a pool can live in host visible memory (meshes are copied in with add()) or in device local memory,
+// where reserve() only hands out the ranges and the data is uploaded by a transfer queue (see utils/uploader.hpp).
+class GeometryPool
+{
+public:
+    // all meshes in a pool share the same vertex layout, so the stride is fixed for the whole pool
+    GeometryPool(VkDevice device, VkPhysicalDevice physicalDevice, const QueueFamilies& families, uint32_t vertexStride, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity, bool deviceLocal = false)
+        : m_vertexStride(vertexStride)
+    {
+        // round the vertex capacity down to a whole number of vertices, that way every offset we hand out is a valid vertexOffset
+        vertexCapacity -= vertexCapacity % vertexStride;
+
+        if (deviceLocal)
+        {
+            // device local buffers are written by copies, and owned by one queue family at a time
+            m_vertexBuffer = Buffer::create(device, physicalDevice, families, vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+            m_indexBuffer = Buffer::create(device, physicalDevice, families, indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+            return;
+        }
+
+        // both buffers are host visible and stay mapped for the lifetime of the pool so meshes can be added at any time
+        m_vertexBuffer = Buffer::create(device, physicalDevice, families, vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        m_indexBuffer = Buffer::create(device, physicalDevice, families, indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        m_vertexBuffer->map();
+        m_indexBuffer->map();
+    }
+
+    // copy a mesh into the pool and return the ranges that describe it
+    // indices are relative to the mesh's first vertex, just like they would be with a dedicated buffer
+    Mesh add(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+    {
+        if (m_vertexBuffer->mapped == nullptr)
+            throw std::runtime_error("Meshes in a device local geometry pool have to be reserved and uploaded");
+
+        Mesh mesh = reserve(vertexCount, indexCount);
+        VkDeviceSize indexOffset = indexByteOffset(mesh);
+
+        memcpy(m_vertexBuffer->mapped + vertexByteOffset(mesh), vertices, static_cast<VkDeviceSize>(vertexCount) * m_vertexStride);
+
+        if (mesh.indexType == VK_INDEX_TYPE_UINT16)
+        {
+            uint16_t* dst = reinterpret_cast<uint16_t*>(m_indexBuffer->mapped + indexOffset);
+            for (uint32_t i = 0; i < indexCount; i++)
+                dst[i] = static_cast<uint16_t>(indices[i]);
+        }
+        else
+        {
+            memcpy(m_indexBuffer->mapped + indexOffset, indices, static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t));
+        }
+
+        return mesh;
+    }
+
+    // hand out the ranges for a mesh without writing anything to them
+    // the vertices go to vertexByteOffset() in vertexBuffer(), the indices (of mesh.indexType) to indexByteOffset() in indexBuffer()
+    Mesh reserve(uint32_t vertexCount, uint32_t indexCount)
+    {
+        Mesh mesh;
+        mesh.vertexCount = vertexCount;
+        mesh.indexCount = indexCount;
+
+        // 0xFFFF is reserved as the primitive restart value for 16 bit indices so we stay below it
+        mesh.indexType = vertexCount < 0xFFFF ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        VkDeviceSize indexSize = indexTypeSize(mesh.indexType);
+
+        // index buffer offsets must be a multiple of the index size
+        VkDeviceSize indexOffset = (m_indexOffset + indexSize - 1) & ~(indexSize - 1);
+        VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(vertexCount) * m_vertexStride;
+        VkDeviceSize indexBytes = static_cast<VkDeviceSize>(indexCount) * indexSize;
+
+        if (m_vertexOffset + vertexBytes > m_vertexBuffer->size || indexOffset + indexBytes > m_indexBuffer->size)
+            throw std::runtime_error("Geometry pool is out of memory");
+
+        // the index buffer is always bound at offset 0, so firstIndex is the byte offset in units of the index size
+        mesh.vertexOffset = static_cast<int32_t>(m_vertexOffset / m_vertexStride);
+        mesh.firstIndex = static_cast<uint32_t>(indexOffset / indexSize);
+
+        m_vertexOffset += vertexBytes;
+        m_indexOffset = indexOffset + indexBytes;
+
+        return mesh;
+    }
+
+    VkDeviceSize vertexByteOffset(const Mesh& mesh) const { return static_cast<VkDeviceSize>(mesh.vertexOffset) * m_vertexStride; }
+    VkDeviceSize indexByteOffset(const Mesh& mesh) const { return static_cast<VkDeviceSize>(mesh.firstIndex) * indexTypeSize(mesh.indexType); }
+    static VkDeviceSize indexTypeSize(VkIndexType indexType) { return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+    // bind the pool's vertex buffer, this only has to happen once per command buffer
+    void bind(VkCommandBuffer cmd)
+    {
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &m_vertexBuffer->buffer, &offset);
+        m_boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+    }
+
+    // draw a mesh from the pool, the index buffer is only rebound if the mesh uses a different index width than the previous draw
+    // sorting draws by index type therefore keeps the number of binds to (at most) two
+    void draw(VkCommandBuffer cmd, const Mesh& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0)
+    {
+        if (mesh.indexType != m_boundIndexType)
+        {
+            vkCmdBindIndexBuffer(cmd, m_indexBuffer->buffer, 0, mesh.indexType);
+            m_boundIndexType = mesh.indexType;
+        }
+
+        vkCmdDrawIndexed(cmd, mesh.indexCount, instanceCount, mesh.firstIndex, mesh.vertexOffset, firstInstance);
+    }
+
+    // the index buffer holds the indices of every mesh, for draws that aren't recorded through draw() such as indirect draws
+    VkBuffer indexBuffer() const { return m_indexBuffer->buffer; }
+    VkBuffer vertexBuffer() const { return m_vertexBuffer->buffer; }
+
+    VkDeviceSize vertexBytesUsed() const { return m_vertexOffset; }
+    VkDeviceSize indexBytesUsed() const { return m_indexOffset; }
+
+private:
+    std::unique_ptr<Buffer> m_vertexBuffer;
+    std::unique_ptr<Buffer> m_indexBuffer;
+
+    uint32_t m_vertexStride;
+    VkDeviceSize m_vertexOffset = 0;
+    VkDeviceSize m_indexOffset = 0;
+
+    VkIndexType m_boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+};
@@ -0,0 +1,312 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include "preprocessor.hpp"
+#include "image.hpp"
+#include "deletion_queue.hpp"
+
+// fills in the mip levels of images that only have their first level, on the GPU
+// every level is made from the previous one, with vkCmdBlitImage where the format supports linear blits and with a small
+// compute shader (mipgen.glsl) where it doesn't. levels depend on each other, so generating the mips of a single image is
+// a chain of copies with a barrier between every two of them. doing that image by image serializes all of those barriers,
+// so the images that were added during a frame are generated together: level 1 of all images, one barrier, level 2 of
+// all images, one barrier, and so on. the GPU only waits between levels, and a barrier covers every image at once.
+class MipGenerator
+{
+public:
+    // deletionQueue is the queue of the timeline the command buffers passed to record() are submitted to
+    // computeShader is mipgen.glsl, forceCompute uses it even for formats that can be blitted
+    MipGenerator(VkDevice device, VkPhysicalDevice physicalDevice, DeletionQueue& deletionQueue, VkShaderModule computeShader, bool forceCompute = false)
+        : m_device(device), m_physicalDevice(physicalDevice), m_deletionQueue(deletionQueue), m_forceCompute(forceCompute)
+    {
+        // the compute shader samples the previous level and stores to the next, one descriptor set per level it generates
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings {};
+        bindings[0] = VkDescriptorSetLayoutBinding { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+        bindings[1] = VkDescriptorSetLayoutBinding { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+        setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.pNext = nullptr;
+        setLayoutInfo.flags = 0;
+        setLayoutInfo.bindingCount = bindings.size();
+        setLayoutInfo.pBindings = bindings.data();
+        THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &m_setLayout));
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.pNext = nullptr;
+        pipelineLayoutInfo.flags = 0;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pPushConstantRanges = nullptr;
+        THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout));
+
+        VkComputePipelineCreateInfo pipelineInfo {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = nullptr;
+        pipelineInfo.flags = 0;
+        pipelineInfo.stage = VkPipelineShaderStageCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShader, "main", nullptr };
+        pipelineInfo.layout = m_pipelineLayout;
+        pipelineInfo.basePipelineHandle = nullptr;
+        pipelineInfo.basePipelineIndex = 0;
+        THROW_IF_FAILED(vkCreateComputePipelines(device, nullptr, 1, &pipelineInfo, nullptr, &m_pipeline));
+
+        // a bilinear sample exactly between 2x2 texels of the previous level is their average
+        VkSamplerCreateInfo samplerInfo {};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.pNext = nullptr;
+        samplerInfo.flags = 0;
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.mipLodBias = 0;
+        samplerInfo.anisotropyEnable = false;
+        samplerInfo.maxAnisotropy = 1;
+        samplerInfo.compareEnable = false;
+        samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerInfo.minLod = 0;
+        samplerInfo.maxLod = 0;
+        samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+        samplerInfo.unnormalizedCoordinates = false;
+        THROW_IF_FAILED(vkCreateSampler(device, &samplerInfo, nullptr, &m_sampler));
+    }
+
+    ~MipGenerator()
+    {
+        vkDestroySampler(m_device, m_sampler, nullptr);
+        vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+    }
+
+    MipGenerator(const MipGenerator&) = delete;
+    MipGenerator& operator=(const MipGenerator&) = delete;
+
+    // blits need the format to support them as source and destination, with linear filtering
+    bool blitSupported(VkFormat format) const
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
+        VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return !m_forceCompute && (properties.optimalTilingFeatures & required) == required;
+    }
+
+    // the compute shader stores rgba8, so it only covers 8 bit RGBA formats with storage image support
+    bool computeSupported(VkFormat format) const
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
+        return format == VK_FORMAT_R8G8B8A8_UNORM && (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+
+    bool supported(VkFormat format) const { return blitSupported(format) || computeSupported(format); }
+
+    // the usage images of the format need on top of sampling, images have to be created with it
+    VkImageUsageFlags usage(VkFormat format) const
+    {
+        if (blitSupported(format))
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        return VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+
+    // queue an image to have its levels generated by the next record()
+    // its first level has to be in SHADER_READ_ONLY_OPTIMAL and visible to the fragment shader, the way the uploader
+    // leaves uploaded levels. the other levels are overwritten
+    void add(Image* image)
+    {
+        if (image->mipLevels > 1)
+            m_queued.push_back(image);
+    }
+
+    // records the generation of all queued images, which end up in SHADER_READ_ONLY_OPTIMAL for the fragment shader
+    void record(VkCommandBuffer cmd)
+    {
+        if (m_queued.empty())
+            return;
+
+        std::vector<Image*> blits, dispatches;
+        for (Image* image : m_queued)
+            (blitSupported(image->format) ? blits : dispatches).push_back(image);
+        m_queued.clear();
+
+        if (!blits.empty())
+            recordBlits(cmd, blits);
+        if (!dispatches.empty())
+            recordDispatches(cmd, dispatches);
+
+        m_imagesGenerated += blits.size() + dispatches.size();
+    }
+
+    // how many images got their levels generated, and how many vkCmdPipelineBarrier calls that took
+    uint32_t imagesGenerated() const { return m_imagesGenerated; }
+    uint32_t barrierCalls() const { return m_barrierCalls; }
+
+private:
+    static uint32_t maxLevels(const std::vector<Image*>& images)
+    {
+        uint32_t levels = 0;
+        for (Image* image : images)
+            levels = std::max(levels, image->mipLevels);
+        return levels;
+    }
+
+    // level n - 1 becomes the blit source and level n the destination, the source was written by the previous blit
+    // (or, for the first level, acquired for the fragment shader by the uploader)
+    void recordBlits(VkCommandBuffer cmd, const std::vector<Image*>& images)
+    {
+        uint32_t levels = maxLevels(images);
+        for (uint32_t level = 1; level < levels; level++)
+        {
+            std::vector<VkImageMemoryBarrier> barriers;
+            for (Image* image : images)
+            {
+                if (level >= image->mipLevels)
+                    continue;
+
+                VkAccessFlags srcAccess = level == 1 ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+                barriers.push_back(image->transition(level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srcAccess, VK_ACCESS_TRANSFER_READ_BIT));
+                barriers.push_back(image->transition(level, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT));
+            }
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, barriers.size(), barriers.data());
+            m_barrierCalls++;
+
+            for (Image* image : images)
+            {
+                if (level >= image->mipLevels)
+                    continue;
+
+                VkExtent2D src = image->mipExtent(level - 1), dst = image->mipExtent(level);
+                VkImageBlit blit {};
+                blit.srcSubresource = VkImageSubresourceLayers { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+                blit.srcOffsets[1] = VkOffset3D { static_cast<int32_t>(src.width), static_cast<int32_t>(src.height), 1 };
+                blit.dstSubresource = VkImageSubresourceLayers { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+                blit.dstOffsets[1] = VkOffset3D { static_cast<int32_t>(dst.width), static_cast<int32_t>(dst.height), 1 };
+                vkCmdBlitImage(cmd, image->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+            }
+        }
+
+        // all levels but the last were a source, the last one only a destination
+        std::vector<VkImageMemoryBarrier> barriers;
+        for (Image* image : images)
+        {
+            uint32_t last = image->mipLevels - 1;
+            barriers.push_back(image->transition(0, last, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT));
+            barriers.push_back(image->transition(last, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, barriers.size(), barriers.data());
+        m_barrierCalls++;
+    }
+
+    // the same chain with a dispatch per level: the previous level is sampled and the next one written as a storage image
+    void recordDispatches(VkCommandBuffer cmd, const std::vector<Image*>& images)
+    {
+        uint32_t setCount = 0;
+        for (Image* image : images)
+            setCount += image->mipLevels - 1;
+
+        // the sets are only used by this command buffer, so the pool is handed to the deletion queue straight away
+        std::array<VkDescriptorPoolSize, 2> poolSizes {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, setCount }
+        };
+
+        VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.pNext = nullptr;
+        descriptorPoolInfo.flags = 0;
+        descriptorPoolInfo.maxSets = setCount;
+        descriptorPoolInfo.poolSizeCount = poolSizes.size();
+        descriptorPoolInfo.pPoolSizes = poolSizes.data();
+
+        VkDescriptorPool pool;
+        THROW_IF_FAILED(vkCreateDescriptorPool(m_device, &descriptorPoolInfo, nullptr, &pool));
+        m_deletionQueue.destroy(pool);
+
+        VkDescriptorSetAllocateInfo setAllocInfo {};
+        setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setAllocInfo.pNext = nullptr;
+        setAllocInfo.descriptorPool = pool;
+        setAllocInfo.descriptorSetCount = 1;
+        setAllocInfo.pSetLayouts = &m_setLayout;
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+
+        uint32_t levels = maxLevels(images);
+        for (uint32_t level = 1; level < levels; level++)
+        {
+            // the first level stays in its layout but has to become visible to the compute shader as well
+            std::vector<VkImageMemoryBarrier> barriers;
+            for (Image* image : images)
+            {
+                if (level >= image->mipLevels)
+                    continue;
+
+                VkAccessFlags srcAccess = level == 1 ? 0 : VK_ACCESS_SHADER_WRITE_BIT;
+                barriers.push_back(image->transition(level - 1, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, srcAccess, VK_ACCESS_SHADER_READ_BIT));
+                barriers.push_back(image->transition(level, 1, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT));
+            }
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, barriers.size(), barriers.data());
+            m_barrierCalls++;
+
+            for (Image* image : images)
+            {
+                if (level >= image->mipLevels)
+                    continue;
+
+                VkDescriptorSet set;
+                THROW_IF_FAILED(vkAllocateDescriptorSets(m_device, &setAllocInfo, &set));
+
+                VkDescriptorImageInfo source { m_sampler, image->mipView(level - 1), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+                VkDescriptorImageInfo destination { VK_NULL_HANDLE, image->mipView(level), VK_IMAGE_LAYOUT_GENERAL };
+
+                std::array<VkWriteDescriptorSet, 2> writes {};
+                for (uint32_t i = 0; i < writes.size(); i++)
+                {
+                    writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    writes[i].pNext = nullptr;
+                    writes[i].dstSet = set;
+                    writes[i].dstBinding = i;
+                    writes[i].dstArrayElement = 0;
+                    writes[i].descriptorCount = 1;
+                    writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                    writes[i].pImageInfo = i == 0 ? &source : &destination;
+                }
+                vkUpdateDescriptorSets(m_device, writes.size(), writes.data(), 0, nullptr);
+
+                VkExtent2D extent = image->mipExtent(level);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &set, 0, nullptr);
+                vkCmdDispatch(cmd, (extent.width + 7) / 8, (extent.height + 7) / 8, 1);
+            }
+        }
+
+        // the last level was only written, the others are already in their layout but were only made visible to compute
+        std::vector<VkImageMemoryBarrier> barriers;
+        for (Image* image : images)
+        {
+            uint32_t last = image->mipLevels - 1;
+            barriers.push_back(image->transition(0, last, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT));
+            barriers.push_back(image->transition(last, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, barriers.size(), barriers.data());
+        m_barrierCalls++;
+    }
+
+    VkDevice m_device;
+    VkPhysicalDevice m_physicalDevice;
+    DeletionQueue& m_deletionQueue;
+    bool m_forceCompute;
+
+    VkDescriptorSetLayout m_setLayout;
+    VkPipelineLayout m_pipelineLayout;
+    VkPipeline m_pipeline;
+    VkSampler m_sampler;
+
+    std::vector<Image*> m_queued;
+    uint32_t m_imagesGenerated = 0, m_barrierCalls = 0;
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <memory>
+#include <functional>
+#include "preprocessor.hpp"
+#include "timeline.hpp"
+
+// destroys Vulkan objects once the GPU is done with them, without waiting for it
+// an object can't be destroyed while a submitted command buffer still uses it. at shutdown vkDeviceWaitIdle takes care of
+// that, but waiting for the whole device while the application runs stalls every queue just to free a single object.
+// instead, destroying an object queues it together with the timeline value of the frame that's being recorded, the last
+// frame that can use it. update() polls the timeline once per frame and destroys everything whose value has been reached.
+// objects are destroyed in the order they were queued, so an image queued before its memory is destroyed before it's freed.
+// besides plain handles, the queue can take ownership of wrapper objects (Image, Buffer, ...) and of callbacks that have to
+// run once the objects queued before them are gone
+class DeletionQueue
+{
+public:
+    // timeline is the queue the objects are used on, usually the graphics queue
+    DeletionQueue(VkDevice device, const Timeline& timeline) : m_device(device), m_timeline(timeline) {}
+
+    ~DeletionQueue()
+    {
+        flush();
+    }
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    // non-dispatchable handles are all 64 bits, so they share a single field and the type says which vkDestroy* to call
+    void destroy(VkBuffer buffer) { push(VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(buffer)); }
+    void destroy(VkImage image) { push(VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(image)); }
+    void destroy(VkImageView view) { push(VK_OBJECT_TYPE_IMAGE_VIEW, reinterpret_cast<uint64_t>(view)); }
+    void destroy(VkDeviceMemory memory) { push(VK_OBJECT_TYPE_DEVICE_MEMORY, reinterpret_cast<uint64_t>(memory)); }
+    void destroy(VkSampler sampler) { push(VK_OBJECT_TYPE_SAMPLER, reinterpret_cast<uint64_t>(sampler)); }
+    void destroy(VkPipeline pipeline) { push(VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(pipeline)); }
+    void destroy(VkPipelineLayout layout) { push(VK_OBJECT_TYPE_PIPELINE_LAYOUT, reinterpret_cast<uint64_t>(layout)); }
+    void destroy(VkShaderModule module) { push(VK_OBJECT_TYPE_SHADER_MODULE, reinterpret_cast<uint64_t>(module)); }
+    void destroy(VkDescriptorPool pool) { push(VK_OBJECT_TYPE_DESCRIPTOR_POOL, reinterpret_cast<uint64_t>(pool)); }
+    void destroy(VkDescriptorSetLayout layout) { push(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, reinterpret_cast<uint64_t>(layout)); }
+    void destroy(VkFramebuffer framebuffer) { push(VK_OBJECT_TYPE_FRAMEBUFFER, reinterpret_cast<uint64_t>(framebuffer)); }
+    void destroy(VkRenderPass renderpass) { push(VK_OBJECT_TYPE_RENDER_PASS, reinterpret_cast<uint64_t>(renderpass)); }
+
+    // wrappers destroy their objects in their destructor, the queue keeps them alive until then
+    template<typename T>
+    void destroy(std::unique_ptr<T> object)
+    {
+        if (!object)
+            return;
+
+        Entry entry = makeEntry(VK_OBJECT_TYPE_UNKNOWN, 0);
+        entry.object = std::shared_ptr<T>(std::move(object));
+        m_entries.push_back(std::move(entry));
+    }
+
+    // runs callback after everything queued before it was destroyed, e.g. to report the memory of an image as freed
+    void then(std::function<void()> callback)
+    {
+        Entry entry = makeEntry(VK_OBJECT_TYPE_UNKNOWN, 0);
+        entry.callback = std::move(callback);
+        m_entries.push_back(std::move(entry));
+    }
+
+    // called once per frame, polling never blocks
+    void update()
+    {
+        if (m_entries.empty())
+            return;
+
+        uint64_t completed = m_timeline.completed();
+        while (!m_entries.empty() && m_entries.front().value <= completed)
+        {
+            release(m_entries.front());
+            m_entries.pop_front();
+        }
+    }
+
+    // destroys everything right away, only after the device is idle (vkDeviceWaitIdle at shutdown)
+    void flush()
+    {
+        while (!m_entries.empty())
+        {
+            release(m_entries.front());
+            m_entries.pop_front();
+        }
+    }
+
+    size_t pending() const { return m_entries.size(); }
+    uint64_t destroyed() const { return m_destroyed; }
+
+private:
+    // value is the timeline value after which nothing uses the object anymore
+    // exactly one of handle, object or callback is set
+    struct Entry
+    {
+        uint64_t value;
+        VkObjectType type;
+        uint64_t handle;
+        std::shared_ptr<void> object;
+        std::function<void()> callback;
+    };
+
+    // the frame that's being recorded is the last one that can use the object
+    Entry makeEntry(VkObjectType type, uint64_t handle) const
+    {
+        return Entry { m_timeline.submitted() + 1, type, handle, nullptr, nullptr };
+    }
+
+    void push(VkObjectType type, uint64_t handle)
+    {
+        if (handle != 0)
+            m_entries.push_back(makeEntry(type, handle));
+    }
+
+    void release(Entry& entry)
+    {
+        switch (entry.type)
+        {
+        case VK_OBJECT_TYPE_BUFFER: vkDestroyBuffer(m_device, reinterpret_cast<VkBuffer>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_IMAGE: vkDestroyImage(m_device, reinterpret_cast<VkImage>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_IMAGE_VIEW: vkDestroyImageView(m_device, reinterpret_cast<VkImageView>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_DEVICE_MEMORY: vkFreeMemory(m_device, reinterpret_cast<VkDeviceMemory>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_SAMPLER: vkDestroySampler(m_device, reinterpret_cast<VkSampler>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_PIPELINE: vkDestroyPipeline(m_device, reinterpret_cast<VkPipeline>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_PIPELINE_LAYOUT: vkDestroyPipelineLayout(m_device, reinterpret_cast<VkPipelineLayout>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_SHADER_MODULE: vkDestroyShaderModule(m_device, reinterpret_cast<VkShaderModule>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_DESCRIPTOR_POOL: vkDestroyDescriptorPool(m_device, reinterpret_cast<VkDescriptorPool>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT: vkDestroyDescriptorSetLayout(m_device, reinterpret_cast<VkDescriptorSetLayout>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_FRAMEBUFFER: vkDestroyFramebuffer(m_device, reinterpret_cast<VkFramebuffer>(entry.handle), nullptr); break;
+        case VK_OBJECT_TYPE_RENDER_PASS: vkDestroyRenderPass(m_device, reinterpret_cast<VkRenderPass>(entry.handle), nullptr); break;
+        default: break;
+        }
+
+        // dropping the last reference runs the wrapper's destructor
+        entry.object.reset();
+        if (entry.callback)
+            entry.callback();
+        m_destroyed++;
+    }
+
+    VkDevice m_device;
+    const Timeline& m_timeline;
+
+    // values only go up, so the entries are sorted by value and the ones that can be destroyed are always at the front
+    std::deque<Entry> m_entries;
+    uint64_t m_destroyed = 0;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "preprocessor.hpp"
+#include "memory.hpp"
+
+// wrapper around a depth image, its memory and its view
+// the depth buffer is only ever used within a renderpass: it's cleared on load and its contents are discarded on store.
+// that makes it a transient attachment, which tiled GPUs can keep in on-chip memory for the whole renderpass.
+// on those GPUs lazily allocated memory is only committed if the image ever has to leave tile memory, which for us is never.
+class DepthBuffer
+{
+public:
+    DepthBuffer() = default;
+    ~DepthBuffer() {
+        vkDestroyImageView(m_device, view, nullptr);
+        vkDestroyImage(m_device, image, nullptr);
+        vkFreeMemory(m_device, memory, nullptr);
+    }
+
+    // pick the most precise depth format the device can render to
+    static VkFormat selectFormat(VkPhysicalDevice physicalDevice)
+    {
+        for (VkFormat format : { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM })
+        {
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+            if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) != 0)
+                return format;
+        }
+
+        throw std::runtime_error("No supported depth format");
+    }
+
+    static std::unique_ptr<DepthBuffer> create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkExtent2D extent)
+    {
+        std::unique_ptr<DepthBuffer> result = std::make_unique<DepthBuffer>();
+        result->m_device = device;
+        result->format = format;
+
+        // the transient usage tells the driver the contents never have to outlive a renderpass
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.pNext = nullptr;
+        imageInfo.flags = 0;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = VkExtent3D { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.queueFamilyIndexCount = 0;
+        imageInfo.pQueueFamilyIndices = nullptr;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        THROW_IF_FAILED(vkCreateImage(device, &imageInfo, nullptr, &result->image));
+
+        // prefer lazily allocated memory, desktop GPUs usually don't have any so we fall back to regular device local memory
+        VkMemoryRequirements memoryReqs;
+        vkGetImageMemoryRequirements(device, result->image, &memoryReqs);
+        int32_t index = Memory::find(physicalDevice, memoryReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+        result->lazilyAllocated = index != -1;
+        if (index == -1)
+            index = Memory::select(physicalDevice, memoryReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkMemoryAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.pNext = nullptr;
+        allocInfo.allocationSize = memoryReqs.size;
+        allocInfo.memoryTypeIndex = index;
+
+        THROW_IF_FAILED(vkAllocateMemory(device, &allocInfo, nullptr, &result->memory));
+        THROW_IF_FAILED(vkBindImageMemory(device, result->image, result->memory, 0));
+
+        VkImageViewCreateInfo viewInfo {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.pNext = nullptr;
+        viewInfo.flags = 0;
+        viewInfo.image = result->image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.components = VkComponentMapping { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+        viewInfo.subresourceRange = VkImageSubresourceRange { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+        THROW_IF_FAILED(vkCreateImageView(device, &viewInfo, nullptr, &result->view));
+
+        return std::move(result);
+    }
+
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;
+    VkFormat format;
+    bool lazilyAllocated = false;
+
+private:
+
+    VkDevice m_device;
+};
@@ -0,0 +1,127 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// one invocation per object, after simulate.glsl moved the objects: objects outside of the view frustum are culled,
+// visible objects pick their level of detail from the projected error of each level
+// and append an indirect draw command for that level's index range
+layout(local_size_x = 64) in;
+
+// matches LodLevel in utils/lod.hpp, firstIndex already includes the mesh's offset in the geometry pool
+struct LodLevel {
+    uint firstIndex;
+    uint indexCount;
+    float error;
+    uint padding;
+};
+
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+    uint viewBuffer; // the index of the frame's view in the bindless buffers
+} constants;
+
+// the frame's view is a storage buffer in the bindless array, it holds the indices of all other resources of the frame
+// every shader declares the whole block, even the members it doesn't use, so the offsets match
+layout(std430, set = 0, binding = 1) readonly buffer Views {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint objectCount;
+    uint lodCount;
+    int vertexOffset;
+    float projectionScale; // viewport height / (2 * tan(fovY / 2))
+    float pixelThreshold;
+    float radius; // bounding sphere radius of the mesh
+    uint compact; // 0 if every object keeps its own draw command, for devices without VK_KHR_draw_indirect_count
+    uint finestLod; // the most detailed level that's resident, finer levels are still being uploaded
+    float time; // the simulation's inputs, see simulate.glsl
+    uint gridSize;
+    float angularSpacing;
+    float nearestDistance;
+    float objectScale;
+    uint textureCount; // objects use the textures round robin
+    uint objectBuffer; // the indices of the frame's buffers in the bindless array
+    uint lodBuffer;
+    uint drawCommandBuffer;
+    uint drawCountBuffer;
+    uint objectLodBuffer;
+    uint textureSizeBuffer;
+    uint textures[16]; // the indices of the textures in the bindless textures, for the fragment shader
+} views[];
+
+// the view's index is the same for the whole dispatch, so indexing with it only needs dynamic indexing
+#define view views[constants.viewBuffer]
+
+// all storage buffers are in the same bindless array, every type of buffer declares the array with its own contents
+layout(std430, set = 0, binding = 1) readonly buffer Objects { vec4 objects[]; } objectBuffers[]; // center.xyz, scale
+layout(std430, set = 0, binding = 1) readonly buffer Lods { LodLevel lods[]; } lodBuffers[];
+layout(std430, set = 0, binding = 1) writeonly buffer DrawCommands { DrawCommand draws[]; } drawCommandBuffers[];
+layout(std430, set = 0, binding = 1) buffer DrawCount { uint drawCount; } drawCountBuffers[];
+layout(std430, set = 0, binding = 1) writeonly buffer ObjectLods { uint lods[]; } objectLodBuffers[]; // ~0u for culled objects
+layout(std430, set = 0, binding = 1) buffer TextureSizes { uint sizes[]; } textureSizeBuffers[]; // read back by the texture streamer
+
+// the same function as selectLod() in utils/lod.hpp, starting at the finest resident level
+uint selectLod(vec3 center, float radius, float scale) {
+    float distance = max(length(center - view.cameraPosition.xyz) - radius, 0.001);
+    
+    uint lod = view.finestLod;
+    for (uint i = lod + 1; i < view.lodCount; i++) {
+        float projectedError = lodBuffers[view.lodBuffer].lods[i].error * scale * view.projectionScale / distance;
+        if (projectedError > view.pixelThreshold)
+            break;
+        
+        lod = i;
+    }
+    
+    return lod;
+}
+
+void main() {
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= view.objectCount)
+        return;
+    
+    vec4 object = objectBuffers[view.objectBuffer].objects[objectIndex];
+    float radius = view.radius * object.w;
+    
+    bool visible = true;
+    for (int i = 0; i < 6; i++) {
+        if (dot(view.frustum[i].xyz, object.xyz) + view.frustum[i].w < -radius)
+            visible = false;
+    }
+    
+    uint lod = visible ? selectLod(object.xyz, radius, object.w) : 0;
+    objectLodBuffers[view.objectLodBuffer].lods[objectIndex] = visible ? lod : ~0u;
+    
+    // fragment.glsl wraps the texture's width around the sphere's circumference, so in the middle of the sphere a pixel
+    // covers width / (pi * diameter) texels. the streamer wants the width at which that's one texel per pixel, the
+    // largest of all objects that use the texture
+    if (visible) {
+        float distance = max(length(object.xyz - view.cameraPosition.xyz) - radius, 0.001);
+        float diameter = 2.0 * radius * view.projectionScale / distance;
+        atomicMax(textureSizeBuffers[view.textureSizeBuffer].sizes[objectIndex % view.textureCount], uint(diameter * 3.14159265));
+    }
+    
+    // the object index goes into firstInstance, so the vertex shader can find the object through gl_InstanceIndex
+    DrawCommand draw;
+    draw.indexCount = lodBuffers[view.lodBuffer].lods[lod].indexCount;
+    draw.instanceCount = visible ? 1 : 0;
+    draw.firstIndex = lodBuffers[view.lodBuffer].lods[lod].firstIndex;
+    draw.vertexOffset = view.vertexOffset;
+    draw.firstInstance = objectIndex;
+    
+    if (view.compact != 0) {
+        // only visible objects get a draw command, the draw count is read by vkCmdDrawIndexedIndirectCountKHR
+        if (visible)
+            drawCommandBuffers[view.drawCommandBuffer].draws[atomicAdd(drawCountBuffers[view.drawCountBuffer].drawCount, 1)] = draw;
+    } else {
+        // without a GPU draw count, culled objects become draws with 0 instances
+        drawCommandBuffers[view.drawCommandBuffer].draws[objectIndex] = draw;
+    }
+}
@@ -0,0 +1,48 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// the depth prepass only needs positions: no normals, no colors and no fragment shader
+layout(location = 0) in vec3 position;
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+    uint viewBuffer; // the index of the frame's view in the bindless buffers
+} constants;
+
+// the same block as in cull.glsl, only the index of the objects is used here
+layout(std430, set = 0, binding = 1) readonly buffer Views {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint objectCount;
+    uint lodCount;
+    int vertexOffset;
+    float projectionScale;
+    float pixelThreshold;
+    float radius;
+    uint compact;
+    uint finestLod;
+    float time;
+    uint gridSize;
+    float angularSpacing;
+    float nearestDistance;
+    float objectScale;
+    uint textureCount;
+    uint objectBuffer;
+    uint lodBuffer;
+    uint drawCommandBuffer;
+    uint drawCountBuffer;
+    uint objectLodBuffer;
+    uint textureSizeBuffer;
+    uint textures[16];
+} views[];
+#define view views[constants.viewBuffer]
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects { vec4 objects[]; } objectBuffers[]; // center.xyz, scale
+
+// must match vertex.glsl exactly, so the color pass's EQUAL depth test passes for the visible surfaces
+invariant gl_Position;
+
+void main() {
+    vec4 object = objectBuffers[view.objectBuffer].objects[gl_InstanceIndex];
+    gl_Position = constants.viewProjection * vec4(object.xyz + position * object.w, 1.0);
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <memory>
+#include "preprocessor.hpp"
+#include "queue_families.hpp"
+#include "timeline.hpp"
+
+// records and submits a frame's compute work (simulation, culling) to its own queue, ahead of the frame's graphics work
+// on a dedicated compute family (async compute) the compute queue runs while the graphics queue is still busy with
+// the previous frame, and fills the gaps the raster pipeline leaves: fixed function work, small draws, waiting on the ROPs.
+// the results are handed to the graphics queue in two halves:
+// - the compute submit signals the scheduler's timeline, the graphics submit waits on that value (the semaphore)
+// - the buffers are exclusive, so with separate families the compute queue releases them and the graphics queue acquires
+//   them (queue family ownership transfers). on a single family the acquire is a regular barrier
+// buffers are rewritten from scratch every frame, so nothing is handed back to compute: a queue family may take over an
+// exclusive buffer without an ownership transfer as long as it doesn't care about the buffer's contents.
+class ComputeScheduler
+{
+public:
+    // a buffer the compute work wrote, and how the graphics queue uses it afterwards
+    struct Handover
+    {
+        VkBuffer buffer;
+        VkPipelineStageFlags srcStages;
+        VkAccessFlags srcAccess;
+        VkPipelineStageFlags dstStages;
+        VkAccessFlags dstAccess;
+    };
+
+    // computeQueue is a queue of computeFamily, which is the graphics family itself when async compute isn't available
+    // every frame in flight gets its own command buffer, like the graphics command buffers
+    ComputeScheduler(VkDevice device, const QueueFamilies& families, VkQueue computeQueue, uint32_t computeFamily, uint32_t framesInFlight)
+        : m_device(device), m_computeFamily(computeFamily), m_graphicsFamily(static_cast<uint32_t>(families.graphics)), m_values(framesInFlight, 0)
+    {
+        m_timeline = std::make_unique<Timeline>(device, computeQueue);
+
+        VkCommandPoolCreateInfo commandPoolInfo {};
+        commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolInfo.pNext = nullptr;
+        commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        commandPoolInfo.queueFamilyIndex = computeFamily;
+        THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &m_commandPool));
+
+        VkCommandBufferAllocateInfo cmdAllocInfo {};
+        cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdAllocInfo.pNext = nullptr;
+        cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmdAllocInfo.commandBufferCount = framesInFlight;
+        cmdAllocInfo.commandPool = m_commandPool;
+
+        m_commandBuffers.resize(framesInFlight);
+        THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, m_commandBuffers.data()));
+    }
+
+    ~ComputeScheduler()
+    {
+        m_timeline->waitIdle();
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+    }
+
+    ComputeScheduler(const ComputeScheduler&) = delete;
+    ComputeScheduler& operator=(const ComputeScheduler&) = delete;
+
+    // start recording the compute work of a frame in flight
+    // the slot's previous compute submit was waited on by a graphics frame the caller already waited for, so this rarely blocks
+    VkCommandBuffer begin(uint32_t slot)
+    {
+        m_slot = slot;
+        m_timeline->wait(m_values[slot]);
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(m_commandBuffers[slot], &beginInfo);
+
+        return m_commandBuffers[slot];
+    }
+
+    // hand a buffer the recorded work wrote over to the graphics queue
+    void handOver(const Handover& handover)
+    {
+        m_handovers.push_back(handover);
+    }
+
+    // end recording and submit after the given waits, e.g. the graphics frame that last used this slot's buffers
+    // with separate families the buffers are released at the end of the command buffer
+    uint64_t submit(const std::vector<Timeline::Wait>& waits = {})
+    {
+        VkCommandBuffer cmd = m_commandBuffers[m_slot];
+
+        if (async() && !m_handovers.empty())
+        {
+            // the release half of the ownership transfer, its destination stages and access are ignored
+            std::vector<VkBufferMemoryBarrier> releases;
+            VkPipelineStageFlags srcStages = 0;
+            for (const Handover& handover : m_handovers)
+            {
+                releases.push_back(barrier(handover, handover.srcAccess, 0));
+                srcStages |= handover.srcStages;
+            }
+
+            vkCmdPipelineBarrier(cmd, srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, releases.size(), releases.data(), 0, nullptr);
+        }
+
+        vkEndCommandBuffer(cmd);
+
+        m_values[m_slot] = m_timeline->submit({ cmd }, waits);
+        return m_values[m_slot];
+    }
+
+    // record the acquire half of the last submit's handovers at the start of a graphics command buffer
+    // the returned wait has to be passed to that command buffer's submit, it's what orders the acquire after the release
+    Timeline::Wait acquire(VkCommandBuffer graphicsCmd)
+    {
+        std::vector<VkBufferMemoryBarrier> acquires;
+        VkPipelineStageFlags srcStages = 0, dstStages = 0;
+        for (const Handover& handover : m_handovers)
+        {
+            // across families the source half was done by the release, on one family this is an ordinary barrier
+            acquires.push_back(barrier(handover, async() ? 0 : handover.srcAccess, handover.dstAccess));
+            srcStages |= async() ? 0 : handover.srcStages;
+            dstStages |= handover.dstStages;
+        }
+
+        // across families the timeline wait below is what orders the acquire after the release, and a wait only orders
+        // the stages it blocks, so the acquire has to start from those same stages for the two to chain
+        if (async())
+            srcStages = dstStages;
+
+        if (!acquires.empty())
+            vkCmdPipelineBarrier(graphicsCmd, srcStages, dstStages, 0, 0, nullptr, acquires.size(), acquires.data(), 0, nullptr);
+
+        m_handovers.clear();
+        return m_timeline->waitFor(m_values[m_slot], dstStages != 0 ? dstStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    }
+
+    // async compute only happens when the work runs on a different family than graphics
+    bool async() const { return m_computeFamily != m_graphicsFamily; }
+
+    const Timeline& timeline() const { return *m_timeline; }
+
+private:
+    VkBufferMemoryBarrier barrier(const Handover& handover, VkAccessFlags srcAccess, VkAccessFlags dstAccess) const
+    {
+        VkBufferMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.pNext = nullptr;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = async() ? m_computeFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = async() ? m_graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = handover.buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        return barrier;
+    }
+
+    VkDevice m_device;
+    VkCommandPool m_commandPool;
+    std::unique_ptr<Timeline> m_timeline;
+    uint32_t m_computeFamily, m_graphicsFamily;
+
+    std::vector<VkCommandBuffer> m_commandBuffers;
+    std::vector<uint64_t> m_values;
+    std::vector<Handover> m_handovers;
+    uint32_t m_slot = 0;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "preprocessor.hpp"
+
+// hands out descriptor sets from a chain of descriptor pools, and adds a pool to the chain whenever the last one runs out
+// a single descriptor pool has to be sized up front for every set that's ever allocated from it, which means counting the
+// descriptors of every set in the application, and freeing sets one by one fragments the pool. most sets only live for a
+// frame though: they're written, bound and never used again once the frame has finished. the allocator is made for those:
+// - allocating tries the pool it used last, and only moves on to the next pool (or creates one) once that's exhausted
+// - sets are never freed one by one, reset() returns all of them at once with vkResetDescriptorPool
+// - reset() keeps the pools, so once the chain is large enough for a frame, allocating never creates a pool again
+// with one allocator per frame in flight that's reset after waiting for its frame, a set costs about as much as bumping
+// a pointer, and updating the resources a draw uses is allocating a new set instead of waiting until the old one is unused.
+class DescriptorAllocator
+{
+public:
+    // ratios are the number of descriptors of every type per set, every pool holds setsPerPool times as many
+    // the ratios don't have to be exact, a pool that runs out of a descriptor type early is simply followed by the next one
+    DescriptorAllocator(VkDevice device, std::vector<VkDescriptorPoolSize> ratios, uint32_t setsPerPool = 64)
+        : m_device(device), m_ratios(std::move(ratios)), m_setsPerPool(setsPerPool)
+    {
+    }
+
+    ~DescriptorAllocator()
+    {
+        // destroying a pool frees the sets allocated from it
+        for (VkDescriptorPool pool : m_pools)
+            vkDestroyDescriptorPool(m_device, pool, nullptr);
+    }
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout)
+    {
+        VkDescriptorSetAllocateInfo setAllocInfo {};
+        setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setAllocInfo.pNext = nullptr;
+        setAllocInfo.descriptorSetCount = 1;
+        setAllocInfo.pSetLayouts = &layout;
+
+        // an exhausted pool stays exhausted until the next reset, so the pools before m_current aren't tried again
+        while (true)
+        {
+            bool created = m_current == m_pools.size();
+            if (created)
+                m_pools.push_back(createPool());
+
+            setAllocInfo.descriptorPool = m_pools[m_current];
+
+            VkDescriptorSet set;
+            VkResult result = vkAllocateDescriptorSets(m_device, &setAllocInfo, &set);
+            if (result == VK_SUCCESS)
+            {
+                m_allocated++;
+                return set;
+            }
+
+            // both mean the pool can't hold the set, any other error is a real one
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+                THROW_IF_FAILED(result);
+
+            // a set that doesn't even fit in an empty pool never will, the ratios are too small for its layout
+            if (created)
+                throw std::runtime_error("descriptor set doesn't fit in an empty pool");
+
+            m_current++;
+        }
+    }
+
+    // returns every set to its pool, only once the GPU is done with all of them
+    void reset()
+    {
+        for (size_t i = 0; i <= m_current && i < m_pools.size(); i++)
+            THROW_IF_FAILED(vkResetDescriptorPool(m_device, m_pools[i], 0));
+
+        m_peak = std::max(m_peak, m_allocated);
+        m_allocated = 0;
+        m_current = 0;
+    }
+
+    // sets allocated since the last reset, the most that were allocated between two resets, and the pools in the chain
+    uint32_t allocated() const { return m_allocated; }
+    uint32_t peak() const { return std::max(m_peak, m_allocated); }
+    uint32_t poolCount() const { return static_cast<uint32_t>(m_pools.size()); }
+
+private:
+    // every pool is twice the size of the previous one, so a frame that needs a lot of sets only creates a few pools
+    VkDescriptorPool createPool()
+    {
+        uint32_t sets = m_setsPerPool << std::min<size_t>(m_pools.size(), 6);
+
+        std::vector<VkDescriptorPoolSize> poolSizes(m_ratios);
+        for (VkDescriptorPoolSize& size : poolSizes)
+            size.descriptorCount *= sets;
+
+        VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.pNext = nullptr;
+        descriptorPoolInfo.flags = 0;
+        descriptorPoolInfo.maxSets = sets;
+        descriptorPoolInfo.poolSizeCount = poolSizes.size();
+        descriptorPoolInfo.pPoolSizes = poolSizes.data();
+
+        VkDescriptorPool pool;
+        THROW_IF_FAILED(vkCreateDescriptorPool(m_device, &descriptorPoolInfo, nullptr, &pool));
+        return pool;
+    }
+
+    VkDevice m_device;
+    std::vector<VkDescriptorPoolSize> m_ratios;
+    uint32_t m_setsPerPool;
+
+    // m_current is the pool sets are allocated from, the ones after it are empty
+    std::vector<VkDescriptorPool> m_pools;
+    size_t m_current = 0;
+    uint32_t m_allocated = 0, m_peak = 0;
+};
@@ -0,0 +1,67 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) flat out uint fragTexture; // an index into the bindless textures
+
+// the depth prepass computes the exact same position, invariant guarantees both produce the exact same depth
+// without it the EQUAL depth test of the color pass could fail on rounding differences
+invariant gl_Position;
+
+layout(push_constant) uniform Constants {
+    mat4 viewProjection;
+    uint viewBuffer; // the index of the frame's view in the bindless buffers
+} constants;
+
+// the same block as in cull.glsl, the vertex shader reads the texture count and the indices
+layout(std430, set = 0, binding = 1) readonly buffer Views {
+    vec4 frustum[6];
+    vec4 cameraPosition;
+    uint objectCount;
+    uint lodCount;
+    int vertexOffset;
+    float projectionScale;
+    float pixelThreshold;
+    float radius;
+    uint compact;
+    uint finestLod;
+    float time;
+    uint gridSize;
+    float angularSpacing;
+    float nearestDistance;
+    float objectScale;
+    uint textureCount;
+    uint objectBuffer;
+    uint lodBuffer;
+    uint drawCommandBuffer;
+    uint drawCountBuffer;
+    uint objectLodBuffer;
+    uint textureSizeBuffer;
+    uint textures[16];
+} views[];
+#define view views[constants.viewBuffer]
+
+// every draw is a single instance whose firstInstance is the object's index
+// all storage buffers are in the same bindless array, every type of buffer declares the array with its own contents
+layout(std430, set = 0, binding = 1) readonly buffer Objects { vec4 objects[]; } objectBuffers[]; // center.xyz, scale
+layout(std430, set = 0, binding = 1) readonly buffer ObjectLods { uint lods[]; } objectLodBuffers[];
+
+// one color per level of detail, so the switches are visible
+const vec3 lodColors[8] = vec3[](
+    vec3(1.0, 1.0, 1.0), vec3(0.3, 0.6, 1.0), vec3(0.3, 1.0, 0.4), vec3(1.0, 1.0, 0.3),
+    vec3(1.0, 0.6, 0.2), vec3(1.0, 0.3, 0.3), vec3(0.9, 0.3, 1.0), vec3(0.5, 0.5, 0.5)
+);
+
+void main() {
+    vec4 object = objectBuffers[view.objectBuffer].objects[gl_InstanceIndex];
+    gl_Position = constants.viewProjection * vec4(object.xyz + position * object.w, 1.0);
+    fragNormal = normal;
+    fragColor = lodColors[min(objectLodBuffers[view.objectLodBuffer].lods[gl_InstanceIndex], 7u)];
+    
+    // the texture's index in the bindless textures, the fragment shader samples it without looking at the view again
+    fragTexture = view.textures[gl_InstanceIndex % view.textureCount];
+}
@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec3 inColor;
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform Constants {
+    float fade;
+} constants;
+
+// and one of the materials, which are shared between draws
+layout(set = 0, binding = 1) uniform Material {
+    vec4 color;
+} material;
+
+void main() {
+    outColor = vec4(constants.fade * inColor * material.color.rgb, 1);
+}
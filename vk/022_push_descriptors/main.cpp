@@ -0,0 +1,871 @@
+// this sample gives every draw its own bindings through push descriptors (VK_KHR_push_descriptor)
+// push constants are perfect for handing a draw a few bytes, but they can't point a draw at a buffer range or a texture
+// the usual way to do that is a descriptor set per draw: allocate it, write it and bind it, for a set that's used exactly once
+// even with the pooled allocator from the descriptor allocator sample that's three calls per draw, and a pool chain to reset every frame
+// push descriptors skip the set altogether: vkCmdPushDescriptorSetKHR records the descriptor writes straight into the command buffer,
+// the same way vkCmdPushConstants records constants, and the driver takes care of the memory they end up in
+// when the extension isn't available (or --no-push-descriptors is passed) the sample falls back to allocating a set per draw
+// --draws N changes the amount of draws, --benchmark records a few hundred frames with both paths and prints how long recording took
+
+// see lines
+// * 75-87 Checked for VK_KHR_push_descriptor
+// * 117-136 Created a set layout for each path, and looked up vkCmdPushDescriptorSetKHR
+// * 158-188 Padded the per-draw uniform data to minUniformBufferOffsetAlignment
+// * 263-299 Pushed the per-draw descriptors, or allocated, wrote and bound a set per draw
+// * 190-194, 220, 305-317, 355-370 Timed command buffer recording for both paths
+// * 501-502 Enabled VK_KHR_push_descriptor
+// * 622-642 Created a push descriptor set layout
+// * vertex & fragment shader: per-draw object and material uniform buffers
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/physical_device.hpp"
+#include "utils/swapchain.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/descriptor_allocator.hpp"
+
+// per-draw data, matches the Object block in vertex.glsl
+struct ObjectData
+{
+    float offset[2];
+    float scale;
+};
+
+// shared between draws, matches the Material block in fragment.glsl
+struct MaterialData
+{
+    float color[4];
+};
+
+VkInstance createInstance();
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window);
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, bool pushDescriptors);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkRenderPass createRenderpass(VkDevice device, VkFormat format);
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, bool pushDescriptors);
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout);
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+
+int main(int argc, char** argv) {
+    // default GLFW window creation except we disable OpenGL context creation
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 800, "022_push_descriptors", nullptr, nullptr);
+    
+    VkInstance instance = createInstance();
+    VkSurfaceKHR surface = createSurface(instance, window);
+    
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice = PhysicalDevice::select(instance, surface, &families);
+    
+    // push descriptors are a device extension, which almost every desktop driver and most mobile drivers support
+    bool pushDescriptors = Extensions { physicalDevice }.available("VK_KHR_push_descriptor");
+    
+    uint32_t drawCount = 4096;
+    bool benchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--no-push-descriptors") == 0)
+            pushDescriptors = false;
+        if (strcmp(argv[i], "--draws") == 0 && i + 1 < argc)
+            drawCount = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+    }
+    
+    printf("Binding per-draw resources for %u draws with %s\n", drawCount, pushDescriptors ? "vkCmdPushDescriptorSetKHR" : "descriptor sets from a descriptor allocator");
+    
+    VkDevice device = createDevice(instance, physicalDevice, families.graphics, families.present, pushDescriptors);
+    VkQueue graphicsQueue; vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+    VkQueue presentQueue; vkGetDeviceQueue(device, families.present, 0, &presentQueue);
+    
+    VkCommandPool commandPool = createCommandPool(device, families.graphics);
+    VkCommandBuffer cmd = allocateCommandBuffer(device, commandPool);
+    
+    Swapchain swap = Swapchain::create(device, physicalDevice, surface, families.graphics, families.present);
+    
+    VkRenderPass renderpass = createRenderpass(device, swap.format);
+    auto swapchainImages = swap.getImages(device);
+    auto swapchainImageViews = swap.getImageViews(device);
+    auto swapchainFramebuffers = swap.getFramebuffers(device, renderpass);
+    
+    // semaphores are for GPU-GPU synchronization
+    // imageWaitSemaphore: Makes our command buffer wait on vkAcquireNextImageKHR to be finished
+    // presentWaitSemaphore: Makes vkQueuePresentKHR wait on our commands to be done rendering
+    VkSemaphoreCreateInfo semaphoreInfo { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0 };
+    VkSemaphore imageWaitSemaphore, presentWaitSemaphore;
+    THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageWaitSemaphore));
+    THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &presentWaitSemaphore));
+  
+    VkShaderModule vertexShader = Shader::load(device, "../022_push_descriptors/vertex.spv");
+    VkShaderModule fragmentShader = Shader::load(device, "../022_push_descriptors/fragment.spv");
+    
+    // the fallback path is always created, the benchmark compares it with push descriptors
+    VkDescriptorSetLayout setLayout = createDescriptorSetLayout(device, false);
+    VkPipelineLayout pipelineLayout = createPipelineLayout(device, setLayout);
+    VkPipeline pipeline = createPipeline(device, swap, renderpass, pipelineLayout, vertexShader, fragmentShader);
+    
+    // a push descriptor set layout can't be used to allocate sets, so the push path needs a layout of its own
+    // pipeline layouts with different set layouts aren't compatible, which means a pipeline layout and a pipeline of its own as well
+    VkDescriptorSetLayout pushSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pushPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pushPipeline = VK_NULL_HANDLE;
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
+    if (pushDescriptors)
+    {
+        pushSetLayout = createDescriptorSetLayout(device, true);
+        pushPipelineLayout = createPipelineLayout(device, pushSetLayout);
+        pushPipeline = createPipeline(device, swap, renderpass, pushPipelineLayout, vertexShader, fragmentShader);
+        
+        // extension functions aren't exported by the loader, so we have to look them up ourselves
+        cmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetKHR"));
+    }
+    
+    // the fallback allocates a set per draw every frame, and returns all of them at once the next frame
+    // its pools grow during the first frame, after that allocating is cheap
+    std::unique_ptr<DescriptorAllocator> descriptors = std::make_unique<DescriptorAllocator>(device, std::vector<VkDescriptorPoolSize> {
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 }
+    }, 256);
+    
+    // vertex: { float3 pos, float3 color }
+    // the quad is scaled and moved into place by the vertex shader
+    std::vector<float> vertices {
+        //  vertex              color
+        -0.5, -0.5, 0.0,     1.0, 0.0, 0.0,
+        0.5, 0.5, 0.0,       0.0, 1.0, 0.0,
+        -0.5, 0.5, 0.0,      0.0, 0.0, 1.0,
+        0.5, -0.5, 0.0,      0.0, 0.0, 1.0
+    };
+    std::unique_ptr<Buffer> vertexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(float) * vertices.size(), vertices.data(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    
+    std::vector<uint32_t> indices { 0, 1, 2, 0, 3, 1 };
+    std::unique_ptr<Buffer> indexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * indices.size(), indices.data(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    
+    // every draw binds a range of one large uniform buffer, and the offset of a uniform buffer descriptor
+    // has to be a multiple of minUniformBufferOffsetAlignment, so every object and material is padded to it
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+    VkDeviceSize objectStride = (sizeof(ObjectData) + alignment - 1) / alignment * alignment;
+    VkDeviceSize materialStride = (sizeof(MaterialData) + alignment - 1) / alignment * alignment;
+    
+    // lay the draws out on a grid that covers the window
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(drawCount))));
+    float cellSize = 2.0f / columns;
+    std::vector<uint8_t> objects(objectStride * drawCount);
+    for (uint32_t i = 0; i < drawCount; i++)
+    {
+        ObjectData object {};
+        object.offset[0] = -1.0f + cellSize * (i % columns + 0.5f);
+        object.offset[1] = -1.0f + cellSize * (i / columns + 0.5f);
+        object.scale = cellSize * 0.8f;
+        memcpy(objects.data() + objectStride * i, &object, sizeof(ObjectData));
+    }
+    std::unique_ptr<Buffer> objectBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, objects.size(), objects.data(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    
+    const uint32_t materialCount = 16;
+    std::vector<uint8_t> materials(materialStride * materialCount);
+    for (uint32_t i = 0; i < materialCount; i++)
+    {
+        float hue = 6.2831853f * i / materialCount;
+        MaterialData material { { 0.6f + 0.4f * std::cos(hue), 0.6f + 0.4f * std::cos(hue + 2.0943951f), 0.6f + 0.4f * std::cos(hue + 4.1887902f), 1.0f } };
+        memcpy(materials.data() + materialStride * i, &material, sizeof(MaterialData));
+    }
+    std::unique_ptr<Buffer> materialBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, materials.size(), materials.data(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    
+    // milliseconds spent recording the command buffer, per path: [0] descriptor sets, [1] push descriptors
+    // the benchmark skips the first frames of a path, so growing the descriptor pools isn't counted
+    const uint32_t benchmarkFrames = 256, warmupFrames = 16;
+    std::array<double, 2> recordTime { 0, 0 };
+    std::array<uint32_t, 2> recordedFrames { 0, 0 };
+    uint32_t frame = 0;
+    
+    float t = 0;
+    
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        
+        // the benchmark runs the fallback first, then push descriptors if they're supported
+        bool usePushDescriptors = pushDescriptors;
+        if (benchmark)
+        {
+            uint32_t pathFrames = benchmarkFrames + warmupFrames;
+            if (frame == (pushDescriptors ? 2 : 1) * pathFrames)
+                break;
+            
+            usePushDescriptors = frame >= pathFrames;
+        }
+        
+        // Acquire the next image to render to
+        // the frame might not immediately be ready (swapchain may stall for e.g. vsync)
+        // so we must wait with either a semaphore (GPU-GPU sync) or a fence (CPU-GPU sync)
+        uint32_t imageIndex;
+        vkAcquireNextImageKHR(device, swap.swapchain, UINT_MAX, imageWaitSemaphore, /* fence */ nullptr, &imageIndex);
+        
+        // the pool reset is part of what the fallback costs per frame, and what push descriptors avoid, so it's timed too
+        auto recordStart = std::chrono::steady_clock::now();
+        
+        // the previous frame has finished (see vkDeviceWaitIdle below), so its sets can be returned
+        descriptors->reset();
+        
+        // describe how we'll start recording the command buffer
+        // this is usually fairly simple for primary command buffers
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = 0;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(cmd, &beginInfo); // start recording
+        
+        // pick a clear color - float32 is in RGBA [0 - 1]
+        VkClearValue clearValue {};
+        clearValue.color.float32[0] = 0;
+        clearValue.color.float32[1] = 0;
+        clearValue.color.float32[2] = 0;
+        clearValue.color.float32[3] = 1;
+        
+        VkRenderPassBeginInfo renderpassBegin {};
+        renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderpassBegin.pNext = nullptr;
+        renderpassBegin.renderPass = renderpass;
+        renderpassBegin.framebuffer = swapchainFramebuffers[imageIndex];
+        renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, swap.extent };
+        renderpassBegin.clearValueCount = 1;
+        renderpassBegin.pClearValues = &clearValue;
+        
+        vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        
+        VkPipelineLayout layout = usePushDescriptors ? pushPipelineLayout : pipelineLayout;
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, usePushDescriptors ? pushPipeline : pipeline);
+        
+        t += 0.01f;
+        float fade = 0.5f + 0.5f * sin(t);
+        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &fade);
+        
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer->buffer, &offset);
+        vkCmdBindIndexBuffer(cmd, indexBuffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+        
+        for (uint32_t i = 0; i < drawCount; i++)
+        {
+            // both paths describe the draw's bindings with the same descriptor writes
+            VkDescriptorBufferInfo objectInfo { objectBuffer->buffer, objectStride * i, sizeof(ObjectData) };
+            VkDescriptorBufferInfo materialInfo { materialBuffer->buffer, materialStride * (i % materialCount), sizeof(MaterialData) };
+            
+            std::array<VkWriteDescriptorSet, 2> writes {};
+            for (size_t w = 0; w < writes.size(); w++)
+            {
+                writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[w].pNext = nullptr;
+                writes[w].dstBinding = static_cast<uint32_t>(w);
+                writes[w].dstArrayElement = 0;
+                writes[w].descriptorCount = 1;
+                writes[w].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            }
+            writes[0].pBufferInfo = &objectInfo;
+            writes[1].pBufferInfo = &materialInfo;
+            
+            if (usePushDescriptors)
+            {
+                // the writes are recorded into the command buffer, so there's no set to write to and dstSet is ignored
+                // like push constants, pushed descriptors stay bound until they're pushed again or the layout changes
+                cmdPushDescriptorSet(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pushPipelineLayout, 0, writes.size(), writes.data());
+            }
+            else
+            {
+                // a set can't be written once it's bound in a command buffer that's still pending, so every draw needs a fresh one
+                VkDescriptorSet set = descriptors->allocate(setLayout);
+                writes[0].dstSet = set;
+                writes[1].dstSet = set;
+                vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &set, 0, nullptr);
+            }
+            
+            vkCmdDrawIndexed(cmd, indices.size(), 1, 0, 0, 0);
+        }
+        
+        vkCmdEndRenderPass(cmd);
+        
+        vkEndCommandBuffer(cmd); // end recording
+        
+        // only the CPU side is measured, this is where the two paths differ
+        size_t path = usePushDescriptors ? 1 : 0;
+        if (!benchmark || frame % (benchmarkFrames + warmupFrames) >= warmupFrames)
+        {
+            recordTime[path] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+            recordedFrames[path]++;
+        }
+        
+        if (!benchmark && recordedFrames[path] == benchmarkFrames)
+        {
+            printf("Recorded %u draws in %.3f ms on average\n", drawCount, recordTime[path] / recordedFrames[path]);
+            recordTime[path] = 0;
+            recordedFrames[path] = 0;
+        }
+        
+        // this can be more optimal or specialized by picking a more specific pipeline stage
+        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        
+        // submit the command list to the graphics queue
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = nullptr;
+        submit.waitSemaphoreCount = 1;
+        submit.pWaitSemaphores = &imageWaitSemaphore; // wait for the image to be ready before the commands can execute
+        submit.pWaitDstStageMask = &waitStageMask;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cmd;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &presentWaitSemaphore; // signal the present wait semaphore afterwards so present() can wait on it
+        vkQueueSubmit(graphicsQueue, 1, &submit, nullptr);
+        
+        // after we're done rendering, we'll present our image to the screen.
+        VkResult result;
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.pNext = nullptr;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &presentWaitSemaphore; // present after waiting is done
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swap.swapchain;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = &result;
+        vkQueuePresentKHR(presentQueue, &presentInfo);
+        
+        // wait for everything to be finished before we continue to the next frame
+        // note: this is bad practice but it allows us to focus on the rest of Vulkan first
+        vkDeviceWaitIdle(device);
+        frame++;
+    }
+    
+    if (benchmark)
+    {
+        printf("Recording %u draws, averaged over %u frames:\n", drawCount, benchmarkFrames);
+        const char* names[2] = { "descriptor sets", "push descriptors" };
+        for (size_t i = 0; i < recordTime.size(); i++)
+        {
+            if (recordedFrames[i] == 0)
+                continue;
+            
+            double milliseconds = recordTime[i] / recordedFrames[i];
+            printf("  %-16s %8.3f ms, %6.1f ns per draw\n", names[i], milliseconds, milliseconds * 1000000.0 / drawCount);
+        }
+        if (recordedFrames[0] != 0 && recordedFrames[1] != 0)
+            printf("  push descriptors record %.2fx as fast\n", recordTime[0] / recordedFrames[0] / (recordTime[1] / recordedFrames[1]));
+        printf("  peak of %u descriptor sets per frame in %u pools\n", descriptors->peak(), descriptors->poolCount());
+    }
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    // we'll do so here at the end of the application
+    // note that these resources may still be in use by the application
+    // so it is recommended to call vkDeviceWaitIdle(device) prior to destroying them.
+    vkDeviceWaitIdle(device);
+    
+    // even though unique ptrs automatically destroy,
+    // this still has to happen before destruction of VkDevice
+    // so we'll do so manually here
+    vertexBuffer.reset();
+    indexBuffer.reset();
+    objectBuffer.reset();
+    materialBuffer.reset();
+    descriptors.reset();
+    
+    if (pushDescriptors)
+    {
+        vkDestroyPipeline(device, pushPipeline, nullptr);
+        vkDestroyPipelineLayout(device, pushPipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(device, pushSetLayout, nullptr);
+    }
+    
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    
+    vkDestroyShaderModule(device, vertexShader, nullptr);
+    vkDestroyShaderModule(device, fragmentShader, nullptr);
+    
+    for (size_t i = 0; i < swapchainImages.size(); i++)
+    {
+        vkDestroyFramebuffer(device, swapchainFramebuffers[i], nullptr);
+        vkDestroyImageView(device, swapchainImageViews[i], nullptr);
+    }
+    
+    vkDestroyRenderPass(device, renderpass, nullptr);
+    vkDestroySemaphore(device, imageWaitSemaphore, nullptr);
+    vkDestroySemaphore(device, presentWaitSemaphore, nullptr);
+    vkDestroySwapchainKHR(device, swap.swapchain, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+VkInstance createInstance()
+{
+    Extensions extensionHelper{};
+    extensionHelper.addRequiredGLFW();
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "022_push_descriptors";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    // the allocated path relies on a full pool failing with VK_ERROR_OUT_OF_POOL_MEMORY, which is core in Vulkan 1.1
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 1, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    VkInstance instance;
+    THROW_IF_FAILED(vkCreateInstance(&instanceInfo, nullptr, &instance));
+    return instance;
+}
+
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window)
+{
+    // create a window surface using GLFW's helper function
+    VkSurfaceKHR surface;
+    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create VkSurfaceKHR from GLFW window");
+    
+    return surface;
+}
+
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily, bool pushDescriptors)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 2> priorities = { 1, 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // we'll need at least a graphics queue
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    // only create a separate present queue if needed
+    if (graphicsFamily != presentFamily)
+    {
+        deviceQueues.push_back(VkDeviceQueueCreateInfo {
+            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            nullptr,        // pNext
+            0,              // flags (none)
+            static_cast<uint32_t>(presentFamily),
+            1,              // create one queue
+            priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+        });
+    }
+
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_swapchain", true);
+    ext.add("VK_KHR_portability_subset");
+    if (pushDescriptors)
+        ext.add("VK_KHR_push_descriptor", true);
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = nullptr;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkRenderPass createRenderpass(VkDevice device, VkFormat format)
+{
+    // next we'll describe a render pass
+    // renderpasses are like a pre-defined render graph
+    // they define sub passes and how they interact with their (and each other's) attachments
+    // this can help greatly improve performance on mobile devices
+    // our renderpass will be fairly simple: 1 subpass with 1 color attachment
+    
+    // describe our color attachment:
+    // - how its used
+    // - how its loaded/stored
+    // - what its layout will be before/after the pass
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = format;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT; // msaa
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    
+    // subpasses must describe their attachments and in what layout they wish to use them
+    // during a renderpass, attachments are transitioned to a subpass's desired layout
+    // thus our attachment starts as UNDEFINED, transitions to COLOR_ATTACHMENT during our subpass, and at the end of the renderpass it transitions to PRESENT_SRC
+    VkAttachmentReference colorRef {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    // describe a simple graphics (not compute) subpass with a single color attachment
+    VkSubpassDescription subpass {};
+    subpass.flags = 0;
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.inputAttachmentCount = 0;
+    subpass.pInputAttachments = nullptr;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    subpass.preserveAttachmentCount = 0;
+    subpass.pPreserveAttachments = nullptr;
+    
+    // create a renderpass with the described color attachment and subpass
+    VkRenderPassCreateInfo renderpassInfo {};
+    renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderpassInfo.pNext = nullptr;
+    renderpassInfo.flags = 0;
+    renderpassInfo.attachmentCount = 1;
+    renderpassInfo.pAttachments = &colorAttachment;
+    renderpassInfo.subpassCount = 1;
+    renderpassInfo.pSubpasses = &subpass;
+    renderpassInfo.dependencyCount = 0;
+    renderpassInfo.pDependencies = nullptr;
+    
+    VkRenderPass renderpass;
+    THROW_IF_FAILED(vkCreateRenderPass(device, &renderpassInfo, nullptr, &renderpass));
+    
+    return renderpass;
+}
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, bool pushDescriptors)
+{
+    // binding 0: the draw's object data, binding 1: its material
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings {
+        VkDescriptorSetLayoutBinding { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr },
+        VkDescriptorSetLayoutBinding { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
+    };
+    
+    // the push descriptor flag turns the layout into one that's only ever pushed, never allocated
+    // a push descriptor set can hold up to maxPushDescriptors descriptors, which is at least 32
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext = nullptr;
+    setLayoutInfo.flags = pushDescriptors ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;
+    setLayoutInfo.bindingCount = bindings.size();
+    setLayoutInfo.pBindings = bindings.data();
+    
+    VkDescriptorSetLayout setLayout;
+    THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &setLayout));
+    
+    return setLayout;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout)
+{
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(float);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // our shaders use one set with the per-draw bindings, and the fade push constant
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // describe our vertex and fragment shader (shader stage, entry point) for the pipeline
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            vertexShader,
+            "main",
+            nullptr
+        },
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            fragmentShader,
+            "main",
+            nullptr
+        }
+    };
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 color)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 1;
+    pipelineVertexInput.pVertexBindingDescriptions = &vertexBinding;
+    pipelineVertexInput.vertexAttributeDescriptionCount = vertexAttributes.size();
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = swap.extent.width;
+    viewport.height = swap.extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = swap.extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // these default values disable depth and stencil testing:
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = false;
+    pipelineDepthStencilState.depthWriteEnable = false;
+    pipelineDepthStencilState.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0; // subpass index 0
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
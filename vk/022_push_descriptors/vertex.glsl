@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+
+layout(location = 0) out vec3 fragColor;
+
+// every draw binds its own slice of the object buffer
+layout(set = 0, binding = 0) uniform Object {
+    vec2 offset;
+    float scale;
+} object;
+
+void main() {
+    gl_Position = vec4(position.xy * object.scale + object.offset, position.z, 1.0);
+    fragColor = color;
+}
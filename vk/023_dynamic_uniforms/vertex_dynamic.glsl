@@ -0,0 +1,18 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+
+layout(location = 0) out vec3 fragColor;
+
+// dynamic uniform buffer: the descriptor stays the same, every draw binds it at a different offset
+layout(set = 0, binding = 0) uniform Draw {
+    vec2 offset;
+    float scale;
+    vec4 color;
+} draw;
+
+void main() {
+    gl_Position = vec4(position.xy * draw.scale + draw.offset, position.z, 1.0);
+    fragColor = color * draw.color.rgb;
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// a KTX2 texture (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html) held in memory, with its mip levels ready for upload
+// KTX2 stores the Vulkan format of the texture directly, and every level is laid out exactly like a tightly packed
+// buffer to image copy expects it, so the levels can go into a staging buffer as-is.
+// only plain 2D textures are supported: no arrays, cube maps, 3D textures or supercompression (Basis Universal, zstd).
+class Ktx2
+{
+public:
+    struct Level
+    {
+        const uint8_t* data;
+        VkDeviceSize size;
+        VkExtent2D extent;
+    };
+
+    // levels[0] is the full resolution level, every next level halves the size
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent {};
+    std::vector<Level> levels;
+
+    // width and height in texels of a compressed block, and its size in bytes. uncompressed formats have 1x1 blocks
+    uint32_t blockDim = 1;
+    uint32_t blockBytes = 4;
+
+    Ktx2() = default;
+    Ktx2(Ktx2&&) = default;
+    Ktx2& operator=(Ktx2&&) = default;
+
+    // the levels point into the file's data, so copies would point into the wrong data
+    Ktx2(const Ktx2&) = delete;
+    Ktx2& operator=(const Ktx2&) = delete;
+
+    static Ktx2 load(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            throw std::runtime_error(std::string("Failed to open ") + path);
+
+        std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+        return parse(std::move(data));
+    }
+
+    static Ktx2 parse(std::vector<uint8_t> data)
+    {
+        static const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+        // the header is followed by the offsets of the data format descriptor, the key/value data and the supercompression data
+        // which we don't need, and then the level index
+        struct Header
+        {
+            uint8_t identifier[12];
+            uint32_t vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth, layerCount, faceCount, levelCount, supercompressionScheme;
+            uint32_t dfdByteOffset, dfdByteLength, kvdByteOffset, kvdByteLength;
+            uint64_t sgdByteOffset, sgdByteLength;
+        };
+        struct LevelIndex
+        {
+            uint64_t byteOffset, byteLength, uncompressedByteLength;
+        };
+
+        Header header;
+        if (data.size() < sizeof(Header))
+            throw std::runtime_error("Not a KTX2 file");
+        memcpy(&header, data.data(), sizeof(Header));
+
+        if (memcmp(header.identifier, identifier, sizeof(identifier)) != 0)
+            throw std::runtime_error("Not a KTX2 file");
+        if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0)
+            throw std::runtime_error("Supercompressed KTX2 files aren't supported");
+        if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.pixelWidth == 0 || header.pixelHeight == 0)
+            throw std::runtime_error("Only 2D KTX2 textures are supported");
+
+        // a level count of 0 asks the loader to generate the mips, we stream whatever levels the file has
+        // a chain can't go past the 1x1 level, which also keeps the level index below from overflowing
+        uint32_t levelCount = std::max(header.levelCount, 1u);
+        uint32_t mipCount = 1;
+        while ((std::max(header.pixelWidth, header.pixelHeight) >> mipCount) != 0)
+            mipCount++;
+        if (levelCount > mipCount)
+            throw std::runtime_error("KTX2 file has more levels than its size allows");
+        if (data.size() < sizeof(Header) + levelCount * sizeof(LevelIndex))
+            throw std::runtime_error("Truncated KTX2 file");
+
+        Ktx2 result;
+        result.format = static_cast<VkFormat>(header.vkFormat);
+        result.extent = VkExtent2D { header.pixelWidth, header.pixelHeight };
+        if (!formatBlock(result.format, &result.blockDim, &result.blockBytes))
+            throw std::runtime_error("Unsupported KTX2 format " + std::to_string(header.vkFormat));
+
+        result.m_data = std::move(data);
+        for (uint32_t i = 0; i < levelCount; i++)
+        {
+            LevelIndex index;
+            memcpy(&index, result.m_data.data() + sizeof(Header) + i * sizeof(LevelIndex), sizeof(LevelIndex));
+            // the offset is checked on its own first, so a huge length can't wrap the sum around
+            if (index.byteOffset > result.m_data.size() || index.byteLength > result.m_data.size() - index.byteOffset)
+                throw std::runtime_error("Truncated KTX2 file");
+
+            // without supercompression a level holds exactly its blocks, anything else would be uploaded out of bounds
+            VkExtent2D extent { std::max(result.extent.width >> i, 1u), std::max(result.extent.height >> i, 1u) };
+            VkDeviceSize blocksWide = (extent.width + result.blockDim - 1) / result.blockDim;
+            VkDeviceSize blocksHigh = (extent.height + result.blockDim - 1) / result.blockDim;
+            if (index.byteLength != blocksWide * blocksHigh * result.blockBytes)
+                throw std::runtime_error("KTX2 level " + std::to_string(i) + " has the wrong size");
+
+            result.levels.push_back(Level { result.m_data.data() + index.byteOffset, index.byteLength, extent });
+        }
+
+        return result;
+    }
+
+    // a texture built in memory, the levels are stored one after the other in the same way a file stores them
+    static Ktx2 create(VkFormat format, VkExtent2D extent, const std::vector<std::vector<uint8_t>>& levels)
+    {
+        Ktx2 result;
+        result.format = format;
+        result.extent = extent;
+        if (!formatBlock(format, &result.blockDim, &result.blockBytes))
+            throw std::runtime_error("Unsupported texture format");
+
+        for (const std::vector<uint8_t>& level : levels)
+            result.m_data.insert(result.m_data.end(), level.begin(), level.end());
+
+        VkDeviceSize offset = 0;
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            VkExtent2D levelExtent { std::max(extent.width >> i, 1u), std::max(extent.height >> i, 1u) };
+            result.levels.push_back(Level { result.m_data.data() + offset, levels[i].size(), levelExtent });
+            offset += levels[i].size();
+        }
+
+        return result;
+    }
+
+    // the block layout of the formats we can stream, 8 bit colors and the BC formats desktop GPUs support
+    static bool formatBlock(VkFormat format, uint32_t* blockDim, uint32_t* blockBytes)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            *blockDim = 1; *blockBytes = 4; return true;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            *blockDim = 4; *blockBytes = 8; return true;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            *blockDim = 4; *blockBytes = 16; return true;
+        default:
+            return false;
+        }
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "queue_families.hpp"
+#include "device_capabilities.hpp"
+
+class PhysicalDevice
+{
+public:
+    // selects a physical device
+    // picks the first one that supports our needs
+    static VkPhysicalDevice select(VkInstance instance, VkSurfaceKHR surface, QueueFamilies* outQueueFamilies)
+    {
+        // get all available physical devices
+        uint32_t count;
+        vkEnumeratePhysicalDevices(instance, &count, nullptr);
+        std::vector<VkPhysicalDevice> physicalDevices(count);
+        vkEnumeratePhysicalDevices(instance, &count, physicalDevices.data());
+        
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+
+        for (auto pd : physicalDevices)
+        {
+            QueueFamilies families = QueueFamilies::select(instance, pd, surface);
+            
+            if (!families.valid())
+                continue;
+            
+            if (!DeviceCapabilities::get(pd).has(DeviceExtension::Swapchain))
+                continue;
+            
+            *outQueueFamilies = families;
+            physicalDevice = pd;
+        }
+        
+        assert(physicalDevice != nullptr);
+        return physicalDevice;
+    }
+};
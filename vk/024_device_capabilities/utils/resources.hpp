@@ -0,0 +1,375 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+#include "preprocessor.hpp"
+#include "memory.hpp"
+#include "queue_families.hpp"
+#include "deletion_queue.hpp"
+
+// a 32 bit handle to a resource in a Pool: the low 20 bits are the slot, the high 12 bits the slot's generation
+// every time a slot is freed its generation goes up, so a handle to a resource that was destroyed no longer matches the
+// slot, even when the slot was reused for a new resource. generations wrap after 4095 reuses of a slot, a handle kept
+// around that long could match again. 0 is never handed out, so a default constructed handle is always invalid
+template<typename Tag>
+struct Handle
+{
+    static constexpr uint32_t indexBits = 20;
+    static constexpr uint32_t indexMask = (1u << indexBits) - 1;
+    static constexpr uint32_t generationMask = (1u << (32 - indexBits)) - 1;
+
+    uint32_t value = 0;
+
+    uint32_t index() const { return value & indexMask; }
+    uint32_t generation() const { return value >> indexBits; }
+    explicit operator bool() const { return value != 0; }
+    bool operator==(Handle other) const { return value == other.value; }
+    bool operator!=(Handle other) const { return value != other.value; }
+};
+
+// stores resources as a structure of arrays: every field has its own array, indexed by the handle's slot
+// code that only needs one field (e.g. the VkBuffer while recording) reads one dense array, not whole objects spread over the heap.
+// freed slots go on a free list and are reused before the arrays grow, so once the arrays are large enough (reserve)
+// creating and destroying resources doesn't allocate
+template<typename Tag, typename... Fields>
+class Pool
+{
+public:
+    using HandleType = Handle<Tag>;
+
+    void reserve(uint32_t capacity)
+    {
+        std::apply([&](auto&... field) { (field.reserve(capacity), ...); }, m_fields);
+        m_generations.reserve(capacity);
+        m_free.reserve(capacity);
+    }
+
+    HandleType add(Fields... values)
+    {
+        uint32_t index;
+        if (!m_free.empty())
+        {
+            index = m_free.back();
+            m_free.pop_back();
+            set(index, std::make_tuple(values...), std::index_sequence_for<Fields...>());
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_generations.size());
+            assert(index <= HandleType::indexMask);
+            push(std::make_tuple(values...), std::index_sequence_for<Fields...>());
+            m_generations.push_back(1);
+        }
+
+        m_alive++;
+        return HandleType { (static_cast<uint32_t>(m_generations[index]) << HandleType::indexBits) | index };
+    }
+
+    // a single compare, the generations are kept apart from the fields so this only touches two bytes
+    bool alive(HandleType handle) const
+    {
+        return handle && handle.index() < m_generations.size() && m_generations[handle.index()] == handle.generation();
+    }
+
+    // the handle stops being alive straight away, the slot's fields are left as they are until it's reused
+    void remove(HandleType handle)
+    {
+        assert(alive(handle));
+        uint16_t& generation = m_generations[handle.index()];
+        generation = (generation + 1) & HandleType::generationMask;
+        if (generation == 0)
+            generation = 1;
+
+        m_free.push_back(handle.index());
+        m_alive--;
+    }
+
+    template<size_t Field>
+    auto& get(HandleType handle)
+    {
+        assert(alive(handle));
+        return std::get<Field>(m_fields)[handle.index()];
+    }
+
+    template<size_t Field>
+    const auto& get(HandleType handle) const
+    {
+        assert(alive(handle));
+        return std::get<Field>(m_fields)[handle.index()];
+    }
+
+    // calls f with the handle of every live resource, in slot order
+    template<typename F>
+    void forEach(F f) const
+    {
+        std::vector<bool> freed(m_generations.size(), false);
+        for (uint32_t index : m_free)
+            freed[index] = true;
+
+        for (uint32_t i = 0; i < m_generations.size(); i++)
+            if (!freed[i])
+                f(HandleType { (static_cast<uint32_t>(m_generations[i]) << HandleType::indexBits) | i });
+    }
+
+    uint32_t size() const { return m_alive; }
+
+private:
+    template<size_t... I>
+    void set(uint32_t index, std::tuple<Fields...> values, std::index_sequence<I...>)
+    {
+        ((std::get<I>(m_fields)[index] = std::get<I>(values)), ...);
+    }
+
+    template<size_t... I>
+    void push(std::tuple<Fields...> values, std::index_sequence<I...>)
+    {
+        (std::get<I>(m_fields).push_back(std::get<I>(values)), ...);
+    }
+
+    std::tuple<std::vector<Fields>...> m_fields;
+    std::vector<uint16_t> m_generations;
+    std::vector<uint32_t> m_free;
+    uint32_t m_alive = 0;
+};
+
+using BufferHandle = Handle<struct BufferTag>;
+using ImageHandle = Handle<struct ImageTag>;
+using PipelineHandle = Handle<struct PipelineTag>;
+using SamplerHandle = Handle<struct SamplerTag>;
+
+// owns the buffers, images, pipelines and samplers of the application and hands out handles to them
+// the Vulkan objects and what's known about them live in one Pool per kind of resource. destroying a resource frees its
+// slot right away (handles to it stop being alive) and hands the Vulkan objects to the deletion queue, which destroys
+// them once the frames that may still use them have finished. whatever is still alive is destroyed with the registry
+class Resources
+{
+public:
+    // deletionQueue has to outlive the registry's destroy() calls, capacity is the number of resources of every kind
+    // that fit before the pools have to grow
+    Resources(VkDevice device, VkPhysicalDevice physicalDevice, const QueueFamilies& families, DeletionQueue& deletionQueue, uint32_t capacity = 256)
+        : m_device(device), m_physicalDevice(physicalDevice), m_families(families), m_deletionQueue(deletionQueue)
+    {
+        m_buffers.reserve(capacity);
+        m_images.reserve(capacity);
+        m_pipelines.reserve(capacity);
+        m_samplers.reserve(capacity);
+    }
+
+    // only after the device is idle, like every other destructor
+    ~Resources()
+    {
+        m_buffers.forEach([&](BufferHandle handle) { release(handle); });
+        m_images.forEach([&](ImageHandle handle) { release(handle); });
+        m_pipelines.forEach([&](PipelineHandle handle) { vkDestroyPipeline(m_device, pipeline(handle), nullptr); });
+        m_samplers.forEach([&](SamplerHandle handle) { vkDestroySampler(m_device, sampler(handle), nullptr); });
+    }
+
+    Resources(const Resources&) = delete;
+    Resources& operator=(const Resources&) = delete;
+
+    // same as Buffer::create(), exclusive buffers are owned by one queue family at a time
+    BufferHandle createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryFlags, bool exclusive = false)
+    {
+        VkBufferCreateInfo bufferInfo {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.pNext = nullptr;
+        bufferInfo.flags = 0;
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+
+        std::array<uint32_t, 2> familyArr { static_cast<uint32_t>(m_families.present), static_cast<uint32_t>(m_families.graphics) };
+        if (m_families.present != m_families.graphics && !exclusive)
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = familyArr.size();
+            bufferInfo.pQueueFamilyIndices = familyArr.data();
+        }
+        else
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            bufferInfo.queueFamilyIndexCount = 0;
+            bufferInfo.pQueueFamilyIndices = nullptr;
+        }
+
+        VkBuffer buffer;
+        THROW_IF_FAILED(vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer));
+
+        VkMemoryRequirements memoryReqs;
+        vkGetBufferMemoryRequirements(m_device, buffer, &memoryReqs);
+
+        VkMemoryAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.pNext = nullptr;
+        allocInfo.allocationSize = memoryReqs.size;
+        allocInfo.memoryTypeIndex = Memory::select(m_physicalDevice, memoryReqs, memoryFlags);
+
+        VkDeviceMemory memory;
+        THROW_IF_FAILED(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory));
+        THROW_IF_FAILED(vkBindBufferMemory(m_device, buffer, memory, 0));
+
+        return m_buffers.add(buffer, memory, size, nullptr);
+    }
+
+    // a device local image with a view of all of its levels, its contents and layouts start out undefined
+    // unlike Image, the registry doesn't keep track of layouts
+    ImageHandle createImage(VkFormat format, VkExtent2D extent, uint32_t mipLevels, VkImageUsageFlags usage)
+    {
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.pNext = nullptr;
+        imageInfo.flags = 0;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = VkExtent3D { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.queueFamilyIndexCount = 0;
+        imageInfo.pQueueFamilyIndices = nullptr;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkImage image;
+        THROW_IF_FAILED(vkCreateImage(m_device, &imageInfo, nullptr, &image));
+
+        VkMemoryRequirements memoryReqs;
+        vkGetImageMemoryRequirements(m_device, image, &memoryReqs);
+
+        VkMemoryAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.pNext = nullptr;
+        allocInfo.allocationSize = memoryReqs.size;
+        allocInfo.memoryTypeIndex = Memory::select(m_physicalDevice, memoryReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkDeviceMemory memory;
+        THROW_IF_FAILED(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory));
+        THROW_IF_FAILED(vkBindImageMemory(m_device, image, memory, 0));
+
+        VkImageViewCreateInfo viewInfo {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.pNext = nullptr;
+        viewInfo.flags = 0;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.components = VkComponentMapping { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+        viewInfo.subresourceRange = VkImageSubresourceRange { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+
+        VkImageView view;
+        THROW_IF_FAILED(vkCreateImageView(m_device, &viewInfo, nullptr, &view));
+
+        return m_images.add(image, memory, view, format, extent, mipLevels);
+    }
+
+    // pipelines and samplers are created elsewhere, the registry takes ownership of them
+    PipelineHandle addPipeline(VkPipeline pipeline, VkPipelineBindPoint bindPoint) { return m_pipelines.add(pipeline, bindPoint); }
+    SamplerHandle addSampler(VkSampler sampler) { return m_samplers.add(sampler); }
+
+    // the resource's handle stops being alive straight away, its Vulkan objects are destroyed by the deletion queue
+    void destroy(BufferHandle handle)
+    {
+        if (m_buffers.get<BufferMapped>(handle) != nullptr)
+            vkUnmapMemory(m_device, m_buffers.get<BufferMemory>(handle));
+        m_deletionQueue.destroy(m_buffers.get<BufferObject>(handle));
+        m_deletionQueue.destroy(m_buffers.get<BufferMemory>(handle));
+        m_buffers.remove(handle);
+    }
+
+    void destroy(ImageHandle handle)
+    {
+        m_deletionQueue.destroy(m_images.get<ImageView>(handle));
+        m_deletionQueue.destroy(m_images.get<ImageObject>(handle));
+        m_deletionQueue.destroy(m_images.get<ImageMemory>(handle));
+        m_images.remove(handle);
+    }
+
+    void destroy(PipelineHandle handle)
+    {
+        m_deletionQueue.destroy(pipeline(handle));
+        m_pipelines.remove(handle);
+    }
+
+    void destroy(SamplerHandle handle)
+    {
+        m_deletionQueue.destroy(sampler(handle));
+        m_samplers.remove(handle);
+    }
+
+    // a handle whose resource was destroyed is no longer alive, the accessors below assert on that
+    bool alive(BufferHandle handle) const { return m_buffers.alive(handle); }
+    bool alive(ImageHandle handle) const { return m_images.alive(handle); }
+    bool alive(PipelineHandle handle) const { return m_pipelines.alive(handle); }
+    bool alive(SamplerHandle handle) const { return m_samplers.alive(handle); }
+
+    VkBuffer buffer(BufferHandle handle) const { return m_buffers.get<BufferObject>(handle); }
+    VkDeviceSize size(BufferHandle handle) const { return m_buffers.get<BufferSize>(handle); }
+
+    // persistently map the buffer's memory, only valid for host visible memory
+    uint8_t* map(BufferHandle handle)
+    {
+        uint8_t*& mapped = m_buffers.get<BufferMapped>(handle);
+        if (mapped == nullptr)
+        {
+            void* ptr;
+            THROW_IF_FAILED(vkMapMemory(m_device, m_buffers.get<BufferMemory>(handle), 0, VK_WHOLE_SIZE, 0, &ptr));
+            mapped = static_cast<uint8_t*>(ptr);
+        }
+
+        return mapped;
+    }
+
+    VkImage image(ImageHandle handle) const { return m_images.get<ImageObject>(handle); }
+    VkImageView view(ImageHandle handle) const { return m_images.get<ImageView>(handle); }
+    VkFormat format(ImageHandle handle) const { return m_images.get<ImageFormat>(handle); }
+    VkExtent2D extent(ImageHandle handle) const { return m_images.get<ImageExtent>(handle); }
+    uint32_t mipLevels(ImageHandle handle) const { return m_images.get<ImageMipLevels>(handle); }
+
+    VkPipeline pipeline(PipelineHandle handle) const { return m_pipelines.get<PipelineObject>(handle); }
+    VkPipelineBindPoint bindPoint(PipelineHandle handle) const { return m_pipelines.get<PipelineBindPoint>(handle); }
+
+    VkSampler sampler(SamplerHandle handle) const { return m_samplers.get<SamplerObject>(handle); }
+
+    uint32_t bufferCount() const { return m_buffers.size(); }
+    uint32_t imageCount() const { return m_images.size(); }
+    uint32_t pipelineCount() const { return m_pipelines.size(); }
+    uint32_t samplerCount() const { return m_samplers.size(); }
+
+private:
+    // the fields of every pool, in the order of its template arguments
+    enum BufferField { BufferObject, BufferMemory, BufferSize, BufferMapped };
+    enum ImageField { ImageObject, ImageMemory, ImageView, ImageFormat, ImageExtent, ImageMipLevels };
+    enum PipelineField { PipelineObject, PipelineBindPoint };
+    enum SamplerField { SamplerObject };
+
+    // at shutdown there's nothing left to wait for
+    void release(BufferHandle handle)
+    {
+        if (m_buffers.get<BufferMapped>(handle) != nullptr)
+            vkUnmapMemory(m_device, m_buffers.get<BufferMemory>(handle));
+        vkDestroyBuffer(m_device, m_buffers.get<BufferObject>(handle), nullptr);
+        vkFreeMemory(m_device, m_buffers.get<BufferMemory>(handle), nullptr);
+    }
+
+    void release(ImageHandle handle)
+    {
+        vkDestroyImageView(m_device, m_images.get<ImageView>(handle), nullptr);
+        vkDestroyImage(m_device, m_images.get<ImageObject>(handle), nullptr);
+        vkFreeMemory(m_device, m_images.get<ImageMemory>(handle), nullptr);
+    }
+
+    VkDevice m_device;
+    VkPhysicalDevice m_physicalDevice;
+    QueueFamilies m_families;
+    DeletionQueue& m_deletionQueue;
+
+    Pool<BufferTag, VkBuffer, VkDeviceMemory, VkDeviceSize, uint8_t*> m_buffers;
+    Pool<ImageTag, VkImage, VkDeviceMemory, VkImageView, VkFormat, VkExtent2D, uint32_t> m_images;
+    Pool<PipelineTag, VkPipeline, VkPipelineBindPoint> m_pipelines;
+    Pool<SamplerTag, VkSampler> m_samplers;
+};
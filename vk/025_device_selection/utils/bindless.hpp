@@ -0,0 +1,208 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include "preprocessor.hpp"
+#include "deletion_queue.hpp"
+#include "device_capabilities.hpp"
+
+// a single descriptor set that holds every texture and every storage buffer of the application (VK_EXT_descriptor_indexing)
+// instead of binding the resources a draw uses to a set of its own, every resource gets an index into one of two large
+// arrays when it's created, and shaders pick their resources with those indices, from push constants or from other buffers.
+// the set is bound once per command buffer, and draws that use different resources no longer need a bind in between them,
+// so they can be merged into a single indirect draw.
+// - the arrays are created with PARTIALLY_BOUND, so the unused entries never have to be written
+// - UPDATE_AFTER_BIND lets resources be added while the set is bound in command buffers that are recorded or still running,
+//   as long as those don't use the entries that are written (UPDATE_UNUSED_WHILE_PENDING)
+// - removing a resource only frees its index once the frames that may still use it are done, through the deletion queue
+class BindlessHeap
+{
+public:
+    // the binding numbers of the arrays, they match the "binding = x" declarations in the shaders
+    static const uint32_t textureBinding = 0;
+    static const uint32_t bufferBinding = 1;
+
+    // every feature of VK_EXT_descriptor_indexing the heap relies on
+    // the texture indices come from the objects, which differ between the invocations of a merged draw, hence nonuniformEXT
+    static bool supported(const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features)
+    {
+        return features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound
+            && features.descriptorBindingSampledImageUpdateAfterBind && features.descriptorBindingStorageBufferUpdateAfterBind
+            && features.descriptorBindingUpdateUnusedWhilePending && features.shaderSampledImageArrayNonUniformIndexing;
+    }
+
+    // deletionQueue decides when the index of a removed resource can be handed out again
+    // the capacities are clamped to what the device supports for update after bind sets
+    BindlessHeap(VkDevice device, VkPhysicalDevice physicalDevice, DeletionQueue& deletionQueue, uint32_t textureCapacity = 4096, uint32_t bufferCapacity = 1024)
+        : m_device(device), m_deletionQueue(deletionQueue)
+    {
+        const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& indexingProperties = DeviceCapabilities::get(physicalDevice).descriptorIndexingProperties();
+
+        // a combined image sampler counts as a sampled image and as a sampler
+        m_textureCapacity = std::min({ textureCapacity,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers, indexingProperties.maxDescriptorSetUpdateAfterBindSamplers });
+        m_bufferCapacity = std::min({ bufferCapacity,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers });
+
+        // every stage can see both arrays, the texture indices are only known once the shaders run
+        VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings {};
+        bindings[textureBinding] = VkDescriptorSetLayoutBinding { textureBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_textureCapacity, stages, nullptr };
+        bindings[bufferBinding] = VkDescriptorSetLayoutBinding { bufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_bufferCapacity, stages, nullptr };
+
+        VkDescriptorBindingFlagsEXT flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags { flags, flags };
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo {};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        bindingFlagsInfo.pNext = nullptr;
+        bindingFlagsInfo.bindingCount = bindingFlags.size();
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+        // update after bind bindings need the layout (and the pool) to be created for them
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+        setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.pNext = &bindingFlagsInfo;
+        setLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        setLayoutInfo.bindingCount = bindings.size();
+        setLayoutInfo.pBindings = bindings.data();
+        THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &m_setLayout));
+
+        // the pool only ever holds the one set
+        std::array<VkDescriptorPoolSize, 2> poolSizes {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_textureCapacity },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_bufferCapacity }
+        };
+
+        VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.pNext = nullptr;
+        descriptorPoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        descriptorPoolInfo.maxSets = 1;
+        descriptorPoolInfo.poolSizeCount = poolSizes.size();
+        descriptorPoolInfo.pPoolSizes = poolSizes.data();
+        THROW_IF_FAILED(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &m_pool));
+
+        VkDescriptorSetAllocateInfo setAllocInfo {};
+        setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setAllocInfo.pNext = nullptr;
+        setAllocInfo.descriptorPool = m_pool;
+        setAllocInfo.descriptorSetCount = 1;
+        setAllocInfo.pSetLayouts = &m_setLayout;
+        THROW_IF_FAILED(vkAllocateDescriptorSets(device, &setAllocInfo, &m_set));
+    }
+
+    // the deletion queue may still hold callbacks that free indices, it has to be flushed before the heap goes
+    ~BindlessHeap()
+    {
+        vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+    }
+
+    BindlessHeap(const BindlessHeap&) = delete;
+    BindlessHeap& operator=(const BindlessHeap&) = delete;
+
+    // pipeline layouts that use the heap include this layout, the set is bound with bind()
+    VkDescriptorSetLayout layout() const { return m_setLayout; }
+    VkDescriptorSet set() const { return m_set; }
+
+    void bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t setIndex = 0) const
+    {
+        vkCmdBindDescriptorSets(cmd, bindPoint, pipelineLayout, setIndex, 1, &m_set, 0, nullptr);
+    }
+
+    // returns the index shaders sample the texture with, the image has to be in layout whenever it's sampled
+    uint32_t addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+    {
+        uint32_t index = take(m_freeTextures, m_textureCount, m_textureCapacity);
+
+        VkDescriptorImageInfo imageInfo { sampler, view, layout };
+        write(textureBinding, index, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imageInfo, nullptr);
+        m_textures++;
+        return index;
+    }
+
+    // returns the index shaders access the buffer with
+    uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE)
+    {
+        uint32_t index = take(m_freeBuffers, m_bufferCount, m_bufferCapacity);
+
+        VkDescriptorBufferInfo bufferInfo { buffer, offset, range };
+        write(bufferBinding, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &bufferInfo);
+        m_buffers++;
+        return index;
+    }
+
+    // the entry is left as it is: partially bound entries may point at destroyed objects, as long as nothing uses them
+    // the frames that are being recorded or are in flight may still use the index, so it's only reused once they're done
+    void removeTexture(uint32_t index)
+    {
+        m_textures--;
+        m_deletionQueue.then([this, index]() { m_freeTextures.push_back(index); });
+    }
+
+    void removeBuffer(uint32_t index)
+    {
+        m_buffers--;
+        m_deletionQueue.then([this, index]() { m_freeBuffers.push_back(index); });
+    }
+
+    // the live resources, and the capacities of the arrays
+    uint32_t textureCount() const { return m_textures; }
+    uint32_t bufferCount() const { return m_buffers; }
+    uint32_t textureCapacity() const { return m_textureCapacity; }
+    uint32_t bufferCapacity() const { return m_bufferCapacity; }
+
+    // how many descriptors were written since the heap was created, one per added resource
+    uint64_t writes() const { return m_writes; }
+
+private:
+    // freed indices are reused first, which keeps the used part of the arrays small
+    static uint32_t take(std::vector<uint32_t>& free, uint32_t& count, uint32_t capacity)
+    {
+        if (!free.empty())
+        {
+            uint32_t index = free.back();
+            free.pop_back();
+            return index;
+        }
+
+        if (count == capacity)
+            throw std::runtime_error("bindless heap is full");
+        return count++;
+    }
+
+    // the set may be bound in command buffers that are being recorded or executed, which update after bind allows
+    void write(uint32_t binding, uint32_t index, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+    {
+        VkWriteDescriptorSet write {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.pNext = nullptr;
+        write.dstSet = m_set;
+        write.dstBinding = binding;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = type;
+        write.pImageInfo = imageInfo;
+        write.pBufferInfo = bufferInfo;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        m_writes++;
+    }
+
+    VkDevice m_device;
+    DeletionQueue& m_deletionQueue;
+
+    VkDescriptorSetLayout m_setLayout;
+    VkDescriptorPool m_pool;
+    VkDescriptorSet m_set;
+
+    // m_textureCount and m_bufferCount are the indices that were ever handed out, m_textures and m_buffers the live ones
+    uint32_t m_textureCapacity, m_bufferCapacity;
+    uint32_t m_textureCount = 0, m_bufferCount = 0;
+    uint32_t m_textures = 0, m_buffers = 0;
+    std::vector<uint32_t> m_freeTextures, m_freeBuffers;
+    uint64_t m_writes = 0;
+};
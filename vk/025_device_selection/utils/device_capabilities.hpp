@@ -0,0 +1,178 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <bitset>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// the device extensions the samples look for, each one gets a bit in DeviceCapabilities
+// adding one is adding an id before Count, and its name to DeviceCapabilities::name()
+enum class DeviceExtension : uint32_t
+{
+    Swapchain,
+    PortabilitySubset,
+    DrawIndirectCount,
+    TimelineSemaphore,
+    Synchronization2,
+    Maintenance3,
+    DescriptorIndexing,
+    MemoryBudget,
+    PushDescriptor,
+    Count
+};
+
+// a snapshot of everything a physical device reports that can't change while the application runs:
+// its extensions, features, properties and limits, memory types and queue families
+// the previous samples asked the driver every time they needed to know: every Extensions { physicalDevice } enumerated
+// the device's extensions again, every feature check called vkGetPhysicalDeviceFeatures2, and Memory::select called
+// vkGetPhysicalDeviceMemoryProperties for every single allocation. none of those are free, and none of the answers change.
+// get() queries a device once, the first time it's asked for, every query after that is a lookup:
+// - known extensions are a bit in a bitset, any other extension name is a hash lookup
+// - the features and properties structures of the extensions are only queried if the extension is available,
+//   otherwise they stay zeroed, so their features read as unsupported
+// what isn't in here is what does change: surface support depends on the surface, and memory budgets on the other
+// applications using the GPU, those keep their own queries.
+class DeviceCapabilities
+{
+public:
+    // the snapshot of a physical device, created on first use and kept until the application exits
+    // physical devices are owned by the instance, they're never destroyed while it's alive
+    static const DeviceCapabilities& get(VkPhysicalDevice physicalDevice)
+    {
+        static std::mutex mutex;
+        static std::unordered_map<VkPhysicalDevice, std::unique_ptr<DeviceCapabilities>> snapshots;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<DeviceCapabilities>& snapshot = snapshots[physicalDevice];
+        if (!snapshot)
+            snapshot.reset(new DeviceCapabilities(physicalDevice));
+
+        return *snapshot;
+    }
+
+    static const char* name(DeviceExtension extension)
+    {
+        static const char* names[] = {
+            "VK_KHR_swapchain",
+            "VK_KHR_portability_subset",
+            "VK_KHR_draw_indirect_count",
+            "VK_KHR_timeline_semaphore",
+            "VK_KHR_synchronization2",
+            "VK_KHR_maintenance3",
+            "VK_EXT_descriptor_indexing",
+            "VK_EXT_memory_budget",
+            "VK_KHR_push_descriptor"
+        };
+        static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(DeviceExtension::Count), "every extension id needs a name");
+
+        return names[static_cast<uint32_t>(extension)];
+    }
+
+    DeviceCapabilities(const DeviceCapabilities&) = delete;
+    DeviceCapabilities& operator=(const DeviceCapabilities&) = delete;
+
+    bool has(DeviceExtension extension) const { return m_extensions.test(static_cast<size_t>(extension)); }
+    bool has(const char* extensionName) const { return m_extensionNames.find(extensionName) != m_extensionNames.end(); }
+    const std::unordered_set<std::string>& extensionNames() const { return m_extensionNames; }
+
+    const VkPhysicalDeviceFeatures& features() const { return m_features.features; }
+    const VkPhysicalDeviceTimelineSemaphoreFeaturesKHR& timelineSemaphoreFeatures() const { return m_timelineFeatures; }
+    const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& descriptorIndexingFeatures() const { return m_indexingFeatures; }
+#ifdef VK_KHR_synchronization2
+    const VkPhysicalDeviceSynchronization2FeaturesKHR& synchronization2Features() const { return m_synchronization2Features; }
+#endif
+
+    const VkPhysicalDeviceProperties& properties() const { return m_properties.properties; }
+    const VkPhysicalDeviceLimits& limits() const { return m_properties.properties.limits; }
+    const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& descriptorIndexingProperties() const { return m_indexingProperties; }
+
+    const VkPhysicalDeviceMemoryProperties& memory() const { return m_memory; }
+    const std::vector<VkQueueFamilyProperties>& queueFamilies() const { return m_queueFamilies; }
+
+private:
+    // vkGetPhysicalDeviceFeatures2 and vkGetPhysicalDeviceProperties2 are core in Vulkan 1.1
+    DeviceCapabilities(VkPhysicalDevice physicalDevice)
+    {
+        uint32_t count;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+        std::vector<VkExtensionProperties> extensions(count);
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+
+        for (const VkExtensionProperties& extension : extensions)
+        {
+            m_extensionNames.insert(extension.extensionName);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(DeviceExtension::Count); i++)
+            {
+                if (strcmp(extension.extensionName, name(static_cast<DeviceExtension>(i))) == 0)
+                    m_extensions.set(i);
+            }
+        }
+
+        // an extension's structures may only be chained when the device supports the extension
+        m_timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+        m_indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        m_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        m_features.pNext = nullptr;
+        if (has(DeviceExtension::TimelineSemaphore))
+            chain(m_features, m_timelineFeatures);
+        if (has(DeviceExtension::DescriptorIndexing))
+            chain(m_features, m_indexingFeatures);
+#ifdef VK_KHR_synchronization2
+        m_synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+        if (has(DeviceExtension::Synchronization2))
+            chain(m_features, m_synchronization2Features);
+#endif
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &m_features);
+
+        m_indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+        m_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        m_properties.pNext = nullptr;
+        if (has(DeviceExtension::DescriptorIndexing))
+            chain(m_properties, m_indexingProperties);
+        vkGetPhysicalDeviceProperties2(physicalDevice, &m_properties);
+
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memory);
+
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+        m_queueFamilies.resize(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, m_queueFamilies.data());
+
+        // the structures are only read from here on, the chains would point into the snapshot itself
+        m_features.pNext = nullptr;
+        m_properties.pNext = nullptr;
+        m_timelineFeatures.pNext = nullptr;
+        m_indexingFeatures.pNext = nullptr;
+        m_indexingProperties.pNext = nullptr;
+#ifdef VK_KHR_synchronization2
+        m_synchronization2Features.pNext = nullptr;
+#endif
+    }
+
+    // puts structure at the front of the chain that starts at head
+    template<typename Head, typename Structure>
+    static void chain(Head& head, Structure& structure)
+    {
+        structure.pNext = head.pNext;
+        head.pNext = &structure;
+    }
+
+    std::bitset<static_cast<size_t>(DeviceExtension::Count)> m_extensions;
+    std::unordered_set<std::string> m_extensionNames;
+
+    VkPhysicalDeviceFeatures2 m_features {};
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR m_timelineFeatures {};
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT m_indexingFeatures {};
+#ifdef VK_KHR_synchronization2
+    VkPhysicalDeviceSynchronization2FeaturesKHR m_synchronization2Features {};
+#endif
+
+    VkPhysicalDeviceProperties2 m_properties {};
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT m_indexingProperties {};
+
+    VkPhysicalDeviceMemoryProperties m_memory {};
+    std::vector<VkQueueFamilyProperties> m_queueFamilies;
+};
@@ -0,0 +1,258 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include "preprocessor.hpp"
+#include "memory.hpp"
+#include "device_capabilities.hpp"
+
+// keeps track of how much memory every heap has in use and how much it's allowed to use
+// a device can allocate more than fits in its heaps, the driver then pages memory between the heaps and system memory behind
+// the application's back, which shows up as frames that take many times longer than the others. VK_EXT_memory_budget reports
+// per heap how much the process uses and how much it can use before that happens, including what other processes leave over.
+// the numbers are queried once per frame in update():
+// - select() picks a memory type whose heap still has room, preferring the given properties
+// - resources that can be released (and loaded again later) are registered with track() and kept in least recently used order
+// - when a heap goes over threshold * budget, the least recently used resources of that heap are evicted
+// without the extension, the budget is a guess based on the heap size and only allocations reported here are counted
+class MemoryBudget
+{
+public:
+    using Handle = uint32_t;
+
+    // extension is whether VK_EXT_memory_budget was enabled on the device
+    // limit caps the budget of the device local heaps (0 for no cap), to try out eviction on a device with plenty of memory
+    MemoryBudget(VkPhysicalDevice physicalDevice, bool extension, VkDeviceSize limit = 0, float threshold = 0.9f)
+        : m_physicalDevice(physicalDevice), m_extension(extension), m_limit(limit), m_threshold(threshold)
+    {
+        m_properties = DeviceCapabilities::get(physicalDevice).memory();
+        m_heaps.resize(m_properties.memoryHeapCount);
+        update();
+    }
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // called once per frame, before anything allocates or touches resources for the frame
+    // evicts resources until every heap is back under its threshold, or nothing is left that wasn't used last frame
+    void update()
+    {
+        // the extension's numbers are only valid until the next allocation, so the ones made after this are added on top
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties {};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        budgetProperties.pNext = nullptr;
+
+        VkPhysicalDeviceMemoryProperties2 properties {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budgetProperties;
+
+        if (m_extension)
+            vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &properties);
+
+        for (uint32_t i = 0; i < m_heaps.size(); i++)
+        {
+            Heap& heap = m_heaps[i];
+            const VkMemoryHeap& memoryHeap = m_properties.memoryHeaps[i];
+            if (m_extension)
+            {
+                heap.usage = budgetProperties.heapUsage[i];
+                heap.budget = budgetProperties.heapBudget[i];
+            }
+            else
+            {
+                // other processes and the driver need some of the heap as well, how much is unknown
+                heap.usage = heap.tracked;
+                heap.budget = memoryHeap.size / 10 * 8;
+            }
+            heap.since = 0;
+
+            if (m_limit != 0 && (memoryHeap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0)
+                heap.budget = std::min(heap.budget, m_limit);
+        }
+
+        m_frame++;
+        evict();
+    }
+
+    // a memory type the resource can be bound to, with the preferred properties if a heap that has them has room for it
+    // otherwise any type with the required properties that has room, and when none do the preferred type anyway
+    // e.g. textures prefer device local memory, but are better off sampled from system memory than paged in and out
+    uint32_t select(VkMemoryRequirements memoryReqs, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const
+    {
+        for (VkMemoryPropertyFlags flags : { required | preferred, required })
+        {
+            for (uint32_t i = 0; i < m_properties.memoryTypeCount; i++)
+            {
+                if ((memoryReqs.memoryTypeBits & (1u << i)) == 0)
+                    continue;
+                if ((m_properties.memoryTypes[i].propertyFlags & flags) != flags)
+                    continue;
+                if (fits(i, memoryReqs.size))
+                    return i;
+            }
+        }
+
+        int32_t index = Memory::find(m_physicalDevice, memoryReqs, required | preferred);
+        return index != -1 ? index : Memory::select(m_physicalDevice, memoryReqs, required);
+    }
+
+    // allocations and frees of memory of the given type, made after select()
+    void allocated(uint32_t memoryType, VkDeviceSize size)
+    {
+        Heap& heap = m_heaps[heapIndex(memoryType)];
+        heap.tracked += size;
+        heap.since += size;
+    }
+
+    void freed(uint32_t memoryType, VkDeviceSize size)
+    {
+        Heap& heap = m_heaps[heapIndex(memoryType)];
+        heap.tracked -= size;
+        heap.since -= size;
+    }
+
+    // true if size more bytes of the given type stay under the heap's threshold, not counting what's being evicted
+    bool fits(uint32_t memoryType, VkDeviceSize size) const
+    {
+        uint32_t index = heapIndex(memoryType);
+        return usage(index) + size <= m_heaps[index].evicting + threshold(index);
+    }
+
+    // registers a resource that can be evicted, evict is called at most once, from update()
+    // the resource stays counted as being evicted until its owner calls untrack(), which it should do once its memory is freed
+    Handle track(uint32_t memoryType, VkDeviceSize size, std::function<void()> evict)
+    {
+        Handle handle = m_nextHandle++;
+        m_lru.push_back(Entry { handle, heapIndex(memoryType), size, m_frame, std::move(evict) });
+        m_entries[handle] = std::prev(m_lru.end());
+        return handle;
+    }
+
+    // marks a resource as used by the frame that's being recorded, which moves it to the back of the eviction order
+    void touch(Handle handle)
+    {
+        auto it = m_entries.find(handle);
+        if (it == m_entries.end())
+            return;
+
+        it->second->lastUse = m_frame;
+        m_lru.splice(m_lru.end(), m_lru, it->second);
+    }
+
+    // the resource is being replaced and is only waiting for the GPU to be done with it, so it can't be evicted anymore
+    // its memory stays counted until it's freed, and its owner still calls untrack() once that has happened
+    void retire(Handle handle)
+    {
+        auto it = m_entries.find(handle);
+        if (it == m_entries.end())
+            return;
+
+        m_lru.erase(it->second);
+        m_entries.erase(it);
+    }
+
+    // the resource is gone, whether it was evicted or not
+    void untrack(Handle handle)
+    {
+        auto evicted = m_evicted.find(handle);
+        if (evicted != m_evicted.end())
+        {
+            m_heaps[evicted->second.heap].evicting -= evicted->second.size;
+            m_evicted.erase(evicted);
+            return;
+        }
+
+        auto it = m_entries.find(handle);
+        if (it == m_entries.end())
+            return;
+
+        m_lru.erase(it->second);
+        m_entries.erase(it);
+    }
+
+    uint32_t heapIndex(uint32_t memoryType) const { return m_properties.memoryTypes[memoryType].heapIndex; }
+    uint32_t heapCount() const { return m_heaps.size(); }
+    bool deviceLocal(uint32_t heap) const { return (m_properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0; }
+    VkDeviceSize usage(uint32_t heap) const { return m_heaps[heap].usage + m_heaps[heap].since; }
+    VkDeviceSize budget(uint32_t heap) const { return m_heaps[heap].budget; }
+    uint32_t evictions() const { return m_evictions; }
+    bool extension() const { return m_extension; }
+
+private:
+    // usage and budget are from the last update(), since is what was allocated (minus freed) after it
+    // tracked is everything that was reported through allocated() and freed(), the usage when there's no extension
+    struct Heap
+    {
+        VkDeviceSize usage = 0;
+        VkDeviceSize budget = 0;
+        VkDeviceSize since = 0;
+        VkDeviceSize tracked = 0;
+        VkDeviceSize evicting = 0;
+    };
+
+    struct Entry
+    {
+        Handle handle;
+        uint32_t heap;
+        VkDeviceSize size;
+        uint64_t lastUse;
+        std::function<void()> evict;
+    };
+
+    struct Evicted
+    {
+        uint32_t heap;
+        VkDeviceSize size;
+    };
+
+    bool over(uint32_t heap) const
+    {
+        return usage(heap) > m_heaps[heap].evicting + threshold(heap);
+    }
+
+    VkDeviceSize threshold(uint32_t heap) const { return static_cast<VkDeviceSize>(m_heaps[heap].budget * static_cast<double>(m_threshold)); }
+
+    // walks the resources from least to most recently used, resources used by the last frame are likely used by the next
+    // one too, evicting them would only load them again right away
+    void evict()
+    {
+        for (auto it = m_lru.begin(); it != m_lru.end();)
+        {
+            if (it->lastUse + 1 >= m_frame)
+                break;
+            if (!over(it->heap))
+            {
+                ++it;
+                continue;
+            }
+
+            Entry entry = std::move(*it);
+            m_entries.erase(entry.handle);
+            it = m_lru.erase(it);
+
+            m_heaps[entry.heap].evicting += entry.size;
+            m_evicted[entry.handle] = Evicted { entry.heap, entry.size };
+            m_evictions++;
+            entry.evict();
+        }
+    }
+
+    VkPhysicalDevice m_physicalDevice;
+    VkPhysicalDeviceMemoryProperties m_properties;
+    bool m_extension;
+    VkDeviceSize m_limit;
+    float m_threshold;
+
+    std::vector<Heap> m_heaps;
+    uint64_t m_frame = 0;
+
+    // front to back is least to most recently used, entries point into the list so touch() can move them in constant time
+    std::list<Entry> m_lru;
+    std::unordered_map<Handle, std::list<Entry>::iterator> m_entries;
+    std::unordered_map<Handle, Evicted> m_evicted;
+    Handle m_nextHandle = 1;
+    uint32_t m_evictions = 0;
+};
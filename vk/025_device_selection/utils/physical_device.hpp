@@ -0,0 +1,152 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include "queue_families.hpp"
+#include "device_capabilities.hpp"
+
+class PhysicalDevice
+{
+public:
+    // decides whether a device has what the application needs, beyond rendering and presenting
+    using Requirements = std::function<bool(const DeviceCapabilities&)>;
+
+    // selects a physical device
+    // every device that can render to the surface and meets the requirements gets a score, and the highest score wins
+    // preference overrides the score: a device index (in the order vkEnumeratePhysicalDevices returns them) or part of
+    // a device name, case insensitive. a preferred device that can't be used is reported, and the scores decide instead.
+    static VkPhysicalDevice select(VkInstance instance, VkSurfaceKHR surface, QueueFamilies* outQueueFamilies, const char* preference = nullptr, const Requirements& requirements = nullptr)
+    {
+        // get all available physical devices
+        uint32_t count;
+        vkEnumeratePhysicalDevices(instance, &count, nullptr);
+        std::vector<VkPhysicalDevice> physicalDevices(count);
+        vkEnumeratePhysicalDevices(instance, &count, physicalDevices.data());
+
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkPhysicalDevice preferredDevice = VK_NULL_HANDLE;
+        bool preferenceMatched = false;
+        uint64_t bestScore = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            VkPhysicalDevice pd = physicalDevices[i];
+            const DeviceCapabilities& capabilities = DeviceCapabilities::get(pd);
+
+            bool preferred = preference != nullptr && !preferenceMatched && matches(preference, i, capabilities.properties().deviceName);
+            preferenceMatched |= preferred;
+
+            QueueFamilies families = QueueFamilies::select(instance, pd, surface);
+            bool usable = families.valid() && capabilities.has(DeviceExtension::Swapchain) && (!requirements || requirements(capabilities));
+
+            uint64_t deviceScore = usable ? score(capabilities, families) : 0;
+            printf("Device %u: %s, %s, score %llu%s\n", i, capabilities.properties().deviceName, typeName(capabilities.properties().deviceType),
+                static_cast<unsigned long long>(deviceScore), usable ? "" : " (can't run this sample)");
+
+            if (!usable)
+            {
+                if (preferred)
+                    printf("The preferred device \"%s\" can't run this sample, selecting by score instead\n", preference);
+                continue;
+            }
+
+            // ties go to the first device, which is the one the loader lists first
+            if (preferred || (preferredDevice == VK_NULL_HANDLE && (physicalDevice == VK_NULL_HANDLE || deviceScore > bestScore)))
+            {
+                *outQueueFamilies = families;
+                physicalDevice = pd;
+                bestScore = deviceScore;
+                if (preferred)
+                    preferredDevice = pd;
+            }
+        }
+
+        if (preference != nullptr && !preferenceMatched)
+            printf("No device matches the preferred device \"%s\", selecting by score instead\n", preference);
+
+        if (physicalDevice == VK_NULL_HANDLE)
+            throw std::runtime_error("No physical device can run this sample");
+
+        return physicalDevice;
+    }
+
+    // how fast we expect a device to be, from what it tells us about itself
+    // the device type dominates: the smallest discrete GPU usually outruns the largest integrated one, and a CPU
+    // implementation (such as lavapipe or SwiftShader) is only ever a last resort. within a type, the amount of
+    // device local memory separates the larger GPUs from the smaller ones, and what's left breaks ties between
+    // otherwise similar devices: dedicated queue families let transfers and compute run next to rendering, and
+    // the extensions are the ones the samples run faster with.
+    static uint64_t score(const DeviceCapabilities& capabilities, const QueueFamilies& families)
+    {
+        uint64_t result = 0;
+        switch (capabilities.properties().deviceType)
+        {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: result += 4000000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: result += 2000000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: result += 1000000; break;
+        default: break;
+        }
+
+        // integrated GPUs report (part of) system memory as device local, which the type already accounts for
+        // one point per MB, capped so memory plus the at most 300 tie-break points below never outweighs the type
+        const VkPhysicalDeviceMemoryProperties& memory = capabilities.memory();
+        VkDeviceSize deviceLocal = 0;
+        for (uint32_t i = 0; i < memory.memoryHeapCount; i++)
+        {
+            if (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                deviceLocal = std::max(deviceLocal, memory.memoryHeaps[i].size);
+        }
+        result += std::min<uint64_t>(deviceLocal / (1024 * 1024), 999000);
+
+        if (families.transfer != -1)
+            result += 100;
+        if (families.compute != -1)
+            result += 100;
+
+        for (DeviceExtension extension : { DeviceExtension::DrawIndirectCount, DeviceExtension::Synchronization2, DeviceExtension::MemoryBudget, DeviceExtension::PushDescriptor })
+        {
+            if (capabilities.has(extension))
+                result += 25;
+        }
+
+        return result;
+    }
+
+private:
+    // a preference made up of only digits is an index, anything else is part of a name
+    static bool matches(const char* preference, uint32_t index, const char* deviceName)
+    {
+        std::string pattern = lowercase(preference);
+        if (pattern.empty())
+            return false;
+
+        if (pattern.find_first_not_of("0123456789") == std::string::npos)
+            return static_cast<uint32_t>(atoi(preference)) == index;
+
+        return lowercase(deviceName).find(pattern) != std::string::npos;
+    }
+
+    static std::string lowercase(const char* text)
+    {
+        std::string result(text);
+        for (char& c : result)
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    static const char* typeName(VkPhysicalDeviceType type)
+    {
+        switch (type)
+        {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return "discrete GPU";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return "integrated GPU";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return "virtual GPU";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU: return "CPU";
+        default: return "other";
+        }
+    }
+};
@@ -0,0 +1,1027 @@
+// this sample creates everything the previous sample (023) needs to render its first frame in parallel
+// startup used to be one long sequence: instance, surface, physical device, device, swapchain, shaders, layouts, pipelines and buffers,
+// each waiting on the one before it, even though most of them only need the device
+// here every step is a task in a graph that names what it depends on, and a pool of threads runs every task whose dependencies are done
+// the instance and device still come one after the other, but reading the shaders from disk overlaps with them, and once the device
+// exists the swapchain, shader modules, pipelines (each on their own thread), draw data and mesh upload are all created at the same time
+// every task's start and duration is printed after startup, followed by the time from the start of main() to the first presented frame
+// --sequential runs the same graph on a single thread to compare against, the other options are the same as 023's
+
+// see lines
+// * 149-175 Started the startup graph with the instance chain and reading the shaders, which doesn't need a device
+// * 177-296 Fanned out into tasks that only depend on the device, with a task per pipeline
+// * 298-303 Ran the graph on a thread per core (or one thread with --sequential) and printed every task's timing
+// * 68-69, 454-455 Measured the time to the first presented frame
+// * task_graph.hpp: a dependency graph run on a pool of threads, with a timer per task
+// * shader.hpp: split loading a shader into reading the file and creating the module
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/physical_device.hpp"
+#include "utils/swapchain.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/task_graph.hpp"
+
+// per-draw data, matches the Draw blocks in the vertex shaders
+// 32 bytes, laid out the same under std140 (uniform buffers) and std430 (push constants, storage buffers)
+struct DrawData
+{
+    float offset[2];
+    float scale;
+    float padding;
+    float color[4];
+};
+
+enum DrawDataPath
+{
+    PushConstants,
+    DynamicUniforms,
+    StorageBuffer,
+    PathCount
+};
+
+VkInstance createInstance();
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window);
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkRenderPass createRenderpass(VkDevice device, VkFormat format);
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, VkDescriptorType type);
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout, uint32_t pushConstantSize);
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+void writeDrawData(uint32_t drawCount, std::vector<DrawData>& draws, uint8_t* uniforms, VkDeviceSize uniformStride, uint8_t* storage);
+
+int main(int argc, char** argv) {
+    // time to first frame is measured from here to the first vkQueuePresentKHR
+    auto startupStart = std::chrono::steady_clock::now();
+    
+    const char* pathNames[PathCount] = { "push constants", "dynamic uniforms", "storage buffer" };
+    const std::array<uint32_t, 3> benchmarkDrawCounts { 1000, 10000, 100000 };
+    
+    DrawDataPath selectedPath = DynamicUniforms;
+    uint32_t drawCount = 10000;
+    bool benchmark = false;
+    bool sequential = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--push-constants") == 0)
+            selectedPath = PushConstants;
+        if (strcmp(argv[i], "--storage-buffer") == 0)
+            selectedPath = StorageBuffer;
+        if (strcmp(argv[i], "--draws") == 0 && i + 1 < argc)
+            drawCount = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+        if (strcmp(argv[i], "--sequential") == 0)
+            sequential = true;
+    }
+    
+    if (!benchmark)
+        printf("Passing per-draw data for %u draws through %s\n", drawCount, pathNames[selectedPath]);
+    
+    // default GLFW window creation except we disable OpenGL context creation
+    // GLFW wants its windows created on the main thread, so this happens before the graph runs
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 800, "026_parallel_init", nullptr, nullptr);
+    
+    // everything below is created by the tasks of the startup graph
+    // the tasks write these through references, and a task only reads what the tasks it depends on wrote
+    VkInstance instance;
+    VkSurfaceKHR surface;
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice;
+    VkPhysicalDeviceProperties properties;
+    VkDevice device;
+    VkQueue graphicsQueue, presentQueue;
+    VkCommandPool commandPool;
+    VkCommandBuffer cmd;
+    Swapchain swap;
+    VkRenderPass renderpass;
+    std::vector<VkImage> swapchainImages;
+    std::vector<VkImageView> swapchainImageViews;
+    std::vector<VkFramebuffer> swapchainFramebuffers;
+    VkSemaphore imageWaitSemaphore, presentWaitSemaphore;
+    std::array<std::vector<char>, PathCount + 1> shaderCode;
+    std::array<VkShaderModule, PathCount> vertexShaders;
+    VkShaderModule fragmentShader;
+    std::array<VkDescriptorSetLayout, PathCount> setLayouts { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    std::array<VkPipelineLayout, PathCount> pipelineLayouts;
+    std::array<VkPipeline, PathCount> pipelines;
+    VkDescriptorPool descriptorPool;
+    std::array<VkDescriptorSet, PathCount> descriptorSets { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    std::unique_ptr<Buffer> uniformBuffer, storageBuffer, vertexBuffer, indexBuffer;
+    VkDeviceSize uniformStride;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    bool gpuTimestamps;
+    
+    // push constants are recorded straight from CPU memory
+    std::vector<DrawData> draws;
+    uint32_t writtenDrawCount = 0;
+    
+    // vertex: { float3 pos, float3 color }
+    // the quad is scaled and moved into place by the vertex shader
+    std::vector<float> vertices {
+        //  vertex              color
+        -0.5, -0.5, 0.0,     1.0, 0.0, 0.0,
+        0.5, 0.5, 0.0,       0.0, 1.0, 0.0,
+        -0.5, 0.5, 0.0,      0.0, 0.0, 1.0,
+        0.5, -0.5, 0.0,      0.0, 0.0, 1.0
+    };
+    std::vector<uint32_t> indices { 0, 1, 2, 0, 3, 1 };
+    
+    // the uniform buffer and storage buffer are large enough for the most draws we'll render
+    uint32_t maxDrawCount = benchmark ? benchmarkDrawCounts.back() : drawCount;
+    
+    // the instance, surface, physical device and device come one after the other, everything else needs the device
+    // only reading the shaders from disk doesn't, so that overlaps with creating the instance and device
+    // once the device exists the graph fans out: the swapchain, shader modules, layouts, buffers and mesh upload
+    // don't depend on each other, and the pipelines only wait for the render pass, their layout and the shader modules
+    // Vulkan allows creating objects from any thread, only objects allocated from a pool (command buffers, descriptor sets)
+    // need that pool to be used by a single thread at a time, which is why each pool is created and allocated from in one task
+    TaskGraph startup;
+    
+    auto readShaders = startup.add("read shaders", [&] {
+        shaderCode[PushConstants] = Shader::read("../026_parallel_init/vertex_push.spv");
+        shaderCode[DynamicUniforms] = Shader::read("../026_parallel_init/vertex_dynamic.spv");
+        shaderCode[StorageBuffer] = Shader::read("../026_parallel_init/vertex_storage.spv");
+        shaderCode[PathCount] = Shader::read("../026_parallel_init/fragment.spv");
+    });
+    
+    auto createInstanceTask = startup.add("instance", [&] { instance = createInstance(); });
+    auto createSurfaceTask = startup.add("surface", [&] { surface = createSurface(instance, window); }, { createInstanceTask });
+    auto selectTask = startup.add("select physical device", [&] {
+        physicalDevice = PhysicalDevice::select(instance, surface, &families);
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    }, { createSurfaceTask });
+    
+    auto createDeviceTask = startup.add("device", [&] {
+        device = createDevice(instance, physicalDevice, families.graphics, families.present);
+        vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+        vkGetDeviceQueue(device, families.present, 0, &presentQueue);
+    }, { selectTask });
+    
+    startup.add("command buffer", [&] {
+        commandPool = createCommandPool(device, families.graphics);
+        cmd = allocateCommandBuffer(device, commandPool);
+    }, { createDeviceTask });
+    
+    // semaphores are for GPU-GPU synchronization
+    // imageWaitSemaphore: Makes our command buffer wait on vkAcquireNextImageKHR to be finished
+    // presentWaitSemaphore: Makes vkQueuePresentKHR wait on our commands to be done rendering
+    startup.add("semaphores", [&] {
+        VkSemaphoreCreateInfo semaphoreInfo { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0 };
+        THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageWaitSemaphore));
+        THROW_IF_FAILED(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &presentWaitSemaphore));
+    }, { createDeviceTask });
+    
+    auto createSwapchainTask = startup.add("swapchain", [&] {
+        swap = Swapchain::create(device, physicalDevice, surface, families.graphics, families.present);
+        renderpass = createRenderpass(device, swap.format);
+    }, { createDeviceTask });
+    
+    auto createFramebuffersTask = startup.add("framebuffers", [&] {
+        swapchainImages = swap.getImages(device);
+        swapchainImageViews = swap.getImageViews(device);
+        swapchainFramebuffers = swap.getFramebuffers(device, renderpass);
+    }, { createSwapchainTask });
+    
+    auto createShadersTask = startup.add("shader modules", [&] {
+        for (size_t i = 0; i < PathCount; i++)
+            vertexShaders[i] = Shader::create(device, shaderCode[i]);
+        fragmentShader = Shader::create(device, shaderCode[PathCount]);
+    }, { createDeviceTask, readShaders });
+    
+    // push constants need no set, the other two paths need a set with a single binding
+    auto createLayoutsTask = startup.add("layouts", [&] {
+        setLayouts[DynamicUniforms] = createDescriptorSetLayout(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+        setLayouts[StorageBuffer] = createDescriptorSetLayout(device, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        pipelineLayouts[PushConstants] = createPipelineLayout(device, setLayouts[PushConstants], sizeof(DrawData));
+        pipelineLayouts[DynamicUniforms] = createPipelineLayout(device, setLayouts[DynamicUniforms], 0);
+        pipelineLayouts[StorageBuffer] = createPipelineLayout(device, setLayouts[StorageBuffer], 0);
+    }, { createDeviceTask });
+    
+    // pipelines are by far the most expensive objects to create, so every pipeline gets its own task
+    // the viewport and scissor are baked into the pipelines, that only needs the swapchain's extent, which is known with the render pass
+    std::vector<TaskGraph::TaskId> createPipelineTasks;
+    for (size_t i = 0; i < PathCount; i++)
+    {
+        createPipelineTasks.push_back(startup.add(pathNames[i], [&, i] {
+            pipelines[i] = createPipeline(device, swap, renderpass, pipelineLayouts[i], vertexShaders[i], fragmentShader);
+        }, { createSwapchainTask, createShadersTask, createLayoutsTask }));
+    }
+    
+    // a dynamic offset is added to the descriptor's offset, and just like that offset it has to be a multiple of minUniformBufferOffsetAlignment
+    // that's up to 256 bytes, so with 32 bytes of data per draw most of the uniform buffer can be padding
+    // the storage buffer is an array in the shader, and packs the draws without any padding
+    auto createDrawDataTask = startup.add("draw data", [&] {
+        VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+        uniformStride = (sizeof(DrawData) + alignment - 1) / alignment * alignment;
+        
+        uniformBuffer = Buffer::create(device, physicalDevice, families, uniformStride * maxDrawCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        storageBuffer = Buffer::create(device, physicalDevice, families, sizeof(DrawData) * maxDrawCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        
+        writeDrawData(drawCount, draws, uniformBuffer->map(), uniformStride, storageBuffer->map());
+        writtenDrawCount = drawCount;
+    }, { createDeviceTask });
+    
+    startup.add("descriptor sets", [&] {
+        // both sets are written once and never change, so a plain descriptor pool is all we need
+        std::array<VkDescriptorPoolSize, 2> poolSizes {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 }
+        };
+        
+        VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.pNext = nullptr;
+        descriptorPoolInfo.flags = 0;
+        descriptorPoolInfo.maxSets = 2;
+        descriptorPoolInfo.poolSizeCount = poolSizes.size();
+        descriptorPoolInfo.pPoolSizes = poolSizes.data();
+        THROW_IF_FAILED(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool));
+        
+        VkDescriptorSetAllocateInfo setAllocInfo {};
+        setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setAllocInfo.pNext = nullptr;
+        setAllocInfo.descriptorPool = descriptorPool;
+        setAllocInfo.descriptorSetCount = 2;
+        setAllocInfo.pSetLayouts = &setLayouts[DynamicUniforms];
+        THROW_IF_FAILED(vkAllocateDescriptorSets(device, &setAllocInfo, &descriptorSets[DynamicUniforms]));
+        
+        // the dynamic uniform buffer's range is a single draw's block, the dynamic offset picks which one
+        // the storage buffer's range is the whole array
+        VkDescriptorBufferInfo uniformInfo { uniformBuffer->buffer, 0, sizeof(DrawData) };
+        VkDescriptorBufferInfo storageInfo { storageBuffer->buffer, 0, VK_WHOLE_SIZE };
+        std::array<VkWriteDescriptorSet, 2> writes {
+            VkWriteDescriptorSet { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptorSets[DynamicUniforms], 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, nullptr, &uniformInfo, nullptr },
+            VkWriteDescriptorSet { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptorSets[StorageBuffer], 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &storageInfo, nullptr }
+        };
+        vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+    }, { createLayoutsTask, createDrawDataTask });
+    
+    startup.add("mesh upload", [&] {
+        vertexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(float) * vertices.size(), vertices.data(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        indexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * indices.size(), indices.data(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    }, { createDeviceTask });
+    
+    // two timestamps around the draws measure how long the GPU spent on them
+    // timestampPeriod is the amount of nanoseconds per timestamp tick
+    startup.add("query pool", [&] {
+        gpuTimestamps = properties.limits.timestampComputeAndGraphics;
+        if (gpuTimestamps)
+        {
+            VkQueryPoolCreateInfo queryPoolInfo {};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.pNext = nullptr;
+            queryPoolInfo.flags = 0;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = 2;
+            queryPoolInfo.pipelineStatistics = 0;
+            THROW_IF_FAILED(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool));
+        }
+    }, { createDeviceTask });
+    
+    // --sequential runs the same graph on a single thread, the tasks then run one at a time in the order they become ready
+    uint32_t threadCount = sequential ? 1 : std::max(2u, std::thread::hardware_concurrency());
+    startup.run(threadCount);
+    
+    printf("Startup on %u thread%s:\n", threadCount, threadCount == 1 ? "" : "s");
+    startup.report();
+    
+    // milliseconds spent recording on the CPU and rendering on the GPU, per draw count and path
+    // every benchmark run starts with a few frames that aren't measured, for the driver to settle
+    const uint32_t warmupFrames = 8, measuredFrames = 64, reportFrames = 256;
+    std::array<std::array<double, PathCount>, 3> cpuTime {}, gpuTime {};
+    std::array<uint32_t, PathCount> recordedFrames {};
+    uint32_t frame = 0;
+    
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        
+        // the benchmark renders every draw count with every path, in that order
+        DrawDataPath path = selectedPath;
+        size_t countIndex = 0;
+        bool measured = true;
+        if (benchmark)
+        {
+            uint32_t run = frame / (warmupFrames + measuredFrames);
+            if (run == benchmarkDrawCounts.size() * PathCount)
+                break;
+            
+            countIndex = run / PathCount;
+            path = static_cast<DrawDataPath>(run % PathCount);
+            drawCount = benchmarkDrawCounts[countIndex];
+            measured = frame % (warmupFrames + measuredFrames) >= warmupFrames;
+        }
+        
+        // the previous frame has finished (see vkDeviceWaitIdle below), so the buffers can be rewritten
+        if (drawCount != writtenDrawCount)
+        {
+            writeDrawData(drawCount, draws, uniformBuffer->map(), uniformStride, storageBuffer->map());
+            writtenDrawCount = drawCount;
+        }
+        
+        // Acquire the next image to render to
+        // the frame might not immediately be ready (swapchain may stall for e.g. vsync)
+        // so we must wait with either a semaphore (GPU-GPU sync) or a fence (CPU-GPU sync)
+        uint32_t imageIndex;
+        vkAcquireNextImageKHR(device, swap.swapchain, UINT_MAX, imageWaitSemaphore, /* fence */ nullptr, &imageIndex);
+        
+        auto recordStart = std::chrono::steady_clock::now();
+        
+        // describe how we'll start recording the command buffer
+        // this is usually fairly simple for primary command buffers
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = 0;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(cmd, &beginInfo); // start recording
+        
+        // queries have to be reset before they're written again, outside of a render pass
+        if (gpuTimestamps)
+            vkCmdResetQueryPool(cmd, queryPool, 0, 2);
+        
+        // pick a clear color - float32 is in RGBA [0 - 1]
+        VkClearValue clearValue {};
+        clearValue.color.float32[0] = 0;
+        clearValue.color.float32[1] = 0;
+        clearValue.color.float32[2] = 0;
+        clearValue.color.float32[3] = 1;
+        
+        VkRenderPassBeginInfo renderpassBegin {};
+        renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderpassBegin.pNext = nullptr;
+        renderpassBegin.renderPass = renderpass;
+        renderpassBegin.framebuffer = swapchainFramebuffers[imageIndex];
+        renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, swap.extent };
+        renderpassBegin.clearValueCount = 1;
+        renderpassBegin.pClearValues = &clearValue;
+        
+        vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        
+        if (gpuTimestamps)
+            vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+        
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[path]);
+        
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer->buffer, &offset);
+        vkCmdBindIndexBuffer(cmd, indexBuffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+        
+        switch (path)
+        {
+        case PushConstants:
+            // every draw records its 32 bytes into the command buffer
+            for (uint32_t i = 0; i < drawCount; i++)
+            {
+                vkCmdPushConstants(cmd, pipelineLayouts[path], VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawData), &draws[i]);
+                vkCmdDrawIndexed(cmd, indices.size(), 1, 0, 0, 0);
+            }
+            break;
+        case DynamicUniforms:
+            // the same set is bound for every draw, only the dynamic offset changes
+            // dynamic offsets are consumed in binding order, one for every dynamic binding in the set
+            for (uint32_t i = 0; i < drawCount; i++)
+            {
+                uint32_t dynamicOffset = static_cast<uint32_t>(uniformStride * i);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts[path], 0, 1, &descriptorSets[path], 1, &dynamicOffset);
+                vkCmdDrawIndexed(cmd, indices.size(), 1, 0, 0, 0);
+            }
+            break;
+        case StorageBuffer:
+            // the set is bound once, and every draw passes its index as its first instance, which ends up in gl_InstanceIndex
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts[path], 0, 1, &descriptorSets[path], 0, nullptr);
+            for (uint32_t i = 0; i < drawCount; i++)
+                vkCmdDrawIndexed(cmd, indices.size(), 1, 0, 0, i);
+            break;
+        default:
+            break;
+        }
+        
+        if (gpuTimestamps)
+            vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+        
+        vkCmdEndRenderPass(cmd);
+        
+        vkEndCommandBuffer(cmd); // end recording
+        
+        double cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+        
+        // this can be more optimal or specialized by picking a more specific pipeline stage
+        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        
+        // submit the command list to the graphics queue
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = nullptr;
+        submit.waitSemaphoreCount = 1;
+        submit.pWaitSemaphores = &imageWaitSemaphore; // wait for the image to be ready before the commands can execute
+        submit.pWaitDstStageMask = &waitStageMask;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cmd;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &presentWaitSemaphore; // signal the present wait semaphore afterwards so present() can wait on it
+        vkQueueSubmit(graphicsQueue, 1, &submit, nullptr);
+        
+        // after we're done rendering, we'll present our image to the screen.
+        VkResult result;
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.pNext = nullptr;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &presentWaitSemaphore; // present after waiting is done
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swap.swapchain;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = &result;
+        vkQueuePresentKHR(presentQueue, &presentInfo);
+        
+        if (frame == 0)
+            printf("First frame presented %.2f ms after startup\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupStart).count());
+        
+        // wait for everything to be finished before we continue to the next frame
+        // note: this is bad practice but it allows us to focus on the rest of Vulkan first
+        vkDeviceWaitIdle(device);
+        
+        // the GPU is idle, so the timestamps are available without waiting
+        double gpuMilliseconds = 0;
+        if (gpuTimestamps)
+        {
+            std::array<uint64_t, 2> timestamps;
+            THROW_IF_FAILED(vkGetQueryPoolResults(device, queryPool, 0, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT));
+            gpuMilliseconds = (timestamps[1] - timestamps[0]) * properties.limits.timestampPeriod / 1000000.0;
+        }
+        
+        if (measured)
+        {
+            cpuTime[countIndex][path] += cpuMilliseconds;
+            gpuTime[countIndex][path] += gpuMilliseconds;
+            recordedFrames[path]++;
+        }
+        
+        if (!benchmark && recordedFrames[path] == reportFrames)
+        {
+            printf("%u draws through %s: %.3f ms recording, %.3f ms on the GPU\n", drawCount, pathNames[path], cpuTime[0][path] / reportFrames, gpuTime[0][path] / reportFrames);
+            cpuTime[0][path] = 0;
+            gpuTime[0][path] = 0;
+            recordedFrames[path] = 0;
+        }
+        
+        frame++;
+    }
+    
+    if (benchmark)
+    {
+        printf("Per-draw data, averaged over %u frames (CPU recording / GPU%s):\n", measuredFrames, gpuTimestamps ? "" : " timestamps not supported");
+        printf("  %8s", "draws");
+        for (size_t p = 0; p < PathCount; p++)
+            printf(" | %-23s", pathNames[p]);
+        printf("\n");
+        for (size_t c = 0; c < benchmarkDrawCounts.size(); c++)
+        {
+            printf("  %8u", benchmarkDrawCounts[c]);
+            for (size_t p = 0; p < PathCount; p++)
+                printf(" | %8.3f / %8.3f ms", cpuTime[c][p] / measuredFrames, gpuTime[c][p] / measuredFrames);
+            printf("\n");
+        }
+        printf("  uniform buffer: %llu bytes per draw for %zu bytes of data\n", static_cast<unsigned long long>(uniformStride), sizeof(DrawData));
+    }
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    // we'll do so here at the end of the application
+    // note that these resources may still be in use by the application
+    // so it is recommended to call vkDeviceWaitIdle(device) prior to destroying them.
+    vkDeviceWaitIdle(device);
+    
+    // even though unique ptrs automatically destroy,
+    // this still has to happen before destruction of VkDevice
+    // so we'll do so manually here
+    vertexBuffer.reset();
+    indexBuffer.reset();
+    uniformBuffer.reset();
+    storageBuffer.reset();
+    
+    if (gpuTimestamps)
+        vkDestroyQueryPool(device, queryPool, nullptr);
+    
+    // destroying the pool frees its sets
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    
+    for (size_t i = 0; i < PathCount; i++)
+    {
+        vkDestroyPipeline(device, pipelines[i], nullptr);
+        vkDestroyPipelineLayout(device, pipelineLayouts[i], nullptr);
+        if (setLayouts[i] != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(device, setLayouts[i], nullptr);
+        vkDestroyShaderModule(device, vertexShaders[i], nullptr);
+    }
+    
+    vkDestroyShaderModule(device, fragmentShader, nullptr);
+    
+    for (size_t i = 0; i < swapchainImages.size(); i++)
+    {
+        vkDestroyFramebuffer(device, swapchainFramebuffers[i], nullptr);
+        vkDestroyImageView(device, swapchainImageViews[i], nullptr);
+    }
+    
+    vkDestroyRenderPass(device, renderpass, nullptr);
+    vkDestroySemaphore(device, imageWaitSemaphore, nullptr);
+    vkDestroySemaphore(device, presentWaitSemaphore, nullptr);
+    vkDestroySwapchainKHR(device, swap.swapchain, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+VkInstance createInstance()
+{
+    Extensions extensionHelper{};
+    extensionHelper.addRequiredGLFW();
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "026_parallel_init";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    VkInstance instance;
+    THROW_IF_FAILED(vkCreateInstance(&instanceInfo, nullptr, &instance));
+    return instance;
+}
+
+VkSurfaceKHR createSurface(VkInstance instance, GLFWwindow* window)
+{
+    // create a window surface using GLFW's helper function
+    VkSurfaceKHR surface;
+    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create VkSurfaceKHR from GLFW window");
+    
+    return surface;
+}
+
+VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, int32_t graphicsFamily, int32_t presentFamily)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 2> priorities = { 1, 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // we'll need at least a graphics queue
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    // only create a separate present queue if needed
+    if (graphicsFamily != presentFamily)
+    {
+        deviceQueues.push_back(VkDeviceQueueCreateInfo {
+            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            nullptr,        // pNext
+            0,              // flags (none)
+            static_cast<uint32_t>(presentFamily),
+            1,              // create one queue
+            priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+        });
+    }
+
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_swapchain", true);
+    ext.add("VK_KHR_portability_subset");
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = nullptr;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkRenderPass createRenderpass(VkDevice device, VkFormat format)
+{
+    // next we'll describe a render pass
+    // renderpasses are like a pre-defined render graph
+    // they define sub passes and how they interact with their (and each other's) attachments
+    // this can help greatly improve performance on mobile devices
+    // our renderpass will be fairly simple: 1 subpass with 1 color attachment
+    
+    // describe our color attachment:
+    // - how its used
+    // - how its loaded/stored
+    // - what its layout will be before/after the pass
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = format;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT; // msaa
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    
+    // subpasses must describe their attachments and in what layout they wish to use them
+    // during a renderpass, attachments are transitioned to a subpass's desired layout
+    // thus our attachment starts as UNDEFINED, transitions to COLOR_ATTACHMENT during our subpass, and at the end of the renderpass it transitions to PRESENT_SRC
+    VkAttachmentReference colorRef {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    // describe a simple graphics (not compute) subpass with a single color attachment
+    VkSubpassDescription subpass {};
+    subpass.flags = 0;
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.inputAttachmentCount = 0;
+    subpass.pInputAttachments = nullptr;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    subpass.preserveAttachmentCount = 0;
+    subpass.pPreserveAttachments = nullptr;
+    
+    // create a renderpass with the described color attachment and subpass
+    VkRenderPassCreateInfo renderpassInfo {};
+    renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderpassInfo.pNext = nullptr;
+    renderpassInfo.flags = 0;
+    renderpassInfo.attachmentCount = 1;
+    renderpassInfo.pAttachments = &colorAttachment;
+    renderpassInfo.subpassCount = 1;
+    renderpassInfo.pSubpasses = &subpass;
+    renderpassInfo.dependencyCount = 0;
+    renderpassInfo.pDependencies = nullptr;
+    
+    VkRenderPass renderpass;
+    THROW_IF_FAILED(vkCreateRenderPass(device, &renderpassInfo, nullptr, &renderpass));
+    
+    return renderpass;
+}
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, VkDescriptorType type)
+{
+    // a single binding with the per-draw data, only used by the vertex shader
+    // a dynamic uniform buffer binding is declared like any other binding, its offset is only known when the set is bound
+    VkDescriptorSetLayoutBinding binding { 0, type, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr };
+    
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext = nullptr;
+    setLayoutInfo.flags = 0;
+    setLayoutInfo.bindingCount = 1;
+    setLayoutInfo.pBindings = &binding;
+    
+    VkDescriptorSetLayout setLayout;
+    THROW_IF_FAILED(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &setLayout));
+    
+    return setLayout;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout, uint32_t pushConstantSize)
+{
+    // push constant ranges must be a multiple of 4 bytes, and fit in maxPushConstantsSize, which is at least 128
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = pushConstantSize;
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // every path uses either a set or push constants, never both
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = setLayout != VK_NULL_HANDLE ? 1 : 0;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize != 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, Swapchain& swap, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // describe our vertex and fragment shader (shader stage, entry point) for the pipeline
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            vertexShader,
+            "main",
+            nullptr
+        },
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            fragmentShader,
+            "main",
+            nullptr
+        }
+    };
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 color)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 1;
+    pipelineVertexInput.pVertexBindingDescriptions = &vertexBinding;
+    pipelineVertexInput.vertexAttributeDescriptionCount = vertexAttributes.size();
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = swap.extent.width;
+    viewport.height = swap.extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = swap.extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // these default values disable depth and stencil testing:
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = false;
+    pipelineDepthStencilState.depthWriteEnable = false;
+    pipelineDepthStencilState.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0; // subpass index 0
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
+
+void writeDrawData(uint32_t drawCount, std::vector<DrawData>& draws, uint8_t* uniforms, VkDeviceSize uniformStride, uint8_t* storage)
+{
+    // lay the draws out on a grid that covers the window
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(drawCount))));
+    float cellSize = 2.0f / columns;
+    
+    draws.resize(drawCount);
+    for (uint32_t i = 0; i < drawCount; i++)
+    {
+        float hue = 6.2831853f * (i % 16) / 16.0f;
+        
+        DrawData& draw = draws[i];
+        draw.offset[0] = -1.0f + cellSize * (i % columns + 0.5f);
+        draw.offset[1] = -1.0f + cellSize * (i / columns + 0.5f);
+        draw.scale = cellSize * 0.8f;
+        draw.padding = 0;
+        draw.color[0] = 0.6f + 0.4f * std::cos(hue);
+        draw.color[1] = 0.6f + 0.4f * std::cos(hue + 2.0943951f);
+        draw.color[2] = 0.6f + 0.4f * std::cos(hue + 4.1887902f);
+        draw.color[3] = 1.0f;
+        
+        // the uniform buffer holds every draw at a multiple of the alignment, the storage buffer packs them
+        memcpy(uniforms + uniformStride * i, &draw, sizeof(DrawData));
+        memcpy(storage + sizeof(DrawData) * i, &draw, sizeof(DrawData));
+    }
+}
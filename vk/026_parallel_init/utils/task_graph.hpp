@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// a set of tasks with dependencies between them, run on a pool of threads
+// a task starts as soon as every task it depends on has finished, so tasks that don't depend on each other run at the same time
+// tasks are added in an order where dependencies come first: a task can only depend on tasks that were added before it,
+// which also means the graph can't have cycles
+// every task is timed, report() prints when each task ran and for how long
+class TaskGraph
+{
+public:
+    using TaskId = size_t;
+
+    TaskId add(const char* name, std::function<void()> work, std::vector<TaskId> dependencies = {})
+    {
+        TaskId id = m_tasks.size();
+        for (TaskId dependency : dependencies)
+        {
+            if (dependency >= id)
+                throw std::runtime_error("A task can only depend on tasks added before it");
+
+            m_tasks[dependency].dependents.push_back(id);
+        }
+
+        Task task;
+        task.name = name;
+        task.work = std::move(work);
+        task.dependencyCount = dependencies.size();
+        m_tasks.push_back(std::move(task));
+
+        return id;
+    }
+
+    // runs every task and returns when they've all finished
+    // the calling thread is one of the threads, so a thread count of 1 runs the tasks one after the other, in the order they
+    // become ready: a task that was added early can still run after later ones, once the last of its dependencies finishes
+    // if a task throws, the tasks that haven't started yet are skipped, and the first exception is rethrown here
+    void run(uint32_t threadCount = std::thread::hardware_concurrency())
+    {
+        threadCount = std::max(1u, threadCount);
+
+        m_ready.clear();
+        m_finished = 0;
+        m_error = nullptr;
+        for (TaskId id = 0; id < m_tasks.size(); id++)
+        {
+            m_tasks[id].remaining = m_tasks[id].dependencyCount;
+            if (m_tasks[id].remaining == 0)
+                m_ready.push_back(id);
+        }
+
+        m_start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; i++)
+            threads.emplace_back(&TaskGraph::work, this);
+        work();
+
+        for (std::thread& thread : threads)
+            thread.join();
+
+        m_end = std::chrono::steady_clock::now();
+
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+    // prints the start and duration of every task in milliseconds, relative to the start of run()
+    // the sum of the task durations against the time run() took shows how much of the work overlapped
+    void report() const
+    {
+        double total = 0;
+        for (const Task& task : m_tasks)
+        {
+            double start = milliseconds(m_start, task.start);
+            double duration = milliseconds(task.start, task.end);
+            printf("  %-28s %8.2f ms at %8.2f ms\n", task.name, duration, start);
+            total += duration;
+        }
+
+        printf("  %zu tasks took %.2f ms, %.2f ms of work\n", m_tasks.size(), milliseconds(m_start, m_end), total);
+    }
+
+private:
+    struct Task
+    {
+        const char* name;
+        std::function<void()> work;
+        std::vector<TaskId> dependents;
+        size_t dependencyCount = 0;
+        size_t remaining = 0;
+        std::chrono::steady_clock::time_point start, end;
+    };
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            // tasks are picked in the order they became ready, oldest first
+            m_condition.wait(lock, [this] { return !m_ready.empty() || m_finished == m_tasks.size(); });
+            if (m_finished == m_tasks.size())
+                break;
+
+            TaskId id = m_ready.front();
+            m_ready.erase(m_ready.begin());
+            Task& task = m_tasks[id];
+
+            // the task runs without the lock, the graph is only touched while holding it
+            bool skip = m_error != nullptr;
+            lock.unlock();
+            task.start = std::chrono::steady_clock::now();
+            std::exception_ptr error = nullptr;
+            if (!skip)
+            {
+                try
+                {
+                    task.work();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+            }
+            task.end = std::chrono::steady_clock::now();
+            lock.lock();
+
+            if (error && !m_error)
+                m_error = error;
+
+            // a failed or skipped task still releases its dependents, which are skipped in turn
+            for (TaskId dependent : task.dependents)
+            {
+                if (--m_tasks[dependent].remaining == 0)
+                    m_ready.push_back(dependent);
+            }
+
+            m_finished++;
+            m_condition.notify_all();
+        }
+    }
+
+    static double milliseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    std::vector<Task> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<TaskId> m_ready;
+    size_t m_finished = 0;
+    std::exception_ptr m_error;
+
+    std::chrono::steady_clock::time_point m_start, m_end;
+};
@@ -0,0 +1,24 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+
+layout(location = 0) out vec3 fragColor;
+
+// storage buffer: every draw's data lives in one array, indexed by the draw's first instance
+struct DrawData {
+    vec2 offset;
+    float scale;
+    vec4 color;
+};
+
+layout(set = 0, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+#define draw draws[gl_InstanceIndex]
+
+void main() {
+    gl_Position = vec4(position.xy * draw.scale + draw.offset, position.z, 1.0);
+    fragColor = color * draw.color.rgb;
+}
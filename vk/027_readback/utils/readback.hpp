@@ -0,0 +1,264 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <stb_image_write.h>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "buffer.hpp"
+#include "memory.hpp"
+
+// copies rendered images into a ring of persistently mapped buffers, and writes them to PNG files on worker threads
+// the render loop never waits on a readback: a copy's fence is polled, and once it's signaled the buffer goes to an encoder
+// thread, which hands the buffer back to the ring when the file is written. if every buffer is still copying or encoding
+// when a frame wants one, that frame simply isn't captured, so slow encoding drops captures instead of slowing down rendering
+class ReadbackRing
+{
+public:
+    ReadbackRing(VkDevice device, VkPhysicalDevice physicalDevice, const QueueFamilies& families, VkExtent2D extent, VkFormat format, uint32_t slotCount, uint32_t encoderCount, std::string outputPrefix)
+        : m_device(device), m_extent(extent), m_outputPrefix(outputPrefix)
+    {
+        // PNG stores RGBA, formats that store BGRA are swizzled while encoding
+        m_swizzle = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+        // the CPU reads every byte of these buffers, which is many times faster from cached memory
+        // cached memory isn't always coherent, the encoder then invalidates the buffer before reading it
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        {
+            VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+            if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT))
+            {
+                memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                break;
+            }
+        }
+
+        // fences are created unsignaled, a slot's fence is only waited on after a copy was submitted with it
+        VkFenceCreateInfo fenceInfo { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0 };
+
+        m_slots.resize(slotCount);
+        for (Slot& slot : m_slots)
+        {
+            slot.buffer = Buffer::create(device, physicalDevice, families, VkDeviceSize(extent.width) * extent.height * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryFlags);
+            slot.buffer->map();
+            THROW_IF_FAILED(vkCreateFence(device, &fenceInfo, nullptr, &slot.fence));
+        }
+
+        // the type a buffer ends up in is the first one its requirements allow, which doesn't have to be the cached type
+        // found above. whether the encoders invalidate depends on that type, not on the first cached one
+        VkMemoryRequirements memoryReqs;
+        vkGetBufferMemoryRequirements(device, m_slots[0].buffer->buffer, &memoryReqs);
+        uint32_t memoryType = Memory::select(physicalDevice, memoryReqs, memoryFlags);
+        m_coherent = (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        for (uint32_t i = 0; i < encoderCount; i++)
+            m_encoders.emplace_back(&ReadbackRing::encode, this);
+    }
+
+    // waits for the submitted copies and the encoders to finish, so every captured frame ends up on disk
+    ~ReadbackRing()
+    {
+        for (Slot& slot : m_slots)
+        {
+            if (slot.state == SlotState::Copying)
+                vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        }
+        poll();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (std::thread& encoder : m_encoders)
+            encoder.join();
+
+        for (Slot& slot : m_slots)
+            vkDestroyFence(m_device, slot.fence, nullptr);
+    }
+
+    // only 8 bit RGBA and BGRA images can be written without converting every pixel
+    static bool supported(VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // returns a free slot to copy the given frame into, or -1 if every slot is still busy
+    int32_t acquire(uint32_t frame)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_slots.size(); i++)
+        {
+            size_t index = (m_next + i) % m_slots.size();
+            Slot& slot = m_slots[index];
+            if (slot.state != SlotState::Free)
+                continue;
+
+            THROW_IF_FAILED(vkResetFences(m_device, 1, &slot.fence));
+            slot.state = SlotState::Copying;
+            slot.frame = frame;
+            m_next = index + 1;
+            m_captured++;
+            return static_cast<int32_t>(index);
+        }
+
+        m_skipped++;
+        return -1;
+    }
+
+    // records the copy of a rendered image into the slot's buffer
+    // the image is expected in the transfer source layout, with the render pass's dependency making the copy wait for it
+    void record(VkCommandBuffer cmd, int32_t slot, VkImage image)
+    {
+        // a buffer row length and height of 0 packs the rows tightly, 4 bytes per pixel
+        VkBufferImageCopy region {};
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { m_extent.width, m_extent.height, 1 };
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_slots[slot].buffer->buffer, 1, &region);
+
+        // make the copy's writes visible to the host, the fence then tells the host when it can read them
+        VkBufferMemoryBarrier toHost {};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.pNext = nullptr;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = m_slots[slot].buffer->buffer;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 0, nullptr);
+    }
+
+    // the fence to submit after the commands that copy into the slot
+    VkFence fence(int32_t slot) const { return m_slots[slot].fence; }
+
+    // hands every finished copy to the encoders, never blocks on the GPU
+    void poll()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_slots.size(); i++)
+        {
+            Slot& slot = m_slots[i];
+            if (slot.state != SlotState::Copying || vkGetFenceStatus(m_device, slot.fence) != VK_SUCCESS)
+                continue;
+
+            slot.state = SlotState::Encoding;
+            m_queue.push_back(i);
+            m_condition.notify_one();
+        }
+    }
+
+    uint32_t captured() const { return m_captured; }
+    uint32_t skipped() const { return m_skipped; }
+    uint32_t encoded() { std::lock_guard<std::mutex> lock(m_mutex); return m_encoded; }
+
+private:
+    enum class SlotState
+    {
+        Free,
+        Copying,
+        Encoding
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<Buffer> buffer;
+        VkFence fence;
+        SlotState state = SlotState::Free;
+        uint32_t frame = 0;
+    };
+
+    void encode()
+    {
+        // every encoder swizzles into its own memory
+        std::vector<uint8_t> pixels;
+        uint32_t rowPitch = m_extent.width * 4;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_condition.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+            if (m_queue.empty())
+                break;
+
+            Slot& slot = m_slots[m_queue.front()];
+            m_queue.pop_front();
+            lock.unlock();
+
+            if (!m_coherent)
+            {
+                VkMappedMemoryRange range { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, slot.buffer->memory, 0, VK_WHOLE_SIZE };
+                vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+            }
+
+            char path[512];
+            snprintf(path, sizeof(path), "%s%06u.png", m_outputPrefix.c_str(), slot.frame);
+
+            // swizzling copies the image out of the slot, which can then take the next copy while this one is being compressed
+            const uint8_t* data = slot.buffer->mapped;
+            if (m_swizzle)
+            {
+                pixels.resize(rowPitch * m_extent.height);
+                for (size_t i = 0; i < pixels.size(); i += 4)
+                {
+                    pixels[i + 0] = data[i + 2];
+                    pixels[i + 1] = data[i + 1];
+                    pixels[i + 2] = data[i + 0];
+                    pixels[i + 3] = data[i + 3];
+                }
+                data = pixels.data();
+
+                lock.lock();
+                slot.state = SlotState::Free;
+                lock.unlock();
+            }
+
+            if (stbi_write_png(path, m_extent.width, m_extent.height, 4, data, rowPitch) == 0)
+                printf("Failed to write %s\n", path);
+
+            lock.lock();
+            if (!m_swizzle)
+                slot.state = SlotState::Free;
+            m_encoded++;
+        }
+    }
+
+    VkDevice m_device;
+    VkExtent2D m_extent;
+    std::string m_outputPrefix;
+    bool m_swizzle = false;
+    bool m_coherent = true;
+
+    std::vector<Slot> m_slots;
+    size_t m_next = 0;
+    uint32_t m_captured = 0;
+    uint32_t m_skipped = 0;
+    uint32_t m_encoded = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<size_t> m_queue;
+    std::vector<std::thread> m_encoders;
+    bool m_stopping = false;
+};
@@ -0,0 +1,836 @@
+// this sample is a regression test for the first samples: it renders the frame each of 000 to 005 shows after a fixed
+// number of frames, without a window, reads it back and compares it with a reference image that's checked in
+// the samples themselves need a window and a swapchain, so the test renders their scenes into an image of the same size
+// instead: the same clear colors, geometry and draws, through the samples' own compiled shaders. a change to one of those
+// shaders or to the way the scenes are drawn shows up as a failed comparison
+// references are written by --update, ideally on a software implementation (e.g. lavapipe, selected through
+// VK_ICD_FILENAMES), which renders the same on every machine. CPU devices are preferred over GPUs for the same reason
+// the references that are checked in were computed from Vulkan's rasterization rules without a driver, regenerate them on lavapipe
+// a comparison passes when few enough pixels are further off than the per-channel tolerance, the image as a whole is
+// close enough in PSNR, and it looks the same by SSIM, a perceptual metric that compares the brightness, contrast and
+// structure of small blocks. the diff kernel uses SSE2 or NEON, so large image sets are compared in far less time than rendered
+// --update writes the references, --frames N renders N frames per scene (default 60), --tolerance N is the per-channel
+// tolerance (default 2), --max-differing P the percentage of pixels allowed over it (default 0.1), --min-psnr dB the
+// lowest PSNR that passes (default 40), --min-ssim S the lowest SSIM that passes (default 0.99), --references dir
+// overrides where the references are read from and written to
+// the process exits with 1 when any scene fails, so it can run as a step of a build, and with 77 when there's no Vulkan
+// implementation or no device that can render, which CTest reports as a skipped test instead of a failed one
+
+// see lines
+// * 119 The scenes of samples 000 to 005, with their clear colors, shaders and geometry
+// * 138 Preferred a CPU device, and created a device without a surface or swapchain
+// * 210 Rendered every scene into an offscreen image for a fixed number of frames, and copied the last one to a buffer
+// * 296 Compared the result with the reference, or wrote the reference with --update
+// * image_diff.hpp: a per-pixel tolerance and PSNR comparison, with SSE2 and NEON kernels, and SSIM
+// * png.hpp: reading and writing references as PNG
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+#include <filesystem>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/queue_families.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/image.hpp"
+#include "utils/image_diff.hpp"
+
+// stb_image_write is a single header library, its implementation is compiled in exactly one source file
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "utils/png.hpp"
+
+// everything that makes up the frame one of the samples renders
+// 000 only clears, 001 draws a triangle that's defined in its vertex shader, 002 and 003 draw two triangles from a vertex
+// buffer, 004 draws the same quad from an index buffer, and 005 fades the quad's colors with a push constant
+struct Scene
+{
+    const char* name;
+    float clearColor[4];
+    const char* vertexShader = nullptr; // no shaders: the scene is only cleared
+    const char* fragmentShader = nullptr;
+    std::vector<float> vertices; // { float3 pos, float3 color }, empty when the vertex shader has its own
+    std::vector<uint32_t> indices; // empty: vertices are drawn in order
+    bool fade = false;
+};
+
+VkInstance createInstance();
+VkPhysicalDevice selectPhysicalDevice(VkInstance instance, QueueFamilies* outFamilies);
+VkDevice createDevice(VkPhysicalDevice physicalDevice, int32_t graphicsFamily);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkRenderPass createRenderpass(VkDevice device, VkFormat format);
+VkPipelineLayout createPipelineLayout(VkDevice device);
+VkPipeline createPipeline(VkDevice device, VkExtent2D extent, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader, bool vertexInput);
+
+int main(int argc, char** argv) {
+    bool update = false;
+    uint32_t frameCount = 60;
+    uint8_t tolerance = 2;
+    double maxDifferingPercentage = 0.1;
+    double minPsnr = 40;
+    double minSsim = 0.99;
+    std::string referenceDirectory = "../028_golden_images/references/";
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+            update = true;
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frameCount = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = static_cast<uint8_t>(std::max(0, std::min(255, atoi(argv[++i]))));
+        if (strcmp(argv[i], "--max-differing") == 0 && i + 1 < argc)
+            maxDifferingPercentage = atof(argv[++i]);
+        if (strcmp(argv[i], "--min-psnr") == 0 && i + 1 < argc)
+            minPsnr = atof(argv[++i]);
+        if (strcmp(argv[i], "--min-ssim") == 0 && i + 1 < argc)
+            minSsim = atof(argv[++i]);
+        if (strcmp(argv[i], "--references") == 0 && i + 1 < argc)
+            referenceDirectory = std::string(argv[++i]) + "/";
+    }
+    
+    // the vertices of 002 to 005, 0.0 is the center of the screen, -1,-1 is top left and 1,1 is bottom right
+    std::vector<float> triangles {
+        -0.5, -0.5, 0.0,     1.0, 0.0, 0.0,
+        0.5, 0.5, 0.0,       0.0, 1.0, 0.0,
+        -0.5, 0.5, 0.0,      0.0, 0.0, 1.0,
+        
+        -0.5, -0.5, 0.0,     1.0, 0.0, 0.0,
+        0.5, -0.5, 0.0,      0.0, 0.0, 1.0,
+        0.5, 0.5, 0.0,       0.0, 1.0, 0.0
+    };
+    std::vector<float> quad {
+        -0.5, -0.5, 0.0,     1.0, 0.0, 0.0,
+        0.5, 0.5, 0.0,       0.0, 1.0, 0.0,
+        -0.5, 0.5, 0.0,      0.0, 0.0, 1.0,
+        0.5, -0.5, 0.0,      0.0, 0.0, 1.0
+    };
+    std::vector<uint32_t> quadIndices { 0, 1, 2, 0, 3, 1 };
+    
+    std::vector<Scene> scenes {
+        Scene { "000_clear", { 1, 0, 1, 1 } },
+        Scene { "001_triangle", { 0, 0, 0, 1 }, "../001_triangle/vertex.spv", "../001_triangle/fragment.spv" },
+        Scene { "002_vertex_buffer", { 0, 0, 0, 1 }, "../002_vertex_buffer/vertex.spv", "../002_vertex_buffer/fragment.spv", triangles },
+        Scene { "003_restructure", { 0, 0, 0, 1 }, "../003_restructure/vertex.spv", "../003_restructure/fragment.spv", triangles },
+        Scene { "004_index_buffer", { 0, 0, 0, 1 }, "../004_index_buffer/vertex.spv", "../004_index_buffer/fragment.spv", quad, quadIndices },
+        Scene { "005_push_constants", { 0, 0, 0, 1 }, "../005_push_constants/vertex.spv", "../005_push_constants/fragment.spv", quad, quadIndices, true }
+    };
+    
+    // a machine without a Vulkan driver can't say anything about the samples, that's not a failure of the test
+    const int skipped = 77;
+    VkInstance instance = createInstance();
+    if (instance == VK_NULL_HANDLE)
+    {
+        printf("No Vulkan implementation, skipping the test\n");
+        return skipped;
+    }
+    
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice = selectPhysicalDevice(instance, &families);
+    if (physicalDevice == VK_NULL_HANDLE)
+    {
+        printf("No device that can render, skipping the test\n");
+        vkDestroyInstance(instance, nullptr);
+        return skipped;
+    }
+    
+    VkDevice device = createDevice(physicalDevice, families.graphics);
+    VkQueue graphicsQueue; vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+    
+    VkCommandPool commandPool = createCommandPool(device, families.graphics);
+    VkCommandBuffer cmd = allocateCommandBuffer(device, commandPool);
+    
+    // the test waits for every frame, there's nothing else to do in the meantime
+    VkFenceCreateInfo fenceInfo { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0 };
+    VkFence fence;
+    THROW_IF_FAILED(vkCreateFence(device, &fenceInfo, nullptr, &fence));
+    
+    // the samples render 800x800 to a B8G8R8A8_SRGB swapchain, this is the same format with the channels in the order PNG stores them
+    const VkExtent2D extent { 800, 800 };
+    const VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    std::unique_ptr<Image> target = Image::create(device, physicalDevice, format, extent, 1, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    
+    VkRenderPass renderpass = createRenderpass(device, format);
+    
+    VkFramebufferCreateInfo framebufferInfo {};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.pNext = nullptr;
+    framebufferInfo.flags = 0;
+    framebufferInfo.renderPass = renderpass;
+    framebufferInfo.attachmentCount = 1;
+    framebufferInfo.pAttachments = &target->view;
+    framebufferInfo.width = extent.width;
+    framebufferInfo.height = extent.height;
+    framebufferInfo.layers = 1;
+    
+    VkFramebuffer framebuffer;
+    THROW_IF_FAILED(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer));
+    
+    size_t pixelCount = size_t(extent.width) * extent.height;
+    std::unique_ptr<Buffer> readbackBuffer = Buffer::create(device, physicalDevice, families, pixelCount * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    const uint8_t* pixels = readbackBuffer->map();
+    
+    // every scene uses the same layout, the push constant is just never read by the shaders that don't declare it
+    VkPipelineLayout pipelineLayout = createPipelineLayout(device);
+    
+    if (update)
+        std::filesystem::create_directories(referenceDirectory);
+    
+    uint32_t failures = 0;
+    double diffMilliseconds = 0;
+    
+    for (const Scene& scene : scenes)
+    {
+        VkShaderModule vertexShader = VK_NULL_HANDLE, fragmentShader = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (scene.vertexShader != nullptr)
+        {
+            vertexShader = Shader::load(device, scene.vertexShader);
+            fragmentShader = Shader::load(device, scene.fragmentShader);
+            pipeline = createPipeline(device, extent, renderpass, pipelineLayout, vertexShader, fragmentShader, !scene.vertices.empty());
+        }
+        
+        std::unique_ptr<Buffer> vertexBuffer, indexBuffer;
+        if (!scene.vertices.empty())
+            vertexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(float) * scene.vertices.size(), const_cast<float*>(scene.vertices.data()), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        if (!scene.indices.empty())
+            indexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * scene.indices.size(), const_cast<uint32_t*>(scene.indices.data()), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        
+        // render the frames the sample would have rendered, 005's fade advances every frame like it does in the sample
+        // only the last frame is copied to the readback buffer
+        float t = 0;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            bool last = frame + 1 == frameCount;
+            
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.pNext = nullptr;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            beginInfo.pInheritanceInfo = nullptr;
+            vkBeginCommandBuffer(cmd, &beginInfo);
+            
+            VkClearValue clearValue {};
+            memcpy(clearValue.color.float32, scene.clearColor, sizeof(scene.clearColor));
+            
+            VkRenderPassBeginInfo renderpassBegin {};
+            renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderpassBegin.pNext = nullptr;
+            renderpassBegin.renderPass = renderpass;
+            renderpassBegin.framebuffer = framebuffer;
+            renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, extent };
+            renderpassBegin.clearValueCount = 1;
+            renderpassBegin.pClearValues = &clearValue;
+            
+            vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+            
+            if (pipeline != VK_NULL_HANDLE)
+            {
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                
+                if (scene.fade)
+                {
+                    t += 0.01f;
+                    float fade = sin(t);
+                    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &fade);
+                }
+                
+                VkDeviceSize offset = 0;
+                if (vertexBuffer)
+                    vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer->buffer, &offset);
+                
+                if (indexBuffer)
+                {
+                    vkCmdBindIndexBuffer(cmd, indexBuffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+                    vkCmdDrawIndexed(cmd, scene.indices.size(), 1, 0, 0, 0);
+                }
+                else
+                    vkCmdDraw(cmd, vertexBuffer ? scene.vertices.size() / 6 : 3, 1, 0, 0);
+            }
+            
+            vkCmdEndRenderPass(cmd);
+            
+            // the render pass leaves the image in TRANSFER_SRC_OPTIMAL, and its external dependency makes the copy wait for it
+            if (last)
+            {
+                VkBufferImageCopy region {};
+                region.bufferOffset = 0;
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+                region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+                region.imageOffset = { 0, 0, 0 };
+                region.imageExtent = { extent.width, extent.height, 1 };
+                vkCmdCopyImageToBuffer(cmd, target->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer->buffer, 1, &region);
+                
+                VkBufferMemoryBarrier toHost { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, readbackBuffer->buffer, 0, VK_WHOLE_SIZE };
+                vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 0, nullptr);
+            }
+            
+            vkEndCommandBuffer(cmd);
+            
+            VkSubmitInfo submit{};
+            submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit.pNext = nullptr;
+            submit.waitSemaphoreCount = 0;
+            submit.pWaitSemaphores = nullptr;
+            submit.pWaitDstStageMask = nullptr;
+            submit.commandBufferCount = 1;
+            submit.pCommandBuffers = &cmd;
+            submit.signalSemaphoreCount = 0;
+            submit.pSignalSemaphores = nullptr;
+            THROW_IF_FAILED(vkQueueSubmit(graphicsQueue, 1, &submit, fence));
+            THROW_IF_FAILED(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
+            THROW_IF_FAILED(vkResetFences(device, 1, &fence));
+        }
+        
+        std::string referencePath = referenceDirectory + scene.name + ".png";
+        if (update)
+        {
+            if (!Png::write(referencePath, extent.width, extent.height, pixels))
+                throw std::runtime_error("Failed to write " + referencePath);
+            printf("%-20s reference written to %s\n", scene.name, referencePath.c_str());
+        }
+        else
+        {
+            uint32_t width, height;
+            std::vector<uint8_t> reference;
+            if (!Png::read(referencePath, &width, &height, &reference))
+            {
+                printf("%-20s FAILED, no reference at %s (run with --update to create it)\n", scene.name, referencePath.c_str());
+                failures++;
+            }
+            else if (width != extent.width || height != extent.height)
+            {
+                printf("%-20s FAILED, the reference is %ux%u instead of %ux%u\n", scene.name, width, height, extent.width, extent.height);
+                failures++;
+            }
+            else
+            {
+                auto diffStart = std::chrono::steady_clock::now();
+                ImageDiff::Result diff = ImageDiff::compare(pixels, reference.data(), pixelCount, tolerance);
+                double ssim = ImageDiff::ssim(pixels, reference.data(), extent.width, extent.height);
+                diffMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - diffStart).count();
+                
+                bool passed = diff.differingPercentage() <= maxDifferingPercentage && diff.psnr() >= minPsnr && ssim >= minSsim;
+                printf("%-20s %s, %llu pixels (%.3f%%) over the tolerance, max error %u, PSNR %.2f dB, SSIM %.4f\n", scene.name, passed ? "passed" : "FAILED",
+                    static_cast<unsigned long long>(diff.differingPixels), diff.differingPercentage(), diff.maxError, diff.psnr(), ssim);
+                
+                // keep what was rendered next to the reference, to look at the difference
+                if (!passed)
+                {
+                    std::string actualPath = referenceDirectory + scene.name + ".actual.png";
+                    if (Png::write(actualPath, extent.width, extent.height, pixels))
+                        printf("%-20s rendered image written to %s\n", "", actualPath.c_str());
+                    failures++;
+                }
+            }
+        }
+        
+        vertexBuffer.reset();
+        indexBuffer.reset();
+        if (pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, pipeline, nullptr);
+            vkDestroyShaderModule(device, vertexShader, nullptr);
+            vkDestroyShaderModule(device, fragmentShader, nullptr);
+        }
+    }
+    
+    if (!update)
+        printf("%zu scenes, %u failed, %.3f ms comparing\n", scenes.size(), failures, diffMilliseconds);
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    vkDeviceWaitIdle(device);
+    
+    readbackBuffer.reset();
+    target.reset();
+    
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyFramebuffer(device, framebuffer, nullptr);
+    vkDestroyRenderPass(device, renderpass, nullptr);
+    vkDestroyFence(device, fence, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    return failures == 0 ? 0 : 1;
+}
+
+VkInstance createInstance()
+{
+    // there's no window, so none of the surface extensions GLFW asks for are needed
+    Extensions extensionHelper{};
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "028_golden_images";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    // the loader fails with VK_ERROR_INCOMPATIBLE_DRIVER when it finds no driver at all, main() skips the test then
+    VkInstance instance;
+    VkResult result = vkCreateInstance(&instanceInfo, nullptr, &instance);
+    if (result == VK_ERROR_INCOMPATIBLE_DRIVER || result == VK_ERROR_INITIALIZATION_FAILED)
+        return VK_NULL_HANDLE;
+    THROW_IF_FAILED(result);
+    return instance;
+}
+
+VkPhysicalDevice selectPhysicalDevice(VkInstance instance, QueueFamilies* outFamilies)
+{
+    uint32_t count;
+    THROW_IF_FAILED(vkEnumeratePhysicalDevices(instance, &count, nullptr));
+    std::vector<VkPhysicalDevice> physicalDevices(count);
+    THROW_IF_FAILED(vkEnumeratePhysicalDevices(instance, &count, physicalDevices.data()));
+    
+    // a software implementation renders the same image on every machine, so it's picked over any GPU
+    // without one, the first device that can render is used, and the references only hold on devices of the same kind
+    VkPhysicalDevice selected = VK_NULL_HANDLE;
+    int32_t selectedFamily = -1;
+    for (VkPhysicalDevice physicalDevice : physicalDevices)
+    {
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueFamilyProperties.data());
+        
+        int32_t graphicsFamily = -1;
+        for (uint32_t i = 0; i < count && graphicsFamily == -1; i++)
+        {
+            if ((queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == VK_QUEUE_GRAPHICS_BIT)
+                graphicsFamily = i;
+        }
+        
+        if (graphicsFamily == -1)
+            continue;
+        
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (selected == VK_NULL_HANDLE || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+        {
+            selected = physicalDevice;
+            selectedFamily = graphicsFamily;
+            if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+                break;
+        }
+    }
+    
+    if (selected == VK_NULL_HANDLE)
+        return VK_NULL_HANDLE;
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(selected, &properties);
+    printf("Rendering on %s%s\n", properties.deviceName, properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU ? "" : " (not a CPU device, references may not match other machines)");
+    
+    // nothing is presented, the buffers are only used by the graphics family
+    outFamilies->graphics = selectedFamily;
+    outFamilies->present = selectedFamily;
+    return selected;
+}
+
+VkDevice createDevice(VkPhysicalDevice physicalDevice, int32_t graphicsFamily)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 1> priorities = { 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // the only queue, there's nothing to present
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_portability_subset");
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = nullptr;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkRenderPass createRenderpass(VkDevice device, VkFormat format)
+{
+    // next we'll describe a render pass
+    // renderpasses are like a pre-defined render graph
+    // they define sub passes and how they interact with their (and each other's) attachments
+    // this can help greatly improve performance on mobile devices
+    // our renderpass will be fairly simple: 1 subpass with 1 color attachment
+    
+    // describe our color attachment:
+    // - how its used
+    // - how its loaded/stored
+    // - what its layout will be before/after the pass
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = format;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT; // msaa
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // the image is copied to a buffer right after
+    
+    // subpasses must describe their attachments and in what layout they wish to use them
+    // during a renderpass, attachments are transitioned to a subpass's desired layout
+    // thus our attachment starts as UNDEFINED, transitions to COLOR_ATTACHMENT during our subpass, and at the end of the renderpass it transitions to TRANSFER_SRC
+    VkAttachmentReference colorRef {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    // describe a simple graphics (not compute) subpass with a single color attachment
+    VkSubpassDescription subpass {};
+    subpass.flags = 0;
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.inputAttachmentCount = 0;
+    subpass.pInputAttachments = nullptr;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    subpass.preserveAttachmentCount = 0;
+    subpass.pPreserveAttachments = nullptr;
+    
+    // the copy after the renderpass reads what the subpass wrote, and waits for it through this dependency
+    VkSubpassDependency copyDependency {};
+    copyDependency.srcSubpass = 0;
+    copyDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    copyDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    copyDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    copyDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    copyDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    copyDependency.dependencyFlags = 0;
+    
+    // create a renderpass with the described color attachment and subpass
+    VkRenderPassCreateInfo renderpassInfo {};
+    renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderpassInfo.pNext = nullptr;
+    renderpassInfo.flags = 0;
+    renderpassInfo.attachmentCount = 1;
+    renderpassInfo.pAttachments = &colorAttachment;
+    renderpassInfo.subpassCount = 1;
+    renderpassInfo.pSubpasses = &subpass;
+    renderpassInfo.dependencyCount = 1;
+    renderpassInfo.pDependencies = &copyDependency;
+    
+    VkRenderPass renderpass;
+    THROW_IF_FAILED(vkCreateRenderPass(device, &renderpassInfo, nullptr, &renderpass));
+    
+    return renderpass;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device)
+{
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(float);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // our sample shaders have no bindings so this structure receives default values:
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 0;
+    pipelineLayoutInfo.pSetLayouts = nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, VkExtent2D extent, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader, bool vertexInput)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // describe our vertex and fragment shader (shader stage, entry point) for the pipeline
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            vertexShader,
+            "main",
+            nullptr
+        },
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            fragmentShader,
+            "main",
+            nullptr
+        }
+    };
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 color)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    // 001's vertex shader has its triangle built in, and takes no vertex input at all
+    pipelineVertexInput.vertexBindingDescriptionCount = vertexInput ? 1 : 0;
+    pipelineVertexInput.pVertexBindingDescriptions = vertexInput ? &vertexBinding : nullptr;
+    pipelineVertexInput.vertexAttributeDescriptionCount = vertexInput ? vertexAttributes.size() : 0;
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexInput ? vertexAttributes.data() : nullptr;
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = extent.width;
+    viewport.height = extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // these default values disable depth and stencil testing:
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = false;
+    pipelineDepthStencilState.depthWriteEnable = false;
+    pipelineDepthStencilState.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0; // subpass index 0
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGE_DIFF_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_DIFF_NEON
+#endif
+
+// compares two RGBA8 images of the same size, ignoring alpha
+// a pixel differs when any of its color channels is off by more than the tolerance, which absorbs the rounding
+// differences between drivers. the squared error of every channel adds up to the image's PSNR, which tells a pixel
+// that's slightly off everywhere apart from a visible change in a few places
+// the kernel compares 4 pixels per instruction with SSE2 or NEON, and falls back to plain C++ on other platforms
+// neither the tolerance nor PSNR says much about what a viewer sees: ssim() is the perceptual check, it compares the
+// brightness, contrast and structure of small blocks of the two images, the way the eye picks up on differences
+class ImageDiff
+{
+public:
+    struct Result
+    {
+        uint64_t pixelCount = 0;
+        uint64_t differingPixels = 0;
+        uint64_t squaredError = 0;
+        uint8_t maxError = 0;
+
+        double differingPercentage() const { return pixelCount == 0 ? 0.0 : 100.0 * differingPixels / pixelCount; }
+
+        // peak signal to noise ratio in dB, identical images have an infinite PSNR
+        double psnr() const
+        {
+            if (squaredError == 0)
+                return INFINITY;
+
+            double meanSquaredError = static_cast<double>(squaredError) / (pixelCount * 3);
+            return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+        }
+    };
+
+    static Result compare(const uint8_t* a, const uint8_t* b, size_t pixelCount, uint8_t tolerance)
+    {
+        Result result;
+        result.pixelCount = pixelCount;
+
+        size_t i = 0;
+#if defined(IMAGE_DIFF_SSE2)
+        const __m128i colorMask = _mm_set1_epi32(0x00ffffff);
+        const __m128i toleranceBytes = _mm_set1_epi8(static_cast<char>(tolerance));
+        const __m128i zero = _mm_setzero_si128();
+        __m128i squared = _mm_setzero_si128();
+        __m128i maximum = _mm_setzero_si128();
+        for (; i + 4 <= pixelCount; i += 4)
+        {
+            __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4));
+            __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4));
+
+            // |a - b| per byte is the larger of the two saturated differences, alpha is masked out
+            __m128i difference = _mm_and_si128(_mm_or_si128(_mm_subs_epu8(pa, pb), _mm_subs_epu8(pb, pa)), colorMask);
+            maximum = _mm_max_epu8(maximum, difference);
+
+            // whatever is left after subtracting the tolerance is over it, a pixel is within tolerance when nothing is left
+            __m128i within = _mm_cmpeq_epi32(_mm_subs_epu8(difference, toleranceBytes), zero);
+            result.differingPixels += 4 - popcount4(_mm_movemask_ps(_mm_castsi128_ps(within)));
+
+            // squares of 16 bit differences, summed in pairs, then widened to 64 bit so large images can't overflow
+            __m128i low = _mm_unpacklo_epi8(difference, zero);
+            __m128i high = _mm_unpackhi_epi8(difference, zero);
+            __m128i sums = _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high));
+            squared = _mm_add_epi64(squared, _mm_unpacklo_epi32(sums, zero));
+            squared = _mm_add_epi64(squared, _mm_unpackhi_epi32(sums, zero));
+        }
+
+        uint64_t squaredLanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(squaredLanes), squared);
+        result.squaredError = squaredLanes[0] + squaredLanes[1];
+
+        uint8_t maximumLanes[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maximumLanes), maximum);
+        for (uint8_t lane : maximumLanes)
+            result.maxError = lane > result.maxError ? lane : result.maxError;
+#elif defined(IMAGE_DIFF_NEON)
+        const uint8x16_t colorMask = vreinterpretq_u8_u32(vdupq_n_u32(0x00ffffff));
+        const uint8x16_t toleranceBytes = vdupq_n_u8(tolerance);
+        uint64x2_t squared = vdupq_n_u64(0);
+        uint8x16_t maximum = vdupq_n_u8(0);
+        uint32x4_t differing = vdupq_n_u32(0);
+        for (; i + 4 <= pixelCount; i += 4)
+        {
+            uint8x16_t difference = vandq_u8(vabdq_u8(vld1q_u8(a + i * 4), vld1q_u8(b + i * 4)), colorMask);
+            maximum = vmaxq_u8(maximum, difference);
+
+            // a lane of all ones for every pixel with something left over the tolerance, counted as 1 each
+            uint32x4_t over = vtstq_u32(vreinterpretq_u32_u8(vqsubq_u8(difference, toleranceBytes)), vdupq_n_u32(~0u));
+            differing = vsubq_u32(differing, over);
+
+            uint16x8_t low = vmull_u8(vget_low_u8(difference), vget_low_u8(difference));
+            uint16x8_t high = vmull_u8(vget_high_u8(difference), vget_high_u8(difference));
+            squared = vpadalq_u32(squared, vaddq_u32(vpaddlq_u16(low), vpaddlq_u16(high)));
+        }
+
+        result.squaredError = vgetq_lane_u64(squared, 0) + vgetq_lane_u64(squared, 1);
+        result.differingPixels = vgetq_lane_u32(differing, 0) + vgetq_lane_u32(differing, 1) + vgetq_lane_u32(differing, 2) + vgetq_lane_u32(differing, 3);
+
+        uint8_t maximumLanes[16];
+        vst1q_u8(maximumLanes, maximum);
+        for (uint8_t lane : maximumLanes)
+            result.maxError = lane > result.maxError ? lane : result.maxError;
+#endif
+
+        // whatever doesn't fill a vector, or everything on platforms without one
+        for (; i < pixelCount; i++)
+        {
+            bool differs = false;
+            for (size_t c = 0; c < 3; c++)
+            {
+                int difference = std::abs(static_cast<int>(a[i * 4 + c]) - static_cast<int>(b[i * 4 + c]));
+                differs |= difference > tolerance;
+                result.squaredError += difference * difference;
+                result.maxError = difference > result.maxError ? static_cast<uint8_t>(difference) : result.maxError;
+            }
+
+            result.differingPixels += differs ? 1 : 0;
+        }
+
+        return result;
+    }
+
+    // mean structural similarity (Wang et al. 2004) of the luma of two RGBA8 images, over 8x8 blocks that don't overlap
+    // 1 means the images are identical, noise and rounding barely lower it, while a moved edge or a change in color
+    // gradients lowers it a lot more than the squared error would suggest. a partial block at the border is left out
+    static double ssim(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height)
+    {
+        const uint32_t blockSize = 8;
+        const double c1 = (0.01 * 255) * (0.01 * 255);
+        const double c2 = (0.03 * 255) * (0.03 * 255);
+        const double count = blockSize * blockSize;
+
+        double sum = 0;
+        uint32_t blocks = 0;
+        for (uint32_t by = 0; by + blockSize <= height; by += blockSize)
+        {
+            for (uint32_t bx = 0; bx + blockSize <= width; bx += blockSize)
+            {
+                double sumA = 0, sumB = 0, sumAA = 0, sumBB = 0, sumAB = 0;
+                for (uint32_t y = by; y < by + blockSize; y++)
+                {
+                    for (uint32_t x = bx; x < bx + blockSize; x++)
+                    {
+                        double la = luma(a + (size_t(y) * width + x) * 4);
+                        double lb = luma(b + (size_t(y) * width + x) * 4);
+                        sumA += la;
+                        sumB += lb;
+                        sumAA += la * la;
+                        sumBB += lb * lb;
+                        sumAB += la * lb;
+                    }
+                }
+
+                double meanA = sumA / count, meanB = sumB / count;
+                double varianceA = sumAA / count - meanA * meanA;
+                double varianceB = sumBB / count - meanB * meanB;
+                double covariance = sumAB / count - meanA * meanB;
+                sum += ((2 * meanA * meanB + c1) * (2 * covariance + c2)) / ((meanA * meanA + meanB * meanB + c1) * (varianceA + varianceB + c2));
+                blocks++;
+            }
+        }
+
+        return blocks == 0 ? 1.0 : sum / blocks;
+    }
+
+private:
+    // BT.601 luma of the stored, gamma encoded values
+    static double luma(const uint8_t* pixel)
+    {
+        return 0.299 * pixel[0] + 0.587 * pixel[1] + 0.114 * pixel[2];
+    }
+
+    static uint32_t popcount4(int mask)
+    {
+        return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+    }
+};
@@ -0,0 +1,369 @@
+#pragma once
+#include <stb_image_write.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// reads and writes 8 bit RGB PNG images, the images in memory are RGBA. alpha isn't stored and reads as opaque
+// writing goes through stb_image_write. only the writer ships with the samples, so reading has its own decoder: it takes
+// non-interlaced 8 bit RGB and RGBA images, which covers everything --update writes, and inflates the zlib stream with
+// all three block types (stored, fixed and dynamic Huffman codes), so images saved by other tools load as well
+// the references are mostly flat colors, which compress to a few kilobytes instead of the 1.9 MB a raw 800x800 image takes
+class Png
+{
+public:
+    static bool read(const std::string& path, uint32_t* outWidth, uint32_t* outHeight, std::vector<uint8_t>* outPixels)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+
+        std::vector<uint8_t> data;
+        uint8_t chunk[4096];
+        size_t count;
+        while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            data.insert(data.end(), chunk, chunk + count);
+        fclose(file);
+
+        // a file that isn't a PNG we can read is the same as a missing reference to the caller
+        try
+        {
+            decode(data, outWidth, outHeight, outPixels);
+            return true;
+        }
+        catch (const std::runtime_error&)
+        {
+            return false;
+        }
+    }
+
+    static bool write(const std::string& path, uint32_t width, uint32_t height, const uint8_t* pixels)
+    {
+        std::vector<uint8_t> rgb(size_t(width) * height * 3);
+        for (size_t i = 0; i < size_t(width) * height; i++)
+        {
+            rgb[i * 3 + 0] = pixels[i * 4 + 0];
+            rgb[i * 3 + 1] = pixels[i * 4 + 1];
+            rgb[i * 3 + 2] = pixels[i * 4 + 2];
+        }
+
+        return stbi_write_png(path.c_str(), width, height, 3, rgb.data(), width * 3) != 0;
+    }
+
+private:
+    // a canonical Huffman code: the number of codes of every length, and the symbols sorted by code
+    struct Huffman
+    {
+        uint16_t counts[16];
+        uint16_t symbols[288];
+    };
+
+    // reads the deflate stream least significant bit first, as RFC 1951 packs it
+    struct Bits
+    {
+        const uint8_t* data;
+        size_t size;
+        size_t position = 0;
+        uint32_t buffer = 0;
+        uint32_t count = 0;
+
+        uint32_t get(uint32_t bits)
+        {
+            while (count < bits)
+            {
+                if (position == size)
+                    throw std::runtime_error("Truncated PNG data");
+                buffer |= uint32_t(data[position++]) << count;
+                count += 8;
+            }
+
+            uint32_t value = buffer & ((1u << bits) - 1);
+            buffer >>= bits;
+            count -= bits;
+            return value;
+        }
+    };
+
+    static uint32_t bigEndian(const uint8_t* bytes)
+    {
+        return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | bytes[3];
+    }
+
+    static void decode(const std::vector<uint8_t>& data, uint32_t* outWidth, uint32_t* outHeight, std::vector<uint8_t>* outPixels)
+    {
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        if (data.size() < 8 || memcmp(data.data(), signature, 8) != 0)
+            throw std::runtime_error("Not a PNG file");
+
+        // the image data can be split over any number of IDAT chunks, together they're one zlib stream
+        uint32_t width = 0, height = 0, channels = 0;
+        std::vector<uint8_t> compressed;
+        size_t offset = 8;
+        while (true)
+        {
+            if (data.size() - offset < 12)
+                throw std::runtime_error("Truncated PNG file");
+
+            uint32_t length = bigEndian(&data[offset]);
+            const uint8_t* type = &data[offset + 4];
+            const uint8_t* chunk = &data[offset + 8];
+            if (length > data.size() - offset - 12)
+                throw std::runtime_error("Truncated PNG file");
+
+            if (memcmp(type, "IHDR", 4) == 0)
+            {
+                if (length != 13)
+                    throw std::runtime_error("Malformed PNG header");
+
+                // bit depth 8, color type 2 (RGB) or 6 (RGBA), no interlacing
+                width = bigEndian(chunk);
+                height = bigEndian(chunk + 4);
+                if (chunk[8] != 8 || (chunk[9] != 2 && chunk[9] != 6) || chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0)
+                    throw std::runtime_error("Unsupported PNG format");
+                channels = chunk[9] == 2 ? 3 : 4;
+            }
+            else if (memcmp(type, "IDAT", 4) == 0)
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            else if (memcmp(type, "IEND", 4) == 0)
+                break;
+
+            offset += length + 12;
+        }
+
+        if (width == 0 || height == 0 || compressed.size() < 2 || (compressed[0] & 0x0F) != 8)
+            throw std::runtime_error("Malformed PNG file");
+
+        // every row starts with the byte that selects its filter
+        size_t stride = size_t(width) * channels;
+        std::vector<uint8_t> filtered = inflate(compressed.data() + 2, compressed.size() - 2);
+        if (filtered.size() < (stride + 1) * height)
+            throw std::runtime_error("Truncated PNG data");
+
+        // the filters predict every byte from the one to the left (a), above (b) and above left (c)
+        std::vector<uint8_t> pixels(stride * height);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            uint8_t filter = filtered[y * (stride + 1)];
+            const uint8_t* in = &filtered[y * (stride + 1) + 1];
+            uint8_t* row = &pixels[y * stride];
+            const uint8_t* previous = y > 0 ? row - stride : nullptr;
+            for (size_t x = 0; x < stride; x++)
+            {
+                int a = x >= channels ? row[x - channels] : 0;
+                int b = previous ? previous[x] : 0;
+                int c = previous && x >= channels ? previous[x - channels] : 0;
+
+                int prediction = 0;
+                switch (filter)
+                {
+                case 0: prediction = 0; break;
+                case 1: prediction = a; break;
+                case 2: prediction = b; break;
+                case 3: prediction = (a + b) / 2; break;
+                case 4:
+                {
+                    int p = a + b - c;
+                    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+                    prediction = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Malformed PNG filter");
+                }
+
+                row[x] = static_cast<uint8_t>(in[x] + prediction);
+            }
+        }
+
+        outPixels->resize(size_t(width) * height * 4);
+        for (size_t i = 0; i < size_t(width) * height; i++)
+        {
+            (*outPixels)[i * 4 + 0] = pixels[i * channels + 0];
+            (*outPixels)[i * 4 + 1] = pixels[i * channels + 1];
+            (*outPixels)[i * 4 + 2] = pixels[i * channels + 2];
+            (*outPixels)[i * 4 + 3] = channels == 4 ? pixels[i * channels + 3] : 255;
+        }
+
+        *outWidth = width;
+        *outHeight = height;
+    }
+
+    static void build(Huffman& huffman, const uint8_t* lengths, uint32_t count)
+    {
+        memset(huffman.counts, 0, sizeof(huffman.counts));
+        for (uint32_t i = 0; i < count; i++)
+            huffman.counts[lengths[i]]++;
+        huffman.counts[0] = 0;
+
+        // a code that has more codes of some length than the shorter ones leave room for can't be decoded
+        int32_t left = 1;
+        uint16_t offsets[16] = {};
+        for (uint32_t length = 1; length < 16; length++)
+        {
+            left = left * 2 - huffman.counts[length];
+            if (left < 0)
+                throw std::runtime_error("Malformed PNG Huffman code");
+            offsets[length] = offsets[length - 1] + huffman.counts[length - 1];
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (lengths[i] != 0)
+                huffman.symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+        }
+    }
+
+    // walks the code one bit at a time, the codes of every length are consecutive numbers
+    static uint32_t symbol(Bits& bits, const Huffman& huffman)
+    {
+        int32_t code = 0, first = 0, index = 0;
+        for (uint32_t length = 1; length < 16; length++)
+        {
+            code |= bits.get(1);
+            int32_t count = huffman.counts[length];
+            if (code - first < count)
+                return huffman.symbols[index + code - first];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+
+        throw std::runtime_error("Malformed PNG data");
+    }
+
+    static std::vector<uint8_t> inflate(const uint8_t* data, size_t size)
+    {
+        static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        static const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        Bits bits { data, size };
+        std::vector<uint8_t> out;
+        Huffman lengths, distances;
+
+        uint32_t last = 0;
+        while (!last)
+        {
+            last = bits.get(1);
+            uint32_t type = bits.get(2);
+
+            // stored blocks start at the next byte, with their length and its complement
+            if (type == 0)
+            {
+                bits.buffer = 0;
+                bits.count = 0;
+                if (bits.size - bits.position < 4)
+                    throw std::runtime_error("Truncated PNG data");
+
+                const uint8_t* header = bits.data + bits.position;
+                uint32_t length = header[0] | (header[1] << 8);
+                if ((length ^ (header[2] | (header[3] << 8))) != 0xFFFF || bits.size - bits.position - 4 < length)
+                    throw std::runtime_error("Malformed PNG data");
+
+                out.insert(out.end(), header + 4, header + 4 + length);
+                bits.position += 4 + length;
+                continue;
+            }
+
+            uint8_t codeLengths[320];
+            uint32_t literalCount, distanceCount;
+            if (type == 1)
+            {
+                // the fixed codes every deflate decoder knows
+                literalCount = 288;
+                distanceCount = 30;
+                for (uint32_t i = 0; i < 288; i++)
+                    codeLengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+                for (uint32_t i = 0; i < 30; i++)
+                    codeLengths[288 + i] = 5;
+            }
+            else if (type == 2)
+            {
+                // the block's own codes, whose lengths are themselves Huffman coded and run-length encoded
+                literalCount = bits.get(5) + 257;
+                distanceCount = bits.get(5) + 1;
+                uint32_t codeLengthCount = bits.get(4) + 4;
+                if (literalCount > 286 || distanceCount > 30)
+                    throw std::runtime_error("Malformed PNG data");
+
+                uint8_t lengthLengths[19] = {};
+                for (uint32_t i = 0; i < codeLengthCount; i++)
+                    lengthLengths[codeLengthOrder[i]] = static_cast<uint8_t>(bits.get(3));
+                build(lengths, lengthLengths, 19);
+
+                for (uint32_t i = 0; i < literalCount + distanceCount;)
+                {
+                    uint32_t value = symbol(bits, lengths);
+                    if (value < 16)
+                    {
+                        codeLengths[i++] = static_cast<uint8_t>(value);
+                        continue;
+                    }
+
+                    uint8_t repeated = 0;
+                    uint32_t repeat;
+                    if (value == 16)
+                    {
+                        if (i == 0)
+                            throw std::runtime_error("Malformed PNG data");
+                        repeated = codeLengths[i - 1];
+                        repeat = 3 + bits.get(2);
+                    }
+                    else if (value == 17)
+                        repeat = 3 + bits.get(3);
+                    else
+                        repeat = 11 + bits.get(7);
+
+                    if (i + repeat > literalCount + distanceCount)
+                        throw std::runtime_error("Malformed PNG data");
+                    while (repeat-- > 0)
+                        codeLengths[i++] = repeated;
+                }
+            }
+            else
+                throw std::runtime_error("Malformed PNG data");
+
+            Huffman literals;
+            build(literals, codeLengths, literalCount);
+            build(distances, codeLengths + literalCount, distanceCount);
+
+            // literals are bytes, 256 ends the block, and anything above copies length bytes from distance bytes back
+            while (true)
+            {
+                uint32_t value = symbol(bits, literals);
+                if (value < 256)
+                {
+                    out.push_back(static_cast<uint8_t>(value));
+                    continue;
+                }
+                if (value == 256)
+                    break;
+
+                value -= 257;
+                if (value >= 29)
+                    throw std::runtime_error("Malformed PNG data");
+                uint32_t length = lengthBase[value] + bits.get(lengthExtra[value]);
+
+                uint32_t code = symbol(bits, distances);
+                if (code >= 30)
+                    throw std::runtime_error("Malformed PNG data");
+                uint32_t distance = distanceBase[code] + bits.get(distanceExtra[code]);
+                if (distance > out.size())
+                    throw std::runtime_error("Malformed PNG data");
+
+                // the source can overlap what's being written, which repeats the last distance bytes
+                size_t from = out.size() - distance;
+                for (uint32_t i = 0; i < length; i++)
+                    out.push_back(out[from + i]);
+            }
+        }
+
+        return out;
+    }
+};
@@ -0,0 +1,808 @@
+// this sample renders a batch of jobs offscreen as fast as it can, and writes every result to disk
+// a job is one frame of 005's quad with its own parameters: the fade push constant and the clear color. a parameter sweep
+// of thousands of frames is a job file with thousands of lines, or --sweep N to fade from 0 to 1 over N jobs
+// there's no window and no swapchain, so nothing paces the loop: each frame in flight has its own command buffer and its
+// own offscreen image, and the copy of a finished image goes through 027's readback ring to PNG encoder threads
+// unlike 027, a batch can't drop results. when every ring buffer is busy the loop waits for one, and the time it waits
+// on the GPU and on the encoders is reported next to jobs per second. raising --frames-in-flight helps until the GPU
+// is busy all the time, raising --encoders and --ring helps until the encoders keep up; the wait that stays high tells which
+// of the two the batch is bound by
+// --jobs file reads the jobs from a file, --sweep N generates them, --frames-in-flight N (default 3), --ring N (default
+// frames in flight + encoders), --encoders N (default one less than the number of cores), --output prefix (default job_)
+// and --width/--height set the image size (default 800x800)
+// a job file has one job per line, made of key=value pairs: fade=0.5 clear=0.1,0.1,0.1
+// lines that are empty or start with # are skipped, and keys that are left out keep their defaults (fade=1, a black clear)
+
+// see lines
+// * 99 Read the jobs from a file, or generated a sweep
+// * 142 Created an offscreen image and framebuffer for every frame in flight
+// * 192 Waited for the job's frame in flight and for a readback slot, timing both
+// * 219 Rendered the job and recorded the copy into the readback slot
+// * 262 Reported jobs per second, and where the render loop waited
+// * readback.hpp: acquire() can wait for a slot, and times whether it waits on the GPU or the encoders
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <chrono>
+#include <thread>
+
+#include "utils/preprocessor.hpp"
+#include "utils/extensions.hpp"
+#include "utils/layers.hpp"
+#include "utils/queue_families.hpp"
+#include "utils/shader.hpp"
+#include "utils/memory.hpp"
+#include "utils/buffer.hpp"
+#include "utils/image.hpp"
+#include "utils/readback.hpp"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+// the parameters of one rendered frame
+struct Job
+{
+    float fade = 1;
+    float clearColor[4] = { 0, 0, 0, 1 };
+};
+
+std::vector<Job> readJobs(const char* path);
+VkInstance createInstance();
+VkPhysicalDevice selectPhysicalDevice(VkInstance instance, QueueFamilies* outFamilies);
+VkDevice createDevice(VkPhysicalDevice physicalDevice, int32_t graphicsFamily);
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool cmdPool);
+VkRenderPass createRenderpass(VkDevice device, VkFormat format);
+VkPipelineLayout createPipelineLayout(VkDevice device);
+VkPipeline createPipeline(VkDevice device, VkExtent2D extent, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+
+int main(int argc, char** argv) {
+    const char* jobPath = nullptr;
+    uint32_t sweep = 0;
+    uint32_t framesInFlight = 3;
+    uint32_t ringSize = 0;
+    uint32_t encoderCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    const char* outputPrefix = "job_";
+    VkExtent2D extent { 800, 800 };
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            jobPath = argv[++i];
+        if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc)
+            sweep = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+            framesInFlight = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--ring") == 0 && i + 1 < argc)
+            ringSize = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--encoders") == 0 && i + 1 < argc)
+            encoderCount = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPrefix = argv[++i];
+        if (strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+            extent.width = std::max(1, atoi(argv[++i]));
+        if (strcmp(argv[i], "--height") == 0 && i + 1 < argc)
+            extent.height = std::max(1, atoi(argv[++i]));
+    }
+    
+    // every frame in flight holds a slot while it's copying, and every encoder holds one while it's compressing
+    // with fewer slots than that, the frames in flight and encoders can never all be busy at once
+    if (ringSize == 0)
+        ringSize = framesInFlight + encoderCount;
+    
+    std::vector<Job> jobs;
+    if (jobPath != nullptr)
+        jobs = readJobs(jobPath);
+    for (uint32_t i = 0; i < sweep; i++)
+    {
+        Job job;
+        job.fade = sweep == 1 ? 1.0f : static_cast<float>(i) / (sweep - 1);
+        jobs.push_back(job);
+    }
+    
+    if (jobs.empty())
+    {
+        printf("Nothing to render, pass a job file with --jobs or a job count with --sweep\n");
+        return 1;
+    }
+    
+    VkInstance instance = createInstance();
+    
+    QueueFamilies families;
+    VkPhysicalDevice physicalDevice = selectPhysicalDevice(instance, &families);
+    
+    VkDevice device = createDevice(physicalDevice, families.graphics);
+    VkQueue graphicsQueue; vkGetDeviceQueue(device, families.graphics, 0, &graphicsQueue);
+    
+    // a command buffer per frame in flight, a frame's command buffer can only be recorded again once the GPU is done with it
+    VkCommandPool commandPool = createCommandPool(device, families.graphics);
+    std::vector<VkCommandBuffer> commandBuffers(framesInFlight);
+    for (VkCommandBuffer& commandBuffer : commandBuffers)
+        commandBuffer = allocateCommandBuffer(device, commandPool);
+    
+    // the fences start signaled, so the first jobs don't wait on frames that were never submitted
+    VkFenceCreateInfo fenceInfo { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, VK_FENCE_CREATE_SIGNALED_BIT };
+    std::vector<VkFence> frameFences(framesInFlight);
+    for (VkFence& fence : frameFences)
+        THROW_IF_FAILED(vkCreateFence(device, &fenceInfo, nullptr, &fence));
+    
+    // RGBA is what PNG stores, so the encoders write the ring's buffers as they are, without swizzling
+    const VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    VkRenderPass renderpass = createRenderpass(device, format);
+    
+    // an image per frame in flight, the next job renders into another image while the previous one is still being copied
+    std::vector<std::unique_ptr<Image>> targets(framesInFlight);
+    std::vector<VkFramebuffer> framebuffers(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; i++)
+    {
+        targets[i] = Image::create(device, physicalDevice, format, extent, 1, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+        
+        VkFramebufferCreateInfo framebufferInfo {};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.pNext = nullptr;
+        framebufferInfo.flags = 0;
+        framebufferInfo.renderPass = renderpass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = &targets[i]->view;
+        framebufferInfo.width = extent.width;
+        framebufferInfo.height = extent.height;
+        framebufferInfo.layers = 1;
+        THROW_IF_FAILED(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]));
+    }
+    
+    VkShaderModule vertexShader = Shader::load(device, "../029_batch_render/vertex.spv");
+    VkShaderModule fragmentShader = Shader::load(device, "../029_batch_render/fragment.spv");
+    
+    VkPipelineLayout pipelineLayout = createPipelineLayout(device);
+    VkPipeline pipeline = createPipeline(device, extent, renderpass, pipelineLayout, vertexShader, fragmentShader);
+    
+    // 005's quad, 0.0 is the center of the screen, -1,-1 is top left and 1,1 is bottom right
+    std::vector<float> vertices {
+        -0.5, -0.5, 0.0,     1.0, 0.0, 0.0,
+        0.5, 0.5, 0.0,       0.0, 1.0, 0.0,
+        -0.5, 0.5, 0.0,      0.0, 0.0, 1.0,
+        0.5, -0.5, 0.0,      0.0, 0.0, 1.0
+    };
+    std::vector<uint32_t> indices { 0, 1, 2, 0, 3, 1 };
+    
+    std::unique_ptr<Buffer> vertexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(float) * vertices.size(), vertices.data(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    std::unique_ptr<Buffer> indexBuffer = Buffer::createUploadBuffer(device, physicalDevice, families, sizeof(uint32_t) * indices.size(), indices.data(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    
+    std::unique_ptr<ReadbackRing> readbackRing = std::make_unique<ReadbackRing>(device, physicalDevice, families, extent, format, ringSize, encoderCount, outputPrefix);
+    
+    printf("Rendering %zu jobs at %ux%u, %u frames in flight, %u readback buffers, %u encoders\n", jobs.size(), extent.width, extent.height, framesInFlight, ringSize, encoderCount);
+    
+    auto start = std::chrono::steady_clock::now();
+    double frameWait = 0;
+    const uint32_t reportJobs = 1024;
+    
+    for (uint32_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+    {
+        const Job& job = jobs[jobIndex];
+        
+        // the job reuses the resources of the job that was framesInFlight jobs ago
+        uint32_t slot = jobIndex % framesInFlight;
+        VkCommandBuffer cmd = commandBuffers[slot];
+        auto waitStart = std::chrono::steady_clock::now();
+        THROW_IF_FAILED(vkWaitForFences(device, 1, &frameFences[slot], VK_TRUE, UINT64_MAX));
+        THROW_IF_FAILED(vkResetFences(device, 1, &frameFences[slot]));
+        frameWait += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+        
+        // the result can't be dropped, so this waits until the GPU or an encoder frees a readback buffer
+        int32_t readbackSlot = readbackRing->acquire(jobIndex, true);
+        
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+        vkBeginCommandBuffer(cmd, &beginInfo);
+        
+        VkClearValue clearValue {};
+        memcpy(clearValue.color.float32, job.clearColor, sizeof(job.clearColor));
+        
+        VkRenderPassBeginInfo renderpassBegin {};
+        renderpassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderpassBegin.pNext = nullptr;
+        renderpassBegin.renderPass = renderpass;
+        renderpassBegin.framebuffer = framebuffers[slot];
+        renderpassBegin.renderArea = VkRect2D { VkOffset2D { 0, 0 }, extent };
+        renderpassBegin.clearValueCount = 1;
+        renderpassBegin.pClearValues = &clearValue;
+        
+        vkCmdBeginRenderPass(cmd, &renderpassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &job.fade);
+        
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer->buffer, &offset);
+        vkCmdBindIndexBuffer(cmd, indexBuffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdDrawIndexed(cmd, indices.size(), 1, 0, 0, 0);
+        
+        vkCmdEndRenderPass(cmd);
+        
+        readbackRing->record(cmd, readbackSlot, targets[slot]->image);
+        
+        vkEndCommandBuffer(cmd);
+        
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = nullptr;
+        submit.waitSemaphoreCount = 0;
+        submit.pWaitSemaphores = nullptr;
+        submit.pWaitDstStageMask = nullptr;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cmd;
+        submit.signalSemaphoreCount = 0;
+        submit.pSignalSemaphores = nullptr;
+        THROW_IF_FAILED(vkQueueSubmit(graphicsQueue, 1, &submit, frameFences[slot]));
+        
+        // a submit signals a single fence, and the frame's fence is already taken
+        // a submit without any work still signals its fence once everything submitted before it is done, which includes the copy
+        THROW_IF_FAILED(vkQueueSubmit(graphicsQueue, 0, nullptr, readbackRing->fence(readbackSlot)));
+        
+        // hand the copies that finished to the encoders, this only checks the fences and never blocks
+        readbackRing->poll();
+        
+        if ((jobIndex + 1) % reportJobs == 0)
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%u jobs submitted, %u written, %.1f jobs/s\n", jobIndex + 1, readbackRing->encoded(), readbackRing->encoded() / seconds);
+        }
+    }
+    
+    // the last jobs are still being copied and encoded, the batch is done once they're written
+    double submitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double gpuWait = readbackRing->gpuWait();
+    double encoderWait = readbackRing->encoderWait();
+    readbackRing->finish();
+    uint32_t failed = readbackRing->failed();
+    readbackRing.reset();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    printf("%zu jobs in %.2f s, %.1f jobs/s (all submitted after %.2f s)\n", jobs.size(), seconds, jobs.size() / seconds, submitSeconds);
+    printf("Waited %.0f ms on frames in flight, %.0f ms on readback copies and %.0f ms on the encoders\n", frameWait, gpuWait, encoderWait);
+    if (encoderWait > frameWait + gpuWait)
+        printf("The encoders are the bottleneck, try more --encoders\n");
+    else
+        printf("The GPU is the bottleneck, more encoders won't help\n");
+    printf("Wrote the results to %s*.png\n", outputPrefix);
+    if (failed > 0)
+        printf("%u of %zu jobs failed to be written\n", failed, jobs.size());
+    
+    // all resources created with vkCreate... have to be vkDestroy...ed
+    vkDeviceWaitIdle(device);
+    
+    vertexBuffer.reset();
+    indexBuffer.reset();
+    
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    
+    vkDestroyShaderModule(device, vertexShader, nullptr);
+    vkDestroyShaderModule(device, fragmentShader, nullptr);
+    
+    for (uint32_t i = 0; i < framesInFlight; i++)
+    {
+        vkDestroyFramebuffer(device, framebuffers[i], nullptr);
+        vkDestroyFence(device, frameFences[i], nullptr);
+    }
+    targets.clear();
+    
+    vkDestroyRenderPass(device, renderpass, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    
+    // a batch with missing results failed, even though every job was rendered
+    return failed > 0 ? 1 : 0;
+}
+
+std::vector<Job> readJobs(const char* path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error(std::string("Failed to open job file ") + path);
+    
+    std::vector<Job> jobs;
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::istringstream words(line);
+        std::string word;
+        if (!(words >> word) || word[0] == '#')
+            continue;
+        
+        Job job;
+        do
+        {
+            size_t split = word.find('=');
+            std::string key = word.substr(0, split);
+            const char* value = split == std::string::npos ? "" : word.c_str() + split + 1;
+            
+            if (key == "fade" && sscanf(value, "%f", &job.fade) == 1)
+                continue;
+            if (key == "clear" && sscanf(value, "%f,%f,%f", &job.clearColor[0], &job.clearColor[1], &job.clearColor[2]) == 3)
+                continue;
+            
+            throw std::runtime_error(std::string(path) + ":" + std::to_string(lineNumber) + ": can't read '" + word + "'");
+        }
+        while (words >> word);
+        
+        jobs.push_back(job);
+    }
+    
+    return jobs;
+}
+
+VkInstance createInstance()
+{
+    // there's no window, so none of the surface extensions GLFW asks for are needed
+    Extensions extensionHelper{};
+    extensionHelper.add("VK_KHR_get_physical_device_properties2"); // always add if available -> required on MoltenVK
+    auto extensions = extensionHelper.get();
+    auto layers = Layers::get();
+    
+    // VkApplicationInfo is largely informative and usually just gives drivers additional information
+    // for debugging purposes.
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pNext = nullptr;
+    appInfo.pApplicationName = "029_batch_render";
+    appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+    appInfo.pEngineName = "None";
+    appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+    // api version is the exception to this; changing the apiVersion changes which Vulkan API version is used.
+    // newer API versions usually integrate popular extensions into the core.
+    appInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    
+    VkInstanceCreateInfo instanceInfo {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext = nullptr;
+    instanceInfo.flags = 0;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = layers.size();
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    instanceInfo.enabledExtensionCount = extensions.size();
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    // create a vulkan instance using the instance create info
+    VkInstance instance;
+    THROW_IF_FAILED(vkCreateInstance(&instanceInfo, nullptr, &instance));
+    return instance;
+}
+
+VkPhysicalDevice selectPhysicalDevice(VkInstance instance, QueueFamilies* outFamilies)
+{
+    uint32_t count;
+    THROW_IF_FAILED(vkEnumeratePhysicalDevices(instance, &count, nullptr));
+    std::vector<VkPhysicalDevice> physicalDevices(count);
+    THROW_IF_FAILED(vkEnumeratePhysicalDevices(instance, &count, physicalDevices.data()));
+    
+    // a batch renders fastest on a discrete GPU, which is picked over any other device that can render
+    VkPhysicalDevice selected = VK_NULL_HANDLE;
+    int32_t selectedFamily = -1;
+    for (VkPhysicalDevice physicalDevice : physicalDevices)
+    {
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueFamilyProperties.data());
+        
+        int32_t graphicsFamily = -1;
+        for (uint32_t i = 0; i < count && graphicsFamily == -1; i++)
+        {
+            if ((queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == VK_QUEUE_GRAPHICS_BIT)
+                graphicsFamily = i;
+        }
+        
+        if (graphicsFamily == -1)
+            continue;
+        
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (selected == VK_NULL_HANDLE || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+        {
+            selected = physicalDevice;
+            selectedFamily = graphicsFamily;
+            if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+                break;
+        }
+    }
+    
+    if (selected == VK_NULL_HANDLE)
+        throw std::runtime_error("No device that can render");
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(selected, &properties);
+    printf("Rendering on %s\n", properties.deviceName);
+    
+    // nothing is presented, the buffers are only used by the graphics family
+    outFamilies->graphics = selectedFamily;
+    outFamilies->present = selectedFamily;
+    return selected;
+}
+
+VkDevice createDevice(VkPhysicalDevice physicalDevice, int32_t graphicsFamily)
+{
+    std::vector<VkDeviceQueueCreateInfo> deviceQueues;
+    
+    // queues can have different priorities which may change the GPU resources they get,
+    // in our case we'll just stick to a default 1.0
+    std::array<float, 1> priorities = { 1 };
+    
+    deviceQueues.push_back(VkDeviceQueueCreateInfo {
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        nullptr,        // pNext
+        0,              // flags (none)
+        static_cast<uint32_t>(graphicsFamily), // the only queue, there's nothing to present
+        1,              // create one queue
+        priorities.data()       // pass on priority (this must be an array if num queues is more than 1)
+    });
+    
+    Extensions ext { physicalDevice };
+    ext.add("VK_KHR_portability_subset");
+    auto extensions = ext.get();
+    
+    // Device creation takes our array of queues, and array of extensions
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = nullptr;
+    deviceInfo.flags = 0;
+    deviceInfo.queueCreateInfoCount = deviceQueues.size();
+    deviceInfo.pQueueCreateInfos = deviceQueues.data();
+    deviceInfo.enabledLayerCount = 0; // device layers are deprecated, always pass 0 and nullptr
+    deviceInfo.ppEnabledLayerNames = nullptr;
+    deviceInfo.enabledExtensionCount = extensions.size();
+    deviceInfo.ppEnabledExtensionNames = extensions.data();
+    
+    VkDevice device;
+    THROW_IF_FAILED(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    
+    return device;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t graphicsFamily)
+{
+    // create a command pool
+    // command pools are structures that allocate the memory necessary
+    // to be able to record command buffers.
+    VkCommandPoolCreateInfo commandPoolInfo {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // command pools contain commands for a specific queue family
+    // in our case we're using this commandbuffer to render graphics so we'll pass the graphics family
+    commandPoolInfo.queueFamilyIndex = graphicsFamily;
+    
+    VkCommandPool commandPool;
+    THROW_IF_FAILED(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool));
+    
+    return commandPool;
+}
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool)
+{
+    // allocate a command buffer from our command pool
+    VkCommandBufferAllocateInfo cmdAllocInfo {};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext = nullptr;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // primary cmd buffers can be submitted to a queue directly
+    cmdAllocInfo.commandBufferCount = 1; // we only need one command buffer in this sample
+    cmdAllocInfo.commandPool = commandPool; // allocate from the command pool we just created
+    
+    // note that VkCommandPool is a pool! This means that when we destroy our VkCommandPool, our
+    // allocated command buffers will automatically be destroyed as well.
+    // we do have the option to destroy them manually if we wish through vkFreeCommandBuffers()
+    VkCommandBuffer cmd;
+    THROW_IF_FAILED(vkAllocateCommandBuffers(device, &cmdAllocInfo, &cmd));
+    
+    return cmd;
+}
+
+VkRenderPass createRenderpass(VkDevice device, VkFormat format)
+{
+    // next we'll describe a render pass
+    // renderpasses are like a pre-defined render graph
+    // they define sub passes and how they interact with their (and each other's) attachments
+    // this can help greatly improve performance on mobile devices
+    // our renderpass will be fairly simple: 1 subpass with 1 color attachment
+    
+    // describe our color attachment:
+    // - how its used
+    // - how its loaded/stored
+    // - what its layout will be before/after the pass
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = format;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT; // msaa
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // the image is copied to a buffer right after
+    
+    // subpasses must describe their attachments and in what layout they wish to use them
+    // during a renderpass, attachments are transitioned to a subpass's desired layout
+    // thus our attachment starts as UNDEFINED, transitions to COLOR_ATTACHMENT during our subpass, and at the end of the renderpass it transitions to TRANSFER_SRC
+    VkAttachmentReference colorRef {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    // describe a simple graphics (not compute) subpass with a single color attachment
+    VkSubpassDescription subpass {};
+    subpass.flags = 0;
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.inputAttachmentCount = 0;
+    subpass.pInputAttachments = nullptr;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    subpass.preserveAttachmentCount = 0;
+    subpass.pPreserveAttachments = nullptr;
+    
+    // the copy after the renderpass reads what the subpass wrote, and waits for it through this dependency
+    VkSubpassDependency copyDependency {};
+    copyDependency.srcSubpass = 0;
+    copyDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    copyDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    copyDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    copyDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    copyDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    copyDependency.dependencyFlags = 0;
+    
+    // create a renderpass with the described color attachment and subpass
+    VkRenderPassCreateInfo renderpassInfo {};
+    renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderpassInfo.pNext = nullptr;
+    renderpassInfo.flags = 0;
+    renderpassInfo.attachmentCount = 1;
+    renderpassInfo.pAttachments = &colorAttachment;
+    renderpassInfo.subpassCount = 1;
+    renderpassInfo.pSubpasses = &subpass;
+    renderpassInfo.dependencyCount = 1;
+    renderpassInfo.pDependencies = &copyDependency;
+    
+    VkRenderPass renderpass;
+    THROW_IF_FAILED(vkCreateRenderPass(device, &renderpassInfo, nullptr, &renderpass));
+    
+    return renderpass;
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device)
+{
+    VkPushConstantRange pushConstants {};
+    pushConstants.size = sizeof(float);
+    pushConstants.offset = 0;
+    pushConstants.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    // the pipeline layout describes how GPU resources (textures, buffers, etc) are bound to the shader
+    // so that the shader can access it
+    // our sample shaders have no bindings so this structure receives default values:
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext = nullptr;
+    pipelineLayoutInfo.flags = 0;
+    pipelineLayoutInfo.setLayoutCount = 0;
+    pipelineLayoutInfo.pSetLayouts = nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    
+    VkPipelineLayout pipelineLayout;
+    THROW_IF_FAILED(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    
+    return pipelineLayout;
+}
+
+VkPipeline createPipeline(VkDevice device, VkExtent2D extent, VkRenderPass renderpass, VkPipelineLayout pipelineLayout, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
+    // Pipeline could certainly use a more intricate abstraction that allows deeper configuration of its parameters
+    // this sample just stuffs everything away in a function however
+    
+    // rendering your first triangle is a fair bit of work
+    // the next bit of creation code will work towards the creation of a "VkPipeline"
+    // VkPipeline represents (in this case) the graphics pipeline
+    // to minimize runtime cost, the majority of information has to be provided up front
+    // this is different from OpenGL, where states are set to a default and you change them at will with gl...()
+    
+    // describe our vertex and fragment shader (shader stage, entry point) for the pipeline
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            vertexShader,
+            "main",
+            nullptr
+        },
+        VkPipelineShaderStageCreateInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            fragmentShader,
+            "main",
+            nullptr
+        }
+    };
+    
+    // describe in what kind of chunks the vertex buffer is split up
+    VkVertexInputBindingDescription vertexBinding {};
+    vertexBinding.stride = sizeof(float) * (3 + 3); // 6 floats (float3 pos, float3 color)
+    vertexBinding.binding = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // used on a per vertex basis
+    
+    // describe how the vertex binding above maps to vertex input in the shader
+    std::array<VkVertexInputAttributeDescription, 2> vertexAttributes {
+        VkVertexInputAttributeDescription { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        VkVertexInputAttributeDescription { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 } // offset by 3 floats because of pos
+    };
+    
+    // the vertex input state is used to describe how the driver should interpret our vertex buffer
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInput {};
+    pipelineVertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInput.pNext = nullptr;
+    pipelineVertexInput.flags = 0;
+    pipelineVertexInput.vertexBindingDescriptionCount = 1;
+    pipelineVertexInput.pVertexBindingDescriptions = &vertexBinding;
+    pipelineVertexInput.vertexAttributeDescriptionCount = vertexAttributes.size();
+    pipelineVertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    
+    // the input assembly state describes what kind of topology is created in the draw call
+    VkPipelineInputAssemblyStateCreateInfo pipelineAssemblyState {};
+    pipelineAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineAssemblyState.pNext = nullptr;
+    pipelineAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // we're drawing triangles
+    pipelineAssemblyState.primitiveRestartEnable = false;
+    
+    // the tesselation state describes what happens during the optional tesselation stage of the pipeline
+    // we have no special behaviour during this state so default values are passed:
+    VkPipelineTessellationStateCreateInfo pipelineTesselationState {};
+    pipelineTesselationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    pipelineTesselationState.pNext = nullptr;
+    pipelineTesselationState.flags = 0;
+    pipelineTesselationState.patchControlPoints = 0;
+    
+    // describe the viewport and scissor
+    VkViewport viewport;
+    viewport.width = extent.width;
+    viewport.height = extent.height;
+    viewport.minDepth = 0;
+    viewport.maxDepth = 1;
+    viewport.x = 0;
+    viewport.y = 0;
+    
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = extent;
+    
+    VkPipelineViewportStateCreateInfo pipelineViewportState {};
+    pipelineViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportState.pNext = nullptr;
+    pipelineViewportState.flags = 0;
+    pipelineViewportState.viewportCount = 1;
+    pipelineViewportState.pViewports = &viewport;
+    pipelineViewportState.scissorCount = 1;
+    pipelineViewportState.pScissors = &scissor;
+    
+    // the rasterization state contains various properties that you may be used to setting dynamically in opengl
+    // but these are instead described up-front, such as polygon culling, line widths and depth clamping
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationState {};
+    pipelineRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationState.pNext = nullptr;
+    pipelineRasterizationState.flags = 0;
+    pipelineRasterizationState.depthClampEnable = false;
+    pipelineRasterizationState.rasterizerDiscardEnable = false;
+    pipelineRasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    pipelineRasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    pipelineRasterizationState.depthBiasEnable = false;
+    pipelineRasterizationState.depthBiasConstantFactor = 0;
+    pipelineRasterizationState.depthBiasClamp = 0;
+    pipelineRasterizationState.depthBiasSlopeFactor = 0;
+    pipelineRasterizationState.lineWidth = 1;
+    
+    // describe how/if the pipeline should apply MSAA
+    // these default values simply disable it:
+    VkPipelineMultisampleStateCreateInfo pipelineMultiSampleState {};
+    pipelineMultiSampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultiSampleState.pNext = nullptr;
+    pipelineMultiSampleState.flags = 0;
+    pipelineMultiSampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    pipelineMultiSampleState.sampleShadingEnable = false;
+    pipelineMultiSampleState.minSampleShading = 1;
+    pipelineMultiSampleState.pSampleMask = nullptr;
+    pipelineMultiSampleState.alphaToOneEnable = false;
+    pipelineMultiSampleState.alphaToCoverageEnable = false;
+    
+    // describe how fragments calculated by the rasterizer interact with an optional depth and stencil buffer
+    // these default values disable depth and stencil testing:
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilState {};
+    pipelineDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilState.pNext = nullptr;
+    pipelineDepthStencilState.flags = 0;
+    pipelineDepthStencilState.depthTestEnable = false;
+    pipelineDepthStencilState.depthWriteEnable = false;
+    pipelineDepthStencilState.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    pipelineDepthStencilState.depthBoundsTestEnable = false;
+    pipelineDepthStencilState.stencilTestEnable = false;
+    pipelineDepthStencilState.front = {};
+    pipelineDepthStencilState.back = {};
+    pipelineDepthStencilState.minDepthBounds = 0;
+    pipelineDepthStencilState.maxDepthBounds = 1;
+    
+    // describe if and how fragments are blended at the end of the pipeline
+    // these default values disable blending:
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.blendEnable = false;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendState {};
+    pipelineColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendState.pNext = nullptr;
+    pipelineColorBlendState.flags = 0;
+    pipelineColorBlendState.logicOpEnable = false;
+    pipelineColorBlendState.logicOp = VK_LOGIC_OP_NO_OP;
+    pipelineColorBlendState.attachmentCount = 1;
+    pipelineColorBlendState.pAttachments = &colorBlendAttachment;
+    pipelineColorBlendState.blendConstants[0] = 0;
+    pipelineColorBlendState.blendConstants[1] = 0;
+    pipelineColorBlendState.blendConstants[2] = 0;
+    pipelineColorBlendState.blendConstants[3] = 0;
+
+    // dynamic states can help prevent having to recreate pipelines for
+    // values that could change a lot (e.g. a viewport size or scissor)
+    // if a dynamic state is enabled, it must also be set during render time (e.g. vkCmdSetViewport() for VK_DYNAMIC_STATE_VIEWPORT)
+    VkPipelineDynamicStateCreateInfo pipelineDynamicState {};
+    pipelineDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicState.pNext = nullptr;
+    pipelineDynamicState.flags = 0;
+    pipelineDynamicState.dynamicStateCount = 0;
+    pipelineDynamicState.pDynamicStates = nullptr;
+    
+    // gather all the information we've previously described to make up the final pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderpass;
+    pipelineInfo.subpass = 0; // subpass index 0
+    pipelineInfo.basePipelineHandle = nullptr;
+    pipelineInfo.basePipelineIndex = 0;
+    
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    
+    pipelineInfo.pVertexInputState = &pipelineVertexInput;
+    pipelineInfo.pInputAssemblyState = &pipelineAssemblyState;
+    pipelineInfo.pTessellationState = &pipelineTesselationState;
+    
+    pipelineInfo.pViewportState = &pipelineViewportState;
+    pipelineInfo.pRasterizationState = &pipelineRasterizationState;
+    pipelineInfo.pMultisampleState = &pipelineMultiSampleState;
+    pipelineInfo.pDepthStencilState = &pipelineDepthStencilState;
+    pipelineInfo.pColorBlendState = &pipelineColorBlendState;
+    pipelineInfo.pDynamicState = &pipelineDynamicState;
+    
+    VkPipeline pipeline;
+    THROW_IF_FAILED(vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline));
+    
+    return pipeline;
+}
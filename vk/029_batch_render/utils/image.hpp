@@ -0,0 +1,140 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cassert>
+#include "preprocessor.hpp"
+#include "memory.hpp"
+
+// wrapper around a 2D image with a full mip chain, its memory and a view of all of its levels
+// the image remembers the layout every mip level is in, so barriers can be built from it without the caller keeping track.
+// barriers are returned rather than recorded, so they can be batched into a single vkCmdPipelineBarrier like the tracker does.
+// layouts are only updated by the functions below: a transition recorded by someone else (e.g. the acquire half of an
+// ownership transfer) has to be reported through setLayout()
+class Image
+{
+public:
+    Image() = default;
+    ~Image() {
+        vkDestroyImageView(m_device, view, nullptr);
+        vkDestroyImage(m_device, image, nullptr);
+        vkFreeMemory(m_device, memory, nullptr);
+    }
+
+    // create a device local image, its contents and the layouts of all of its levels start out undefined
+    static std::unique_ptr<Image> create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkExtent2D extent, uint32_t mipLevels, VkImageUsageFlags usage)
+    {
+        std::unique_ptr<Image> result = std::make_unique<Image>();
+        result->m_device = device;
+        result->format = format;
+        result->extent = extent;
+        result->mipLevels = mipLevels;
+        result->m_layouts.assign(mipLevels, VK_IMAGE_LAYOUT_UNDEFINED);
+
+        // images that are only used by one queue family at a time are exclusive, other families get them through ownership transfers
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.pNext = nullptr;
+        imageInfo.flags = 0;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = VkExtent3D { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.queueFamilyIndexCount = 0;
+        imageInfo.pQueueFamilyIndices = nullptr;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        THROW_IF_FAILED(vkCreateImage(device, &imageInfo, nullptr, &result->image));
+
+        // optimal tiling images have their own size and alignment requirements, which are usually larger than width * height * texel size
+        VkMemoryRequirements memoryReqs;
+        vkGetImageMemoryRequirements(device, result->image, &memoryReqs);
+        result->size = memoryReqs.size;
+
+        VkMemoryAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.pNext = nullptr;
+        allocInfo.allocationSize = memoryReqs.size;
+        allocInfo.memoryTypeIndex = Memory::select(physicalDevice, memoryReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        THROW_IF_FAILED(vkAllocateMemory(device, &allocInfo, nullptr, &result->memory));
+        THROW_IF_FAILED(vkBindImageMemory(device, result->image, result->memory, 0));
+
+        VkImageViewCreateInfo viewInfo {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.pNext = nullptr;
+        viewInfo.flags = 0;
+        viewInfo.image = result->image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.components = VkComponentMapping { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+        viewInfo.subresourceRange = VkImageSubresourceRange { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+
+        THROW_IF_FAILED(vkCreateImageView(device, &viewInfo, nullptr, &result->view));
+
+        return std::move(result);
+    }
+
+    // the number of levels of a full mip chain, down to 1x1
+    static uint32_t mipCount(VkExtent2D extent)
+    {
+        uint32_t count = 1;
+        for (uint32_t size = std::max(extent.width, extent.height); size > 1; size /= 2)
+            count++;
+
+        return count;
+    }
+
+    VkExtent2D mipExtent(uint32_t mip) const { return VkExtent2D { std::max(extent.width >> mip, 1u), std::max(extent.height >> mip, 1u) }; }
+
+    VkImageLayout layout(uint32_t mip) const { return m_layouts[mip]; }
+
+    // report a transition that was recorded without transition()
+    void setLayout(uint32_t baseMip, uint32_t mipCount, VkImageLayout layout)
+    {
+        for (uint32_t i = baseMip; i < baseMip + mipCount; i++)
+            m_layouts[i] = layout;
+    }
+
+    // a barrier that moves the given levels from their current layout to a new one, all of them have to be in the same layout
+    // transitioning from UNDEFINED discards the contents, which is what we want for levels that are about to be overwritten
+    VkImageMemoryBarrier transition(uint32_t baseMip, uint32_t mipCount, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+    {
+        VkImageMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.pNext = nullptr;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.oldLayout = m_layouts[baseMip];
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = VkImageSubresourceRange { VK_IMAGE_ASPECT_COLOR_BIT, baseMip, mipCount, 0, 1 };
+
+        for (uint32_t i = baseMip; i < baseMip + mipCount; i++)
+        {
+            assert(m_layouts[i] == barrier.oldLayout);
+            m_layouts[i] = newLayout;
+        }
+
+        return barrier;
+    }
+
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;
+    VkFormat format;
+    VkExtent2D extent;
+    uint32_t mipLevels = 0;
+    VkDeviceSize size = 0; // bytes of memory the image occupies
+
+private:
+    std::vector<VkImageLayout> m_layouts;
+
+    VkDevice m_device;
+};
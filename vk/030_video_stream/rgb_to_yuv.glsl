@@ -0,0 +1,68 @@
+#version 450
+
+// converts the rendered image to planar 4:2:0 YUV (BT.601, limited range), straight into the stream's mapped buffer
+// the buffer holds the full resolution Y plane, followed by the U and V planes at half the resolution in both directions
+// a shader can't write single bytes to a buffer without 8 bit storage, so one invocation converts a block of 8x2 pixels:
+// two words of Y on each of the two rows, and one word each of U and V for the four 2x2 blocks it covers
+// that's why the width has to be a multiple of 8
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D image;
+
+layout(set = 0, binding = 1) writeonly buffer Planes {
+    uint words[];
+} planes;
+
+layout(push_constant) uniform Constants {
+    uint width;
+    uint height;
+} constants;
+
+// the image is sRGB, so sampling it returns linear colors. video stores the gamma encoded values, like the swapchain would
+vec3 encodeSrgb(vec3 linear) {
+    return mix(linear * 12.92, 1.055 * pow(linear, vec3(1.0 / 2.4)) - 0.055, greaterThan(linear, vec3(0.0031308)));
+}
+
+float luma(vec3 rgb) {
+    return 16.0 + dot(rgb, vec3(65.481, 128.553, 24.966));
+}
+
+vec2 chroma(vec3 rgb) {
+    return vec2(128.0 + dot(rgb, vec3(-37.797, -74.203, 112.0)), 128.0 + dot(rgb, vec3(112.0, -93.786, -18.214)));
+}
+
+uint pack(vec4 bytes) {
+    uvec4 b = uvec4(clamp(round(bytes), 0.0, 255.0));
+    return b.x | (b.y << 8) | (b.z << 16) | (b.w << 24);
+}
+
+void main() {
+    uvec2 block = gl_GlobalInvocationID.xy;
+    if (block.x >= constants.width / 8 || block.y >= constants.height / 2)
+        return;
+
+    uvec2 origin = block * uvec2(8, 2);
+    uint planeSize = constants.width * constants.height;
+
+    vec3 rgb[2][8];
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 8; x++)
+            rgb[y][x] = encodeSrgb(clamp(texelFetch(image, ivec2(origin) + ivec2(x, y), 0).rgb, 0.0, 1.0));
+    }
+
+    // the words of the Y plane, 4 pixels each
+    for (int y = 0; y < 2; y++) {
+        uint word = ((origin.y + uint(y)) * constants.width + origin.x) / 4;
+        planes.words[word] = pack(vec4(luma(rgb[y][0]), luma(rgb[y][1]), luma(rgb[y][2]), luma(rgb[y][3])));
+        planes.words[word + 1] = pack(vec4(luma(rgb[y][4]), luma(rgb[y][5]), luma(rgb[y][6]), luma(rgb[y][7])));
+    }
+
+    // every chroma sample is the average of a 2x2 block, which puts it in the block's center
+    vec2 uv[4];
+    for (int i = 0; i < 4; i++)
+        uv[i] = chroma((rgb[0][i * 2] + rgb[0][i * 2 + 1] + rgb[1][i * 2] + rgb[1][i * 2 + 1]) * 0.25);
+
+    uint chromaOffset = block.y * (constants.width / 2) + block.x * 4;
+    planes.words[(planeSize + chromaOffset) / 4] = pack(vec4(uv[0].x, uv[1].x, uv[2].x, uv[3].x));
+    planes.words[(planeSize + planeSize / 4 + chromaOffset) / 4] = pack(vec4(uv[0].y, uv[1].y, uv[2].y, uv[3].y));
+}
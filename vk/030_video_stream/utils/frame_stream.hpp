@@ -0,0 +1,402 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "buffer.hpp"
+#include "memory.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// streams rendered frames to stdout or a named pipe, as raw RGBA or as a YUV4MPEG2 (Y4M) video
+// frames are read straight from a ring of persistently mapped buffers: the GPU writes a frame into a slot's buffer, and
+// a writer thread hands that memory to the operating system without copying it anywhere first. frames that finished
+// together are passed to writev() as one list, which takes as few calls as the pipe allows, and a Y4M frame's header is
+// just one more entry in that list
+// the buffers hold exactly what goes out: 4 bytes per pixel for RGBA, or the Y, U and V planes one after the other for Y4M,
+// so converting to YUV happens on the GPU before the frame reaches the buffer
+// the writer keeps the frames in order, and the render loop waits for a slot when the reader can't keep up: a video
+// can't skip frames, so a slow reader slows down rendering
+// on Windows, where there's no writev(), the frames are written with one fwrite() per buffer instead
+// errors on the writer thread don't leave it as exceptions, they fail the stream and are kept for error()
+class FrameStream
+{
+public:
+    enum class Format
+    {
+        Rgba,
+        Y4m
+    };
+
+    // "-" streams to stdout, any other path is opened as a file
+    // opening a named pipe blocks until a reader opens the other end, e.g. after mkfifo frames.y4m; ffmpeg -i frames.y4m ...
+    FrameStream(VkDevice device, VkPhysicalDevice physicalDevice, const QueueFamilies& families, VkExtent2D extent, Format format, uint32_t framesPerSecond, uint32_t slotCount, const std::string& path)
+        : m_device(device), m_format(format)
+    {
+        if (format == Format::Y4m && (extent.width % 8 != 0 || extent.height % 2 != 0))
+            throw std::runtime_error("Y4M streams need a width that's a multiple of 8 and an even height");
+
+        // a constructor that throws doesn't run the destructor, so whatever was created so far is released here
+        try
+        {
+            // RGBA frames are copied from the image into the buffer, Y4M frames are written by the conversion shader
+            VkBufferUsageFlags usage = format == Format::Rgba ? VK_BUFFER_USAGE_TRANSFER_DST_BIT : VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            m_frameSize = frameSize(extent, format);
+
+            // the CPU doesn't read these buffers, the operating system does when it copies them into the pipe
+            // that's still a read of every byte, which is many times faster from cached memory
+            VkPhysicalDeviceMemoryProperties memoryProperties;
+            vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+            VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+            {
+                VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+                if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT))
+                {
+                    memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                    break;
+                }
+            }
+
+            VkFenceCreateInfo fenceInfo { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0 };
+
+            m_slots.resize(slotCount);
+            for (Slot& slot : m_slots)
+            {
+                slot.buffer = Buffer::create(device, physicalDevice, families, m_frameSize, usage, memoryFlags);
+                slot.buffer->map();
+                THROW_IF_FAILED(vkCreateFence(device, &fenceInfo, nullptr, &slot.fence));
+            }
+
+            // the buffers are allocated from the first type their requirements allow, which doesn't have to be the cached type
+            // found above, so whether the writer invalidates depends on the type they ended up in
+            VkMemoryRequirements memoryReqs;
+            vkGetBufferMemoryRequirements(device, m_slots[0].buffer->buffer, &memoryReqs);
+            uint32_t memoryType = Memory::select(physicalDevice, memoryReqs, memoryFlags);
+            m_coherent = (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+            // the stream is opened last, so nothing is created on disk when the buffers can't be
+            // the stream header is written once, before the first frame
+            // 4:2:0 with the chroma sited in the middle of every 2x2 block is C420jpeg, the conversion uses BT.601 limited range
+            open(path);
+            if (format == Format::Y4m)
+            {
+                char header[256];
+                int length = snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", extent.width, extent.height, framesPerSecond);
+                std::vector<Chunk> chunks { Chunk { header, static_cast<size_t>(length) } };
+                if (!write(chunks))
+                    throw std::runtime_error("Failed to write the stream header");
+            }
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+
+        m_writer = std::thread(&FrameStream::run, this);
+    }
+
+    // writes every frame that was queued, then closes the stream
+    ~FrameStream()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        m_writer.join();
+
+        release();
+    }
+
+    // the size of a frame in the stream, without the Y4M frame header
+    static VkDeviceSize frameSize(VkExtent2D extent, Format format)
+    {
+        VkDeviceSize pixels = VkDeviceSize(extent.width) * extent.height;
+        return format == Format::Rgba ? pixels * 4 : pixels + pixels / 2;
+    }
+
+    // returns the slot the next frame goes into, after waiting for the writer to be done with it
+    // slots are used in order, so the writer can write them in order
+    uint32_t acquire()
+    {
+        uint32_t index = m_next;
+        m_next = (m_next + 1) % m_slots.size();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        Slot& slot = m_slots[index];
+        if (slot.state != SlotState::Free)
+        {
+            auto waitStart = std::chrono::steady_clock::now();
+            m_freed.wait(lock, [&slot] { return slot.state == SlotState::Free; });
+            m_writerWait += std::chrono::steady_clock::now() - waitStart;
+        }
+
+        THROW_IF_FAILED(vkResetFences(m_device, 1, &slot.fence));
+        slot.state = SlotState::Recording;
+        return index;
+    }
+
+    // the buffer the frame's commands write into, and the fence to submit after them
+    Buffer& buffer(uint32_t slot) { return *m_slots[slot].buffer; }
+    VkFence fence(uint32_t slot) const { return m_slots[slot].fence; }
+
+    // hands a slot to the writer once its fence was submitted, the writer waits for the fence itself
+    void queue(uint32_t slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots[slot].state = SlotState::Queued;
+        m_queue.push_back(slot);
+        m_condition.notify_one();
+    }
+
+    // the reader went away or the stream can't be written to, nothing more will be written
+    bool failed() { std::lock_guard<std::mutex> lock(m_mutex); return m_failed; }
+
+    // why the writer thread failed the stream, empty when it failed because a write did (e.g. the reader went away)
+    std::string error() { std::lock_guard<std::mutex> lock(m_mutex); return m_error; }
+
+    uint64_t framesWritten() { std::lock_guard<std::mutex> lock(m_mutex); return m_framesWritten; }
+
+    // every writev() or fwrite() call made so far, including the ones that only wrote part of a batch
+    uint64_t writeCalls() const { return m_writeCalls; }
+
+    // how long acquire() waited for the writer to hand back a slot, in milliseconds
+    double writerWait() const { return std::chrono::duration<double, std::milli>(m_writerWait).count(); }
+
+private:
+    enum class SlotState
+    {
+        Free,
+        Recording,
+        Queued
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<Buffer> buffer;
+        VkFence fence = VK_NULL_HANDLE;
+        SlotState state = SlotState::Free;
+    };
+
+    struct Chunk
+    {
+        const void* data;
+        size_t size;
+    };
+
+    void run()
+    {
+        static const char frameHeader[] = "FRAME\n";
+        std::vector<size_t> batch;
+        std::vector<Chunk> chunks;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_condition.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+            if (m_queue.empty())
+                break;
+
+            // everything queued so far goes out together, in the order it was queued
+            batch.assign(m_queue.begin(), m_queue.end());
+            m_queue.clear();
+            bool failed = m_failed;
+            std::string error;
+            lock.unlock();
+
+            // an exception leaving this thread would terminate the process, so an error fails the stream instead
+            // the render loop stops once it sees failed(), and can tell why from error()
+            try
+            {
+                // the frames were submitted in order, so they finish in order, and waiting for each in turn costs nothing extra
+                chunks.clear();
+                for (size_t index : batch)
+                {
+                    Slot& slot = m_slots[index];
+                    VkResult result = vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+                    if (result != VK_SUCCESS)
+                        throw std::runtime_error("Waiting for a frame failed with VkResult " + std::to_string(result));
+
+                    if (!m_coherent)
+                    {
+                        VkMappedMemoryRange range { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, slot.buffer->memory, 0, VK_WHOLE_SIZE };
+                        vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+                    }
+
+                    if (m_format == Format::Y4m)
+                        chunks.push_back(Chunk { frameHeader, sizeof(frameHeader) - 1 });
+                    chunks.push_back(Chunk { slot.buffer->mapped, static_cast<size_t>(m_frameSize) });
+                }
+
+                // once the stream failed, frames are still taken off the queue so the render loop never waits forever
+                if (!failed)
+                    failed = !write(chunks);
+            }
+            catch (const std::exception& e)
+            {
+                failed = true;
+                error = e.what();
+            }
+
+            lock.lock();
+            for (size_t index : batch)
+                m_slots[index].state = SlotState::Free;
+            m_freed.notify_all();
+
+            if (!m_failed && failed)
+                m_error = error;
+            m_failed = failed;
+            if (!failed)
+                m_framesWritten += batch.size();
+        }
+    }
+
+    // the fences that were created, and the stream if it was opened, buffers release themselves
+    void release()
+    {
+        for (Slot& slot : m_slots)
+        {
+            if (slot.fence != VK_NULL_HANDLE)
+                vkDestroyFence(m_device, slot.fence, nullptr);
+        }
+        m_slots.clear();
+
+        close();
+    }
+
+#ifdef _WIN32
+    void open(const std::string& path)
+    {
+        if (path == "-")
+        {
+            // stdout is opened in text mode, which would turn every 0x0a byte in a frame into 0x0d 0x0a
+            _setmode(_fileno(stdout), _O_BINARY);
+            m_file = stdout;
+        }
+        else
+            m_file = fopen(path.c_str(), "wb");
+
+        if (m_file == nullptr)
+            throw std::runtime_error("Failed to open " + path);
+    }
+
+    void close()
+    {
+        if (m_file == nullptr)
+            return;
+
+        fflush(m_file);
+        if (m_file != stdout)
+            fclose(m_file);
+        m_file = nullptr;
+    }
+
+    bool write(const std::vector<Chunk>& chunks)
+    {
+        for (const Chunk& chunk : chunks)
+        {
+            m_writeCalls++;
+            if (fwrite(chunk.data, 1, chunk.size, m_file) != chunk.size)
+                return false;
+        }
+
+        return fflush(m_file) == 0;
+    }
+
+    FILE* m_file = nullptr;
+#else
+    void open(const std::string& path)
+    {
+        // a reader that goes away would otherwise kill the process with SIGPIPE, this way the write fails with EPIPE
+        signal(SIGPIPE, SIG_IGN);
+
+        m_fd = path == "-" ? STDOUT_FILENO : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (m_fd == -1)
+            throw std::runtime_error("Failed to open " + path);
+    }
+
+    void close()
+    {
+        if (m_fd != -1 && m_fd != STDOUT_FILENO)
+            ::close(m_fd);
+        m_fd = -1;
+    }
+
+    // writes every chunk with as few system calls as the pipe allows
+    // a pipe takes as much as fits in its buffer and returns, so a write can end in the middle of a chunk, and continues from there
+    bool write(const std::vector<Chunk>& chunks)
+    {
+        std::vector<iovec> vectors(chunks.size());
+        for (size_t i = 0; i < chunks.size(); i++)
+            vectors[i] = iovec { const_cast<void*>(chunks[i].data), chunks[i].size };
+
+        size_t first = 0;
+        while (first < vectors.size())
+        {
+            int count = static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX));
+            ssize_t written = writev(m_fd, &vectors[first], count);
+            m_writeCalls++;
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+
+            size_t remaining = static_cast<size_t>(written);
+            while (first < vectors.size() && remaining >= vectors[first].iov_len)
+                remaining -= vectors[first++].iov_len;
+
+            if (remaining > 0)
+            {
+                vectors[first].iov_base = static_cast<uint8_t*>(vectors[first].iov_base) + remaining;
+                vectors[first].iov_len -= remaining;
+            }
+        }
+
+        return true;
+    }
+
+    int m_fd = -1;
+#endif
+
+    VkDevice m_device;
+    Format m_format;
+    VkDeviceSize m_frameSize = 0;
+    bool m_coherent = true;
+
+    std::vector<Slot> m_slots;
+    uint32_t m_next = 0;
+    uint64_t m_framesWritten = 0;
+    std::atomic<uint64_t> m_writeCalls { 0 };
+    bool m_failed = false;
+    std::string m_error;
+    std::chrono::steady_clock::duration m_writerWait {};
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_freed;
+    std::deque<size_t> m_queue;
+    std::thread m_writer;
+    bool m_stopping = false;
+};